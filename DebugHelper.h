@@ -53,6 +53,8 @@ namespace DebugHelper {
     Serial.println("\n--- Light Sensor Status ---");
     Serial.print("Current Lux: "); Serial.print(lightSensor.getLastLux(), 1); Serial.println(" lux");
     Serial.print("Night Threshold: "); Serial.print(lightSensor.getNightThreshold(), 1); Serial.println(" lux");
+    Serial.print("Day Threshold: "); Serial.print(lightSensor.getDayThreshold(), 1); Serial.println(" lux");
+    Serial.print("Sample Interval: "); Serial.print(lightSensor.getSampleIntervalMs()); Serial.println(" ms");
     Serial.print("Is Night: "); Serial.println(lightSensor.isNight() ? "YES" : "NO");
     Serial.print("Sensor Ready: "); Serial.println(lightSensor.isReady() ? "YES" : "NO");
     Serial.println("---------------------------\n");
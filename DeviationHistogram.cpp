@@ -0,0 +1,60 @@
+#include "DeviationHistogram.h"
+#include <math.h>
+
+DeviationHistogram::DeviationHistogram() {
+    reset();
+}
+
+void DeviationHistogram::reset() {
+    memset(_bins, 0, sizeof(_bins));
+    _total = 0;
+}
+
+uint16_t DeviationHistogram::binOf(uint64_t valueSq) {
+    // Values below one octave's worth of sub-bins get a bin each
+    if (valueSq < DEVIATION_HIST_SUB_BINS) return (uint16_t)valueSq;
+
+    // Octave from the position of the top bit, sub-bin from the bits below it
+    int octave = 63 - __builtin_clzll(valueSq);
+    uint16_t sub = (valueSq >> (octave - DEVIATION_HIST_SUB_BITS)) & (DEVIATION_HIST_SUB_BINS - 1);
+    uint16_t bin = (octave - DEVIATION_HIST_SUB_BITS + 1) * DEVIATION_HIST_SUB_BINS + sub;
+    return (bin < DEVIATION_HIST_BINS) ? bin : DEVIATION_HIST_BINS - 1;
+}
+
+float DeviationHistogram::binCenter(uint16_t bin) {
+    if (bin < DEVIATION_HIST_SUB_BINS) return bin;
+
+    // Inverse of binOf(): bin covers [(S + sub), (S + sub + 1)) << shift
+    int shift = bin / DEVIATION_HIST_SUB_BINS - 1;
+    int sub = bin % DEVIATION_HIST_SUB_BINS;
+    return ldexpf(DEVIATION_HIST_SUB_BINS + sub + 0.5f, shift);
+}
+
+void DeviationHistogram::add(uint64_t valueSq) {
+    if (_total >= DEVIATION_HIST_MAX_COUNT) {
+        _total = 0;
+        for (uint16_t i = 0; i < DEVIATION_HIST_BINS; i++) {
+            _bins[i] >>= 1;
+            _total += _bins[i];
+        }
+    }
+
+    _bins[binOf(valueSq)]++;
+    _total++;
+}
+
+float DeviationHistogram::quantile(float q) const {
+    if (_total == 0) return 0;
+
+    uint32_t target = (uint32_t)(q * _total);
+    if (target >= _total) target = _total - 1;
+
+    uint32_t cumulative = 0;
+    for (uint16_t i = 0; i < DEVIATION_HIST_BINS; i++) {
+        cumulative += _bins[i];
+        if (cumulative > target) {
+            return sqrtf(binCenter(i));
+        }
+    }
+    return sqrtf(binCenter(DEVIATION_HIST_BINS - 1));
+}
@@ -0,0 +1,52 @@
+#ifndef DEVIATION_HISTOGRAM_H
+#define DEVIATION_HISTOGRAM_H
+
+#include <Arduino.h>
+
+// Bins per octave of the squared value (8 per octave of the amplitude, ~9% wide)
+#define DEVIATION_HIST_SUB_BITS 2
+#define DEVIATION_HIST_SUB_BINS (1 << DEVIATION_HIST_SUB_BITS)
+
+// Squared values up to 2^36 (3-axis int16 deviations stay below 2^34)
+#define DEVIATION_HIST_OCTAVES 36
+#define DEVIATION_HIST_BINS (DEVIATION_HIST_OCTAVES * DEVIATION_HIST_SUB_BINS)
+
+// All counts are halved when the total reaches this (old data fades out)
+#define DEVIATION_HIST_MAX_COUNT (1UL << 20)
+
+/**
+ * @brief Log-binned histogram of squared deviations (sensor counts^2)
+ *
+ * add() costs a count-leading-zeros and an increment, so it can run on every
+ * sample. Unlike a running maximum, quantiles are robust against a single
+ * outlier. Quantiles are resolved to the bin (about 9% in amplitude).
+ */
+class DeviationHistogram {
+public:
+    DeviationHistogram();
+
+    void reset();
+
+    /**
+     * @brief Count one squared deviation
+     */
+    void add(uint64_t valueSq);
+
+    /**
+     * @brief Quantile of the amplitude (square root of the stored values)
+     * @param q Quantile in [0, 1]
+     * @return Amplitude in counts, 0 if empty
+     */
+    float quantile(float q) const;
+
+    uint32_t getCount() const { return _total; }
+
+private:
+    uint32_t _bins[DEVIATION_HIST_BINS];
+    uint32_t _total;
+
+    static uint16_t binOf(uint64_t valueSq);
+    static float binCenter(uint16_t bin);
+};
+
+#endif // DEVIATION_HISTOGRAM_H
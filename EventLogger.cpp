@@ -17,14 +17,42 @@ bool EventLogger::begin() {
 }
 
 void EventLogger::logEvent(bool ledOn, float lux, bool motion, const char* mode) {
+    append(EventType::LED, ledOn, lux, motion, mode);
+    
+    Serial.print("Event logged: ");
+    Serial.print(ledOn ? "LED ON" : "LED OFF");
+    Serial.print(" | Lux: ");
+    Serial.print(lux);
+    Serial.print(" | Motion: ");
+    Serial.print(motion ? "YES" : "NO");
+    Serial.print(" | Mode: ");
+    Serial.println(mode);
+}
+
+void EventLogger::logOrientation(const char* orientation, bool ledOn, float lux, bool motion, const char* mode) {
+    LogEntry& entry = append(EventType::ORIENTATION, ledOn, lux, motion, mode);
+    strncpy(entry.orientation, orientation, sizeof(entry.orientation) - 1);
+    entry.orientation[sizeof(entry.orientation) - 1] = '\0';
+    
+    Serial.print("Event logged: orientation ");
+    Serial.print(orientation);
+    Serial.print(" | Lux: ");
+    Serial.print(lux);
+    Serial.print(" | Motion: ");
+    Serial.println(motion ? "YES" : "NO");
+}
+
+EventLogger::LogEntry& EventLogger::append(EventType type, bool ledOn, float lux, bool motion, const char* mode) {
     // Crea nuovo evento
     LogEntry& entry = _entries[_head];
     entry.timestamp = (uint32_t)time(nullptr);  // Unix timestamp
+    entry.type = type;
     entry.ledOn = ledOn;
     entry.lux = lux;
     entry.motion = motion;
     strncpy(entry.mode, mode, sizeof(entry.mode) - 1);
     entry.mode[sizeof(entry.mode) - 1] = '\0';
+    entry.orientation[0] = '\0';
     
     // Avanza head (buffer circolare)
     _head = (_head + 1) % MAX_LOG_ENTRIES;
@@ -34,14 +62,7 @@ void EventLogger::logEvent(bool ledOn, float lux, bool motion, const char* mode)
         _count++;
     }
     
-    Serial.print("Event logged: ");
-    Serial.print(ledOn ? "LED ON" : "LED OFF");
-    Serial.print(" | Lux: ");
-    Serial.print(lux);
-    Serial.print(" | Motion: ");
-    Serial.print(motion ? "YES" : "NO");
-    Serial.print(" | Mode: ");
-    Serial.println(mode);
+    return entry;
 }
 
 const EventLogger::LogEntry* EventLogger::getEvent(uint16_t index) const {
@@ -79,7 +100,13 @@ String EventLogger::getEventsJSON() const {
         
         json += "{";
         json += "\"timestamp\":" + String(entry->timestamp) + ",";
-        json += "\"event\":\"" + String(entry->ledOn ? "on" : "off") + "\",";
+        if (entry->type == EventType::ORIENTATION) {
+            json += "\"event\":\"orientation\",";
+            json += "\"orientation\":\"" + String(entry->orientation) + "\",";
+            json += "\"led\":" + String(entry->ledOn ? "true" : "false") + ",";
+        } else {
+            json += "\"event\":\"" + String(entry->ledOn ? "on" : "off") + "\",";
+        }
         json += "\"lux\":" + String(entry->lux, 1) + ",";
         json += "\"motion\":" + String(entry->motion ? "true" : "false") + ",";
         json += "\"mode\":\"" + String(entry->mode) + "\"";
@@ -19,18 +19,29 @@
  */
 class EventLogger {
 public:
+    /**
+     * @brief Tipo di evento
+     */
+    enum class EventType : uint8_t {
+        LED,            // Accensione/spegnimento del LED
+        ORIENTATION     // Cambio di orientamento del robot
+    };
+    
     /**
      * @brief Struttura per un singolo evento
      */
     struct LogEntry {
         uint32_t timestamp;    // Unix timestamp (epoch)
-        bool ledOn;            // true = accensione, false = spegnimento
+        EventType type;        // Tipo di evento
+        bool ledOn;            // true = accensione, false = spegnimento (stato LED per ORIENTATION)
         float lux;             // Valore lux al momento dell'evento
         bool motion;           // Stato movimento
         char mode[8];          // Modalità LED: "auto", "on", "off"
+        char orientation[8];   // Solo ORIENTATION: "upright", "lifted", "tipped", "flipped"
         
-        LogEntry() : timestamp(0), ledOn(false), lux(0), motion(false) {
+        LogEntry() : timestamp(0), type(EventType::LED), ledOn(false), lux(0), motion(false) {
             strcpy(mode, "auto");
+            orientation[0] = '\0';
         }
     };
     
@@ -54,6 +65,16 @@ public:
      */
     void logEvent(bool ledOn, float lux, bool motion, const char* mode = "auto");
     
+    /**
+     * @brief Aggiungi un cambio di orientamento al log
+     * @param orientation Nuovo orientamento ("upright", "lifted", "tipped", "flipped")
+     * @param ledOn Stato LED corrente
+     * @param lux Valore lux corrente
+     * @param motion Stato movimento corrente
+     * @param mode Modalità LED corrente ("auto", "manual")
+     */
+    void logOrientation(const char* orientation, bool ledOn, float lux, bool motion, const char* mode = "auto");
+    
     /**
      * @brief Ottieni il numero di eventi nel log
      * @return Numero di eventi
@@ -103,6 +124,7 @@ private:
     
     // Helper per gestione buffer circolare
     uint16_t getCircularIndex(uint16_t logicalIndex) const;
+    LogEntry& append(EventType type, bool ledOn, float lux, bool motion, const char* mode);
     bool isToday(uint32_t timestamp) const;
 };
 
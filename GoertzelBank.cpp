@@ -0,0 +1,87 @@
+#include "GoertzelBank.h"
+#include <math.h>
+
+#define GOERTZEL_COEFF_SHIFT 28
+
+GoertzelBank::GoertzelBank()
+    : _numBins(0)
+    , _blockLength(1)
+    , _n(0)
+    , _blocks(0)
+{
+    memset(_enabled, 0, sizeof(_enabled));
+    memset(_coeff, 0, sizeof(_coeff));
+    memset(_power, 0, sizeof(_power));
+    memset(_dc, 0, sizeof(_dc));
+    reset();
+}
+
+void GoertzelBank::configure(uint32_t samplePeriodUs, uint16_t blockLength, const float* freqsHz, uint8_t numBins) {
+    if (numBins > GOERTZEL_MAX_BINS) numBins = GOERTZEL_MAX_BINS;
+    if (blockLength < 2) blockLength = 2;
+
+    _numBins = numBins;
+    _blockLength = blockLength;
+
+    // Not on the hot path: float and cos are fine here
+    float fs = samplePeriodUs ? 1e6f / samplePeriodUs : 0;
+    for (uint8_t i = 0; i < numBins; i++) {
+        int k = (fs > 0) ? (int)lroundf(freqsHz[i] * blockLength / fs) : 0;
+        _enabled[i] = (k >= 1) && (freqsHz[i] < 0.45f * fs);
+        _coeff[i] = _enabled[i]
+            ? (int32_t)lround(2.0 * cos(2.0 * M_PI * k / blockLength) * (1L << GOERTZEL_COEFF_SHIFT))
+            : 0;
+        _power[i] = 0;
+    }
+
+    memset(_dc, 0, sizeof(_dc));
+    reset();
+}
+
+void GoertzelBank::reset() {
+    _n = 0;
+    memset(_s1, 0, sizeof(_s1));
+    memset(_s2, 0, sizeof(_s2));
+    memset(_sum, 0, sizeof(_sum));
+}
+
+bool GoertzelBank::push(const int16_t* xyz) {
+    for (int axis = 0; axis < 3; axis++) {
+        int32_t x = xyz[axis] - _dc[axis];
+        _sum[axis] += xyz[axis];
+
+        for (uint8_t i = 0; i < _numBins; i++) {
+            // s[n] = x[n] + 2cos(w) * s[n-1] - s[n-2]
+            int32_t s = x + (int32_t)(((int64_t)_coeff[i] * _s1[axis][i]) >> GOERTZEL_COEFF_SHIFT) - _s2[axis][i];
+            _s2[axis][i] = _s1[axis][i];
+            _s1[axis][i] = s;
+        }
+    }
+
+    if (++_n < _blockLength) {
+        return false;
+    }
+
+    // |X|^2 = s1^2 + s2^2 - 2cos(w) * s1 * s2, summed over the axes
+    for (uint8_t i = 0; i < _numBins; i++) {
+        int64_t power = 0;
+        if (_enabled[i]) {
+            for (int axis = 0; axis < 3; axis++) {
+                int64_t s1 = _s1[axis][i];
+                int64_t s2 = _s2[axis][i];
+                int64_t cross = ((int64_t)_coeff[i] * s1 >> GOERTZEL_COEFF_SHIFT) * s2;
+                power += s1 * s1 + s2 * s2 - cross;
+            }
+        }
+        _power[i] = (power > 0) ? (uint64_t)power : 0;
+    }
+
+    // Block mean becomes the offset removed from the next block (one division per block)
+    for (int axis = 0; axis < 3; axis++) {
+        _dc[axis] = _sum[axis] / _blockLength;
+    }
+
+    _blocks++;
+    reset();
+    return true;
+}
@@ -0,0 +1,68 @@
+#ifndef GOERTZEL_BANK_H
+#define GOERTZEL_BANK_H
+
+#include <Arduino.h>
+
+// Maximum number of frequency bins in one bank
+#define GOERTZEL_MAX_BINS 8
+
+/**
+ * @brief Bank of fixed-point Goertzel filters over a 3-axis sample stream
+ *
+ * Each bin costs one multiply-add per axis and sample; at the end of every
+ * block of N samples the power of each bin (summed over the three axes, in
+ * counts^2 * N^2 / 4 units for a sinusoid of amplitude A: |X|^2 = (A*N/2)^2)
+ * is latched and the filters restart. Much cheaper than an FFT when only a
+ * handful of frequencies matter.
+ *
+ * Bins are rounded to the nearest multiple of fs/N so that a constant offset
+ * (gravity) does not leak into them; the previous block mean is removed too.
+ */
+class GoertzelBank {
+public:
+    GoertzelBank();
+
+    /**
+     * @brief Set up the bins for a sample rate
+     * @param samplePeriodUs Sample period (us)
+     * @param blockLength Samples per block (N)
+     * @param freqsHz Bin frequencies (Hz); bins at or above 0.45*fs are disabled
+     * @param numBins Number of bins (<= GOERTZEL_MAX_BINS)
+     */
+    void configure(uint32_t samplePeriodUs, uint16_t blockLength, const float* freqsHz, uint8_t numBins);
+
+    /**
+     * @brief Restart the current block (after a gap in the stream)
+     */
+    void reset();
+
+    /**
+     * @brief Feed one sample
+     * @param xyz Sample in counts
+     * @return true when a block completed and new powers are available
+     */
+    bool push(const int16_t* xyz);
+
+    // Results of the last completed block
+    uint64_t getPower(uint8_t bin) const { return (bin < _numBins) ? _power[bin] : 0; }
+    bool isBinEnabled(uint8_t bin) const { return bin < _numBins && _enabled[bin]; }
+    uint16_t getBlockLength() const { return _blockLength; }
+    uint32_t getBlockCount() const { return _blocks; }
+
+private:
+    uint8_t _numBins;
+    uint16_t _blockLength;
+    uint16_t _n;
+    uint32_t _blocks;
+
+    bool _enabled[GOERTZEL_MAX_BINS];
+    int32_t _coeff[GOERTZEL_MAX_BINS];            // 2*cos(2*pi*k/N), Q28
+    int32_t _s1[3][GOERTZEL_MAX_BINS];
+    int32_t _s2[3][GOERTZEL_MAX_BINS];
+    uint64_t _power[GOERTZEL_MAX_BINS];
+
+    int32_t _dc[3];                               // Mean of the previous block
+    int32_t _sum[3];                              // Running sum of the current block
+};
+
+#endif // GOERTZEL_BANK_H
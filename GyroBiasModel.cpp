@@ -0,0 +1,78 @@
+#include "GyroBiasModel.h"
+
+GyroBiasModel::GyroBiasModel() {
+    reset();
+}
+
+void GyroBiasModel::reset() {
+    memset(_bins, 0, sizeof(_bins));
+    _dirty = false;
+}
+
+void GyroBiasModel::setBins(const Bin* bins) {
+    memcpy(_bins, bins, sizeof(_bins));
+    _dirty = false;
+}
+
+int GyroBiasModel::binOf(int16_t tempRaw) {
+    // Nearest bin centre
+    const int32_t step = GYRO_BIAS_STEP_C * TEMPERATURE_SENSOR_RESOLUTION;
+    int32_t offset = (int32_t)tempRaw - GYRO_BIAS_MIN_C * TEMPERATURE_SENSOR_RESOLUTION + step / 2;
+    int bin = (offset < 0) ? 0 : offset / step;
+    return (bin < GYRO_BIAS_BINS) ? bin : GYRO_BIAS_BINS - 1;
+}
+
+int32_t GyroBiasModel::binTempRaw(int bin) {
+    return (GYRO_BIAS_MIN_C + bin * GYRO_BIAS_STEP_C) * TEMPERATURE_SENSOR_RESOLUTION;
+}
+
+bool GyroBiasModel::learn(int16_t tempRaw, const int16_t* gyro) {
+    Bin& bin = _bins[binOf(tempRaw)];
+
+    for (int axis = 0; axis < 3; axis++) {
+        int32_t x = (int32_t)gyro[axis] << 8;
+        if (bin.samples < (1 << GYRO_BIAS_EMA_SHIFT)) {
+            // Running mean until the EMA window is filled
+            bin.biasQ[axis] += (x - bin.biasQ[axis]) / (bin.samples + 1);
+        } else {
+            bin.biasQ[axis] += (x - bin.biasQ[axis]) >> GYRO_BIAS_EMA_SHIFT;
+        }
+    }
+
+    if (bin.samples < 0xFFFF) bin.samples++;
+    _dirty = true;
+    return bin.samples == GYRO_BIAS_MIN_SAMPLES;
+}
+
+bool GyroBiasModel::bias(int16_t tempRaw, int16_t* out) const {
+    int32_t t = tempRaw;
+
+    // Nearest trusted bins below and above the temperature
+    int lower = -1, upper = -1;
+    for (int i = 0; i < GYRO_BIAS_BINS; i++) {
+        if (_bins[i].samples < GYRO_BIAS_MIN_SAMPLES) continue;
+        if (binTempRaw(i) <= t) lower = i;
+        if (binTempRaw(i) >= t && upper < 0) upper = i;
+    }
+    if (lower < 0 && upper < 0) return false;
+    if (lower < 0) lower = upper;
+    if (upper < 0) upper = lower;
+
+    int32_t t0 = binTempRaw(lower);
+    int32_t span = binTempRaw(upper) - t0;
+    for (int axis = 0; axis < 3; axis++) {
+        int32_t b0 = _bins[lower].biasQ[axis];
+        int32_t b1 = _bins[upper].biasQ[axis];
+        int32_t b = span ? b0 + (int32_t)((int64_t)(b1 - b0) * (t - t0) / span) : b0;
+        out[axis] = (int16_t)((b + 128) >> 8);
+    }
+    return true;
+}
+
+uint8_t GyroBiasModel::getTrustedBins() const {
+    uint8_t count = 0;
+    for (int i = 0; i < GYRO_BIAS_BINS; i++) {
+        if (_bins[i].samples >= GYRO_BIAS_MIN_SAMPLES) count++;
+    }
+    return count;
+}
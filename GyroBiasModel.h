@@ -0,0 +1,63 @@
+#ifndef GYRO_BIAS_MODEL_H
+#define GYRO_BIAS_MODEL_H
+
+#include <Arduino.h>
+#include "Qmi8658c.h"
+
+// Temperature table: GYRO_BIAS_BINS bins GYRO_BIAS_STEP_C apart from GYRO_BIAS_MIN_C
+#define GYRO_BIAS_MIN_C -20
+#define GYRO_BIAS_STEP_C 5
+#define GYRO_BIAS_BINS 18                  // -20..65 degrees C
+
+#define GYRO_BIAS_EMA_SHIFT 8              // Per-bin time constant: 256 stationary samples
+#define GYRO_BIAS_MIN_SAMPLES 64           // Samples before a bin is used
+
+/**
+ * @brief Per-axis gyroscope bias as a function of die temperature
+ *
+ * Stationary samples are averaged into the bin of the current temperature
+ * (running mean at first, then an EMA); bias() interpolates linearly between
+ * the nearest trusted bins on each side and holds the edge value outside
+ * them. Temperatures are raw QMI8658 counts (TEMPERATURE_SENSOR_RESOLUTION
+ * per degree C), biases are gyro counts.
+ */
+class GyroBiasModel {
+public:
+    struct Bin {
+        int32_t biasQ[3];          // Gyro counts << 8
+        uint16_t samples;          // Saturates at 0xFFFF
+    };
+
+    GyroBiasModel();
+
+    void reset();
+
+    /**
+     * @brief Learn from a sample taken while stationary
+     * @return true if the sample made its bin trusted (the table changed shape)
+     */
+    bool learn(int16_t tempRaw, const int16_t* gyro);
+
+    /**
+     * @brief Interpolated bias at a temperature
+     * @return false if no bin is trusted yet
+     */
+    bool bias(int16_t tempRaw, int16_t* out) const;
+
+    uint8_t getTrustedBins() const;
+    bool isDirty() const { return _dirty; }
+
+    // Persistence: the table is stored as is, tagged with the gyro sensitivity
+    const Bin* getBins() const { return _bins; }
+    void setBins(const Bin* bins);
+    void clearDirty() { _dirty = false; }
+
+private:
+    Bin _bins[GYRO_BIAS_BINS];
+    bool _dirty;
+
+    static int binOf(int16_t tempRaw);
+    static int32_t binTempRaw(int bin);
+};
+
+#endif // GYRO_BIAS_MODEL_H
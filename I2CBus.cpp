@@ -0,0 +1,244 @@
+#include "I2CBus.h"
+
+// Upper limits (us) of the latency histogram buckets; the last bucket is open-ended
+static const uint32_t LATENCY_BUCKET_US[I2C_LATENCY_BUCKETS] = {
+    100, 200, 500, 1000, 2000, 5000, 10000, 0xFFFFFFFF
+};
+
+// TwoWire::endTransmission() result codes
+#define I2C_RESULT_OK          0
+#define I2C_RESULT_NACK_ADDR   2
+#define I2C_RESULT_NACK_DATA   3
+#define I2C_RESULT_ERROR       4
+#define I2C_RESULT_TIMEOUT     5
+
+// ==================== I2CBus ====================
+
+I2CBus::I2CBus(TwoWire& wire, int sda, int scl)
+    : _wire(wire)
+    , _sda(sda)
+    , _scl(scl)
+    , _frequency(100000)
+    , _lock(nullptr)
+    , _deviceCount(0)
+    , _consecutiveFailures(0)
+    , _recoveryCount(0)
+    , _probed(false)
+{
+    memset(_devices, 0, sizeof(_devices));
+}
+
+bool I2CBus::begin(uint32_t frequency) {
+    _frequency = frequency;
+
+    if (!_lock) {
+        _lock = xSemaphoreCreateMutex();
+    }
+
+    // A slave left mid-transfer by a reset can hold SDA low: clear it first
+    hwRecover();
+
+    return _lock != nullptr;
+}
+
+bool I2CBus::write(I2CDevice& device, const uint8_t* data, uint8_t len, bool sendStop) {
+    lock();
+    uint32_t startUs = micros();
+    uint8_t result = hwWrite(device._address, data, len, sendStop, timeoutForBytes(len));
+    finish(device, result, startUs);
+    unlock();
+
+    return result == I2C_RESULT_OK;
+}
+
+bool I2CBus::read(I2CDevice& device, uint8_t* buf, uint8_t len) {
+    lock();
+    uint32_t startUs = micros();
+    uint8_t result = hwRead(device._address, buf, len, timeoutForBytes(len));
+    finish(device, result, startUs);
+    unlock();
+
+    return result == I2C_RESULT_OK;
+}
+
+bool I2CBus::writeRead(I2CDevice& device, uint8_t reg, uint8_t* buf, uint8_t len) {
+    lock();
+    uint32_t startUs = micros();
+    uint8_t result = hwWrite(device._address, &reg, 1, false, timeoutForBytes(1));
+    if (result == I2C_RESULT_OK) {
+        result = hwRead(device._address, buf, len, timeoutForBytes(len));
+    }
+    finish(device, result, startUs);
+    unlock();
+
+    return result == I2C_RESULT_OK;
+}
+
+void I2CBus::recover() {
+    lock();
+    hwRecover();
+    _recoveryCount++;
+    _consecutiveFailures = 0;
+    unlock();
+}
+
+const I2CDevice* I2CBus::getDevice(uint8_t index) const {
+    return (index < _deviceCount) ? _devices[index] : nullptr;
+}
+
+uint32_t I2CBus::getLatencyBucketLimitUs(uint8_t bucket) {
+    return (bucket < I2C_LATENCY_BUCKETS) ? LATENCY_BUCKET_US[bucket] : 0;
+}
+
+void I2CBus::registerDevice(I2CDevice* device) {
+    if (_deviceCount < I2C_MAX_DEVICES) {
+        _devices[_deviceCount++] = device;
+    }
+}
+
+uint16_t I2CBus::timeoutForBytes(uint8_t len) const {
+    // Address byte + data + START/STOP, 9 clocks per byte
+    uint32_t wireUs = ((uint32_t)(len + 2) * 9 * 1000000UL) / _frequency;
+    uint32_t budgetUs = wireUs + I2C_TIMEOUT_MARGIN_US;
+
+    // TwoWire takes milliseconds: round up, never 0
+    return (uint16_t)((budgetUs + 999) / 1000);
+}
+
+void I2CBus::finish(I2CDevice& device, uint8_t result, uint32_t startUs) {
+    uint32_t latencyUs = micros() - startUs;
+    I2CDevice::Stats& stats = device._stats;
+
+    stats.transactions++;
+    if (_probed) {
+        // The probe is a transaction of its own on the wire
+        stats.transactions++;
+        stats.probes++;
+        _probed = false;
+    }
+    if (latencyUs > stats.maxLatencyUs) stats.maxLatencyUs = latencyUs;
+    for (uint8_t i = 0; i < I2C_LATENCY_BUCKETS; i++) {
+        if (latencyUs < LATENCY_BUCKET_US[i] || i == I2C_LATENCY_BUCKETS - 1) {
+            stats.latencyHist[i]++;
+            break;
+        }
+    }
+
+    if (result == I2C_RESULT_OK) {
+        _consecutiveFailures = 0;
+        return;
+    }
+
+    if (result == I2C_RESULT_NACK_ADDR || result == I2C_RESULT_NACK_DATA) {
+        // The ACK bit was clocked with SDA released: the bus itself works
+        if (result == I2C_RESULT_NACK_ADDR) {
+            stats.nackAddr++;
+        } else {
+            stats.nackData++;
+        }
+        _consecutiveFailures = 0;
+        return;
+    }
+
+    if (result == I2C_RESULT_TIMEOUT) {
+        stats.timeouts++;
+    } else {
+        stats.errors++;
+    }
+
+    // Repeated timeouts or bus errors usually mean a slave is holding SDA low
+    if (++_consecutiveFailures >= I2C_RECOVERY_THRESHOLD) {
+        hwRecover();
+        _recoveryCount++;
+        _consecutiveFailures = 0;
+    }
+}
+
+void I2CBus::lock() {
+    if (_lock) xSemaphoreTake(_lock, portMAX_DELAY);
+}
+
+void I2CBus::unlock() {
+    if (_lock) xSemaphoreGive(_lock);
+}
+
+// ==================== Hardware access ====================
+
+uint8_t I2CBus::hwWrite(uint8_t address, const uint8_t* data, uint8_t len, bool sendStop, uint16_t timeoutMs) {
+    _wire.setTimeOut(timeoutMs);
+    _wire.beginTransmission(address);
+    _wire.write(data, len);
+    return _wire.endTransmission(sendStop);
+}
+
+uint8_t I2CBus::hwRead(uint8_t address, uint8_t* buf, uint8_t len, uint16_t timeoutMs) {
+    _wire.setTimeOut(timeoutMs);
+    uint32_t startUs = micros();
+
+    // requestFrom() blocks until the transfer completes (or times out)
+    if (_wire.requestFrom(address, len) != len) {
+        while (_wire.available()) _wire.read();  // Drop partial data
+        if (micros() - startUs >= (uint32_t)timeoutMs * 1000) {
+            return I2C_RESULT_TIMEOUT;
+        }
+
+        // requestFrom() only reports a byte count: an address-only write tells a
+        // missing device (address NACK) from a transfer that failed after it
+        _wire.beginTransmission(address);
+        uint8_t probe = _wire.endTransmission(true);
+        _probed = true;
+        if (probe == I2C_RESULT_NACK_ADDR || probe == I2C_RESULT_TIMEOUT) {
+            return probe;
+        }
+        return I2C_RESULT_ERROR;
+    }
+
+    for (uint8_t i = 0; i < len; i++) {
+        buf[i] = _wire.read();
+    }
+
+    return I2C_RESULT_OK;
+}
+
+void I2CBus::hwRecover() {
+    _wire.end();
+
+    // Clock SCL (up to 9 pulses) until the slave releases SDA
+    pinMode(_sda, INPUT_PULLUP);
+    pinMode(_scl, OUTPUT_OPEN_DRAIN);
+    digitalWrite(_scl, HIGH);
+    delayMicroseconds(5);
+    for (uint8_t i = 0; i < 9 && digitalRead(_sda) == LOW; i++) {
+        digitalWrite(_scl, LOW);
+        delayMicroseconds(5);
+        digitalWrite(_scl, HIGH);
+        delayMicroseconds(5);
+    }
+
+    // STOP condition: SDA low -> high while SCL is high
+    pinMode(_sda, OUTPUT_OPEN_DRAIN);
+    digitalWrite(_sda, LOW);
+    delayMicroseconds(5);
+    digitalWrite(_scl, HIGH);
+    delayMicroseconds(5);
+    digitalWrite(_sda, HIGH);
+    delayMicroseconds(5);
+
+    _wire.begin(_sda, _scl, _frequency);
+}
+
+// ==================== I2CDevice ====================
+
+I2CDevice::I2CDevice(I2CBus& bus, uint8_t address, const char* name)
+    : _bus(bus)
+    , _address(address)
+    , _name(name)
+{
+    memset(&_stats, 0, sizeof(_stats));
+    _bus.registerDevice(this);
+}
+
+bool I2CDevice::writeReg(uint8_t reg, uint8_t value) {
+    uint8_t data[2] = { reg, value };
+    return _bus.write(*this, data, sizeof(data));
+}
@@ -0,0 +1,171 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// Maximum number of devices tracked on one bus
+#define I2C_MAX_DEVICES 4
+
+// Latency histogram: bucket i counts transactions faster than I2C_LATENCY_BUCKET_US[i],
+// the last bucket counts everything slower
+#define I2C_LATENCY_BUCKETS 8
+
+// Extra time allowed on top of the wire time of a transaction (clock stretching, scheduling)
+#define I2C_TIMEOUT_MARGIN_US 500
+
+// Consecutive timeouts or bus errors before SCL-toggle recovery is attempted
+#define I2C_RECOVERY_THRESHOLD 3
+
+class I2CDevice;
+
+/**
+ * @brief Shared I2C bus with bounded transactions and statistics
+ *
+ * Wraps TwoWire for all devices on the shared IMU/BH1750 bus:
+ * - Every transaction gets a timeout proportional to its length
+ *   (wire time at the bus clock + I2C_TIMEOUT_MARGIN_US) instead of a fixed
+ *   long busy-wait, so a glitch costs at most a few milliseconds.
+ * - After I2C_RECOVERY_THRESHOLD consecutive timeouts or bus errors the bus is
+ *   recovered by clocking SCL until the stuck slave releases SDA, then issuing
+ *   a STOP. NACKs prove SDA is free: they are counted but end the streak.
+ * - Per-device counters (transactions, address/data NACKs, timeouts, other
+ *   errors, classification probes, latency histogram).
+ *
+ * The hw* methods are the only code touching the hardware; a host build can
+ * subclass I2CBus and script them to emulate a faulty bus.
+ */
+class I2CBus {
+public:
+    /**
+     * @brief Constructor
+     * @param wire TwoWire instance driving the bus
+     * @param sda SDA pin
+     * @param scl SCL pin
+     */
+    I2CBus(TwoWire& wire, int sda, int scl);
+    virtual ~I2CBus() {}
+
+    /**
+     * @brief Initialize the bus
+     * @param frequency Bus clock in Hz
+     * @return true if initialization successful
+     */
+    bool begin(uint32_t frequency);
+
+    /**
+     * @brief Write bytes to a device
+     * @param device Target device
+     * @param data Bytes to send
+     * @param len Number of bytes
+     * @param sendStop false to keep the bus (repeated start follows)
+     * @return true on ACK of every byte
+     */
+    bool write(I2CDevice& device, const uint8_t* data, uint8_t len, bool sendStop = true);
+
+    /**
+     * @brief Read bytes from a device
+     * @param device Target device
+     * @param buf Destination buffer
+     * @param len Number of bytes
+     * @return true if all bytes were received
+     */
+    bool read(I2CDevice& device, uint8_t* buf, uint8_t len);
+
+    /**
+     * @brief Write a register address then read len bytes with a repeated start
+     * @return true on success
+     */
+    bool writeRead(I2CDevice& device, uint8_t reg, uint8_t* buf, uint8_t len);
+
+    /**
+     * @brief Force a bus recovery (SCL toggling + STOP)
+     */
+    void recover();
+
+    // Registered devices (for statistics reporting)
+    uint8_t getDeviceCount() const { return _deviceCount; }
+    const I2CDevice* getDevice(uint8_t index) const;
+
+    // Bus-level statistics
+    uint32_t getRecoveryCount() const { return _recoveryCount; }
+    uint32_t getFrequency() const { return _frequency; }
+    static uint32_t getLatencyBucketLimitUs(uint8_t bucket);
+
+protected:
+    // Hardware access (overridable for host testing)
+    // Return codes follow TwoWire::endTransmission(): 0 ok, 2/3 NACK, 5 timeout, other = error
+    virtual uint8_t hwWrite(uint8_t address, const uint8_t* data, uint8_t len, bool sendStop, uint16_t timeoutMs);
+    virtual uint8_t hwRead(uint8_t address, uint8_t* buf, uint8_t len, uint16_t timeoutMs);
+    virtual void hwRecover();
+
+private:
+    friend class I2CDevice;
+
+    TwoWire& _wire;
+    int _sda;
+    int _scl;
+    uint32_t _frequency;
+    SemaphoreHandle_t _lock;
+
+    I2CDevice* _devices[I2C_MAX_DEVICES];
+    uint8_t _deviceCount;
+    uint8_t _consecutiveFailures;
+    uint32_t _recoveryCount;
+    bool _probed;                // hwRead() sent an address-only probe
+
+    void registerDevice(I2CDevice* device);
+    uint16_t timeoutForBytes(uint8_t len) const;
+    void finish(I2CDevice& device, uint8_t result, uint32_t startUs);
+    void lock();
+    void unlock();
+};
+
+/**
+ * @brief One addressable device on an I2CBus, with its own statistics
+ */
+class I2CDevice {
+public:
+    /**
+     * @brief Statistics for one device
+     */
+    struct Stats {
+        uint32_t transactions;       // Completed or failed transactions
+        uint32_t nackAddr;           // No device answered its address
+        uint32_t nackData;           // Device rejected a data byte (e.g. a register address)
+        uint32_t timeouts;           // Transaction exceeded its time budget
+        uint32_t errors;             // Other bus errors
+        uint32_t probes;             // Address-only probes classifying failed reads
+        uint32_t maxLatencyUs;       // Slowest transaction
+        uint32_t latencyHist[I2C_LATENCY_BUCKETS];
+    };
+
+    /**
+     * @brief Constructor - registers the device with the bus
+     * @param bus Shared bus
+     * @param address 7-bit I2C address
+     * @param name Short name used in statistics output
+     */
+    I2CDevice(I2CBus& bus, uint8_t address, const char* name);
+
+    bool write(const uint8_t* data, uint8_t len) { return _bus.write(*this, data, len); }
+    bool writeByte(uint8_t value) { return _bus.write(*this, &value, 1); }
+    bool writeReg(uint8_t reg, uint8_t value);
+    bool read(uint8_t* buf, uint8_t len) { return _bus.read(*this, buf, len); }
+    bool readRegs(uint8_t reg, uint8_t* buf, uint8_t len) { return _bus.writeRead(*this, reg, buf, len); }
+
+    uint8_t getAddress() const { return _address; }
+    const char* getName() const { return _name; }
+    const Stats& getStats() const { return _stats; }
+    void resetStats() { memset(&_stats, 0, sizeof(_stats)); }
+
+private:
+    friend class I2CBus;
+
+    I2CBus& _bus;
+    uint8_t _address;
+    const char* _name;
+    Stats _stats;
+};
+
+#endif // I2C_BUS_H
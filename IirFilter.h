@@ -0,0 +1,257 @@
+#ifndef IIR_FILTER_H
+#define IIR_FILTER_H
+
+#include <Arduino.h>
+#include "Qmi8658c.h"
+
+/**
+ * @brief Compile-time configurable fixed-point IIR filter chain
+ *
+ * Stages are template parameters, cutoffs are template arguments (mHz) and
+ * the coefficients for every QMI8658 ODR setting are computed constexpr from
+ * QMI8658_ACC_ODR_PERIOD_US; configure() only picks the row for the current
+ * ODR, so switching rate at runtime costs no floating point.
+ *
+ * Signals between stages are sensor counts in Q8 (int32); coefficients are
+ * Q28 and products are accumulated in 64 bits.
+ *
+ *   typedef IirChain<FirstOrderHighPass<500>, BiquadLowPass<15000>> Chain;
+ *   IirFilter3<Chain> filter;
+ */
+
+#define IIR_SIGNAL_SHIFT 8     // Q8 signal between stages
+#define IIR_COEFF_SHIFT  28    // Q28 coefficients
+
+namespace iir {
+
+constexpr double PI_D = 3.14159265358979323846;
+
+// constexpr sin/cos (Taylor series after range reduction to [-pi, pi])
+constexpr double reduce(double x) {
+    while (x > PI_D) x -= 2 * PI_D;
+    while (x < -PI_D) x += 2 * PI_D;
+    return x;
+}
+
+constexpr double sin(double x) {
+    x = reduce(x);
+    double term = x, sum = x;
+    for (int n = 1; n < 12; n++) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double cos(double x) {
+    x = reduce(x);
+    double term = 1, sum = 1;
+    for (int n = 1; n < 12; n++) {
+        term *= -x * x / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr int32_t toQ(double v) {
+    return (int32_t)(v * (double)(1L << IIR_COEFF_SHIFT) + (v >= 0 ? 0.5 : -0.5));
+}
+
+// Cutoffs at or above this fraction of the sample rate make a stage pass-through
+constexpr double MAX_CUTOFF_RATIO = 0.45;
+
+// Row of coefficients per ODR setting, built at compile time
+template <class Coeffs, Coeffs (*Design)(uint32_t)>
+struct CoeffTable {
+    Coeffs row[QMI8658_ACC_ODR_COUNT];
+
+    constexpr CoeffTable() : row() {
+        for (int i = 0; i < QMI8658_ACC_ODR_COUNT; i++) {
+            row[i] = Design(QMI8658_ACC_ODR_PERIOD_US[i]);
+        }
+    }
+};
+
+inline int32_t roundShift(int64_t v, int shift) {
+    return (int32_t)((v + ((int64_t)1 << (shift - 1))) >> shift);
+}
+
+} // namespace iir
+
+/**
+ * @brief First-order high-pass y = a * (y + x - x_prev), a = RC / (RC + dt)
+ */
+template <uint32_t CutoffMilliHz>
+class FirstOrderHighPass {
+public:
+    struct Coeffs { int32_t a; };
+
+    static constexpr Coeffs design(uint32_t periodUs) {
+        Coeffs c = { 0 };
+        if (periodUs == 0) return c;
+        double dt = periodUs * 1e-6;
+        double rc = 1.0 / (2 * iir::PI_D * CutoffMilliHz * 1e-3);
+        c.a = iir::toQ(rc / (rc + dt));
+        return c;
+    }
+
+    void configure(uint8_t odr) {
+        static constexpr iir::CoeffTable<Coeffs, design> table;
+        _c = table.row[odr < QMI8658_ACC_ODR_COUNT ? odr : 0];
+    }
+
+    // Steady state for a constant input: a high-pass outputs 0
+    int32_t prime(int32_t x) { _x1 = x; _y1 = 0; return 0; }
+
+    int32_t process(int32_t x) {
+        _y1 = iir::roundShift((int64_t)_c.a * (_y1 + x - _x1), IIR_COEFF_SHIFT);
+        _x1 = x;
+        return _y1;
+    }
+
+private:
+    Coeffs _c = { 0 };
+    int32_t _x1 = 0;
+    int32_t _y1 = 0;
+};
+
+/**
+ * @brief First-order low-pass y += alpha * (x - y), alpha = dt / (RC + dt)
+ */
+template <uint32_t CutoffMilliHz>
+class FirstOrderLowPass {
+public:
+    struct Coeffs { int32_t alpha; };
+
+    static constexpr Coeffs design(uint32_t periodUs) {
+        Coeffs c = { iir::toQ(1.0) };
+        if (periodUs == 0) return c;
+        double fs = 1e6 / periodUs;
+        if (CutoffMilliHz * 1e-3 >= iir::MAX_CUTOFF_RATIO * fs) return c;
+        double dt = periodUs * 1e-6;
+        double rc = 1.0 / (2 * iir::PI_D * CutoffMilliHz * 1e-3);
+        c.alpha = iir::toQ(dt / (rc + dt));
+        return c;
+    }
+
+    void configure(uint8_t odr) {
+        static constexpr iir::CoeffTable<Coeffs, design> table;
+        _c = table.row[odr < QMI8658_ACC_ODR_COUNT ? odr : 0];
+    }
+
+    int32_t prime(int32_t x) { _y1 = x; return x; }
+
+    int32_t process(int32_t x) {
+        _y1 += iir::roundShift((int64_t)_c.alpha * (x - _y1), IIR_COEFF_SHIFT);
+        return _y1;
+    }
+
+private:
+    Coeffs _c = { 0 };
+    int32_t _y1 = 0;
+};
+
+/**
+ * @brief Second-order Butterworth-style low-pass (RBJ biquad, direct form I)
+ * @tparam CutoffMilliHz Cutoff frequency in mHz
+ * @tparam QMilli Quality factor x1000 (707 = Butterworth)
+ */
+template <uint32_t CutoffMilliHz, uint32_t QMilli = 707>
+class BiquadLowPass {
+public:
+    struct Coeffs { int32_t b0, b1, b2, a1, a2; };
+
+    static constexpr Coeffs design(uint32_t periodUs) {
+        Coeffs c = { iir::toQ(1.0), 0, 0, 0, 0 };
+        if (periodUs == 0) return c;
+        double fs = 1e6 / periodUs;
+        double fc = CutoffMilliHz * 1e-3;
+        if (fc >= iir::MAX_CUTOFF_RATIO * fs) return c;
+        double w0 = 2 * iir::PI_D * fc / fs;
+        double cw = iir::cos(w0);
+        double alpha = iir::sin(w0) / (2 * QMilli * 1e-3);
+        double a0 = 1 + alpha;
+        c.b0 = iir::toQ((1 - cw) / 2 / a0);
+        c.b1 = iir::toQ((1 - cw) / a0);
+        c.b2 = c.b0;
+        c.a1 = iir::toQ(-2 * cw / a0);
+        c.a2 = iir::toQ((1 - alpha) / a0);
+        return c;
+    }
+
+    void configure(uint8_t odr) {
+        static constexpr iir::CoeffTable<Coeffs, design> table;
+        _c = table.row[odr < QMI8658_ACC_ODR_COUNT ? odr : 0];
+    }
+
+    // Unity DC gain: a constant input passes through
+    int32_t prime(int32_t x) { _x1 = _x2 = _y1 = _y2 = x; return x; }
+
+    int32_t process(int32_t x) {
+        int64_t acc = (int64_t)_c.b0 * x + (int64_t)_c.b1 * _x1 + (int64_t)_c.b2 * _x2
+                    - (int64_t)_c.a1 * _y1 - (int64_t)_c.a2 * _y2;
+        int32_t y = iir::roundShift(acc, IIR_COEFF_SHIFT);
+        _x2 = _x1; _x1 = x;
+        _y2 = _y1; _y1 = y;
+        return y;
+    }
+
+private:
+    Coeffs _c = { 0, 0, 0, 0, 0 };
+    int32_t _x1 = 0, _x2 = 0;
+    int32_t _y1 = 0, _y2 = 0;
+};
+
+/**
+ * @brief Stages applied in order (recursively unrolled at compile time)
+ */
+template <class... Stages>
+class IirChain {
+public:
+    void configure(uint8_t) {}
+    int32_t prime(int32_t x) { return x; }
+    int32_t process(int32_t x) { return x; }
+};
+
+template <class First, class... Rest>
+class IirChain<First, Rest...> {
+public:
+    void configure(uint8_t odr) { _first.configure(odr); _rest.configure(odr); }
+    int32_t prime(int32_t x) { return _rest.prime(_first.prime(x)); }
+    int32_t process(int32_t x) { return _rest.process(_first.process(x)); }
+
+private:
+    First _first;
+    IirChain<Rest...> _rest;
+};
+
+/**
+ * @brief One chain per axis, int16 counts in and out
+ */
+template <class Chain>
+class IirFilter3 {
+public:
+    void configure(uint8_t odr) {
+        for (int axis = 0; axis < 3; axis++) _axis[axis].configure(odr);
+        _primed = false;
+    }
+
+    // Next sample re-initialises the state (after a gap or a rate change)
+    void reset() { _primed = false; }
+
+    void process(const int16_t* in, int16_t* out) {
+        for (int axis = 0; axis < 3; axis++) {
+            int32_t x = (int32_t)in[axis] << IIR_SIGNAL_SHIFT;
+            int32_t y = _primed ? _axis[axis].process(x) : _axis[axis].prime(x);
+            y = iir::roundShift(y, IIR_SIGNAL_SHIFT);
+            out[axis] = (int16_t)constrain(y, -32768, 32767);
+        }
+        _primed = true;
+    }
+
+private:
+    Chain _axis[3];
+    bool _primed = false;
+};
+
+#endif // IIR_FILTER_H
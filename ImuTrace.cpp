@@ -0,0 +1,66 @@
+#include "ImuTrace.h"
+
+ImuTraceRecorder::ImuTraceRecorder()
+    : _head(0)
+    , _count(0)
+    , _pendingFlags(0)
+    , _active(false)
+    , _recorded(0)
+    , _dropped(0)
+{
+    memset(&_header, 0, sizeof(_header));
+}
+
+void ImuTraceRecorder::start(const ImuTraceHeader& header) {
+    _header = header;
+    _head = 0;
+    _count = 0;
+    _recorded = 0;
+    _dropped = 0;
+    // The detector state before the first record is unknown to a replay
+    _pendingFlags = IMU_TRACE_FLAG_RESYNC;
+    _active = true;
+}
+
+void ImuTraceRecorder::push(const qmi_raw_data_t& sample, bool highRate) {
+    if (!_active) return;
+
+    if (_count == IMU_TRACE_BUFFER_RECORDS) {
+        _dropped++;
+        _pendingFlags |= IMU_TRACE_FLAG_GAP;
+        return;
+    }
+
+    uint16_t tail = _head + _count;
+    if (tail >= IMU_TRACE_BUFFER_RECORDS) tail -= IMU_TRACE_BUFFER_RECORDS;
+
+    ImuTraceRecord& record = _records[tail];
+    record.timestamp = sample.timestamp;
+    memcpy(record.acc, sample.acc, sizeof(record.acc));
+    memcpy(record.gyro, sample.gyro, sizeof(record.gyro));
+    record.temperature = sample.temperature;
+    record.flags = _pendingFlags | (highRate ? IMU_TRACE_FLAG_HIGH_RATE : 0);
+    record.reserved = 0;
+
+    _pendingFlags = 0;
+    _count++;
+    _recorded++;
+}
+
+uint16_t ImuTraceRecorder::read(ImuTraceRecord* out, uint16_t max) {
+    uint16_t n = (max < _count) ? max : _count;
+
+    for (uint16_t i = 0; i < n; i++) {
+        out[i] = _records[_head];
+        _head = (_head + 1 == IMU_TRACE_BUFFER_RECORDS) ? 0 : _head + 1;
+    }
+    _count -= n;
+    return n;
+}
+
+void ImuTraceRecorder::decode(const ImuTraceRecord& record, qmi_raw_data_t* sample) {
+    sample->timestamp = record.timestamp;
+    memcpy(sample->acc, record.acc, sizeof(sample->acc));
+    memcpy(sample->gyro, record.gyro, sizeof(sample->gyro));
+    sample->temperature = record.temperature;
+}
@@ -0,0 +1,105 @@
+#ifndef IMU_TRACE_H
+#define IMU_TRACE_H
+
+#include <Arduino.h>
+#include "Qmi8658c.h"
+
+/*
+ * Binary IMU trace format (little-endian, packed):
+ *
+ *   ImuTraceHeader    once at the start of the stream
+ *   ImuTraceRecord    one per sample read from the sensor, in order
+ *
+ * Records hold raw sensor counts and the extended sample counter exactly as
+ * MotionDetector received them (duplicates included), so feeding them back
+ * through MotionDetector::feedRecord() reproduces the detector decisions.
+ */
+#define IMU_TRACE_MAGIC 0x54554D49UL   // "IMUT"
+#define IMU_TRACE_VERSION 2            // 2: records carry the temperature
+
+// Record flags
+#define IMU_TRACE_FLAG_HIGH_RATE 0x01  // Full-rate configuration (gyroscope on)
+#define IMU_TRACE_FLAG_RESYNC    0x02  // Detector time base restarted before this sample
+#define IMU_TRACE_FLAG_GAP       0x04  // Records were lost before this one (buffer full)
+
+// Capture buffer (records); about 4 s at 250 Hz
+#define IMU_TRACE_BUFFER_RECORDS 1024
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // IMU_TRACE_MAGIC
+    uint16_t version;           // IMU_TRACE_VERSION
+    uint16_t recordSize;        // sizeof(ImuTraceRecord)
+    uint8_t highOdr;            // acc_odr_t at full rate
+    uint8_t idleOdr;            // acc_odr_t while idle (adaptive ODR)
+    uint8_t accScale;           // acc_scale_t
+    uint8_t gyroScale;          // gyro_scale_t
+    uint16_t accSensitivity;    // LSB per g
+    uint16_t gyroSensitivity;   // LSB per dps
+    uint32_t highPeriodUs;      // Sample period at full rate
+    uint32_t idlePeriodUs;      // Sample period while idle
+    uint32_t startMs;           // millis() when the capture started
+    uint8_t reserved[4];
+} ImuTraceHeader;
+
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp;         // Extended sensor sample counter
+    int16_t acc[3];             // Accelerometer counts
+    int16_t gyro[3];            // Gyroscope counts
+    int16_t temperature;        // Cached die temperature (TEMPERATURE_SENSOR_RESOLUTION LSB per degree C)
+    uint8_t flags;              // IMU_TRACE_FLAG_*
+    uint8_t reserved;
+} ImuTraceRecord;
+
+/**
+ * @brief Fixed-size capture buffer between the sampling path and a reader
+ *
+ * The producer never blocks: when the reader falls behind, new records are
+ * dropped and the next stored one carries IMU_TRACE_FLAG_GAP. Not
+ * thread-safe by itself; MotionDetector calls it under its IMU lock.
+ */
+class ImuTraceRecorder {
+public:
+    ImuTraceRecorder();
+
+    void start(const ImuTraceHeader& header);
+    void stop() { _active = false; }
+    bool isActive() const { return _active; }
+    const ImuTraceHeader& getHeader() const { return _header; }
+
+    /**
+     * @brief Store one sample (no-op unless active)
+     */
+    void push(const qmi_raw_data_t& sample, bool highRate);
+
+    /**
+     * @brief Flag the next record as the start of a new time base
+     */
+    void markResync() { _pendingFlags |= IMU_TRACE_FLAG_RESYNC; }
+
+    /**
+     * @brief Take up to max records, oldest first
+     * @return Number of records copied
+     */
+    uint16_t read(ImuTraceRecord* out, uint16_t max);
+
+    uint16_t available() const { return _count; }
+    uint32_t getRecorded() const { return _recorded; }
+    uint32_t getDropped() const { return _dropped; }
+
+    /**
+     * @brief Convert a record back to a raw sample
+     */
+    static void decode(const ImuTraceRecord& record, qmi_raw_data_t* sample);
+
+private:
+    ImuTraceHeader _header;
+    ImuTraceRecord _records[IMU_TRACE_BUFFER_RECORDS];
+    uint16_t _head;
+    uint16_t _count;
+    uint8_t _pendingFlags;
+    bool _active;
+    uint32_t _recorded;
+    uint32_t _dropped;
+};
+
+#endif // IMU_TRACE_H
@@ -1,23 +1,59 @@
 #include "LightSensor.h"
 
-LightSensor::LightSensor(uint8_t address)
-    : _address(address)
+// BH1750 instruction set
+#define BH1750_POWER_ON             0x01
+#define BH1750_ONE_TIME_HIGH_RES    0x20  // 1 lx resolution at MTreg 69, then power down
+#define BH1750_ONE_TIME_HIGH_RES_2  0x21  // 0.5 lx resolution at MTreg 69, then power down
+#define BH1750_MTREG_HIGH           0x40  // | MTreg[7:5]
+#define BH1750_MTREG_LOW            0x60  // | MTreg[4:0]
+
+// Raw count to lux at the default measurement time
+#define BH1750_COUNTS_PER_LUX       1.2f
+
+// Maximum high-resolution conversion time at the default MTreg (scales with MTreg)
+#define BH1750_CONVERSION_MAX_MS    180
+
+LightSensor::LightSensor(I2CBus& bus, uint8_t address)
+    : _device(bus, address, "bh1750")
+    , _address(address)
     , _nightThreshold(10.0f)  // Default: 10 lux
+    , _dayThreshold(10.0f * LIGHT_DAY_THRESHOLD_RATIO)
     , _lastLux(0.0f)
     , _isNight(false)
     , _isInitialized(false)
+    , _hasReading(false)
+    , _samplingEnabled(true)
+    , _consecutiveFailures(0)
+    , _minDwellMs(LIGHT_MIN_DWELL_MS)
+    , _crossingSince(0)
+    , _lastReadMs(0)
+    , _sampleIntervalMs(LIGHT_SAMPLE_MIN_MS)
+    , _readCount(0)
+    , _state(State::IDLE)
+    , _measureStartMs(0)
+    , _conversionMs(0)
+    , _mtreg(LIGHT_MTREG_DEFAULT)  // Power-on default
+    , _nextMtreg(LIGHT_MTREG_DEFAULT)
+    , _nextHighRes2(false)
+    , _measureMtreg(LIGHT_MTREG_DEFAULT)
+    , _measureHighRes2(false)
+    , _instantLux(0.0f)
+    , _lastFilterMs(0)
+    , _rawLux(0.0f)
+    , _luxPerBrightness(0.0f)
+    , _couplingProbes(0)
+    , _selfBrightness(0)
+    , _measureBrightness(0)
+    , _measureDisturbed(false)
+    , _measurementCount(0)
 {
 }
 
-bool LightSensor::begin(int sda, int scl) {
-    // Initialize I2C with specified pins
-    Wire.begin(sda, scl);
-    
-    // Initialize BH1750 sensor with the specified address
-    _isInitialized = _sensor.begin(BH1750::CONTINUOUS_HIGH_RES_MODE, _address);
+bool LightSensor::begin() {
+    _isInitialized = _device.writeByte(BH1750_POWER_ON);
     
     if (_isInitialized) {
-        // Perform initial reading
+        // Blocking only here, so the night state is valid before the control loop runs
         readLux();
     }
     
@@ -29,16 +65,227 @@ float LightSensor::readLux() {
         return -1.0f;
     }
     
-    // Read light level from sensor
-    _lastLux = _sensor.readLightLevel();
+    if (_state != State::MEASURING && !startMeasurement()) {
+        return -1.0f;
+    }
+    unsigned long elapsed = millis() - _measureStartMs;
+    if (elapsed < _conversionMs) {
+        delay(_conversionMs - elapsed);
+    }
+    
+    return collect() ? _lastLux : -1.0f;  // Keep last valid reading on error
+}
+
+bool LightSensor::update() {
+    if (!_isInitialized) {
+        return false;
+    }
+    
+    unsigned long now = millis();
+    if (_state == State::MEASURING) {
+        return (now - _measureStartMs >= _conversionMs) && collect();
+    }
+    
+    if (!_samplingEnabled || (_readCount > 0 && now - _lastReadMs < _sampleIntervalMs)) {
+        return false;
+    }
+    if (!startMeasurement()) {
+        // Count the attempt so a dead sensor is retried at the fastest rate, not every loop
+        _lastReadMs = now;
+        _readCount++;
+        _sampleIntervalMs = LIGHT_SAMPLE_MIN_MS;
+        if (_consecutiveFailures < 0xFF) _consecutiveFailures++;
+    }
+    return false;
+}
+
+bool LightSensor::startMeasurement() {
+    if (_nextMtreg != _mtreg) {
+        if (!_device.writeByte(BH1750_MTREG_HIGH | (_nextMtreg >> 5)) ||
+            !_device.writeByte(BH1750_MTREG_LOW | (_nextMtreg & 0x1F))) {
+            _mtreg = 0;  // Unknown: rewrite next time
+            return false;
+        }
+        _mtreg = _nextMtreg;
+    }
+    
+    if (!_device.writeByte(_nextHighRes2 ? BH1750_ONE_TIME_HIGH_RES_2 : BH1750_ONE_TIME_HIGH_RES)) {
+        return false;
+    }
+    
+    _measureMtreg = _mtreg;
+    _measureHighRes2 = _nextHighRes2;
+    _measureBrightness = _selfBrightness;
+    _measureDisturbed = false;
+    _conversionMs = ((unsigned long)BH1750_CONVERSION_MAX_MS * _mtreg + LIGHT_MTREG_DEFAULT - 1) / LIGHT_MTREG_DEFAULT;
+    _measureStartMs = millis();
+    _state = State::MEASURING;
+    return true;
+}
+
+bool LightSensor::collect() {
+    _state = State::IDLE;
+    
+    unsigned long now = millis();
+    _lastReadMs = now;
+    
+    // The strip changed during the integration: the reading mixes two levels
+    if (_measureDisturbed) {
+        _sampleIntervalMs = 0;
+        return false;
+    }
+    _readCount++;
+    
+    // Read light level from sensor (big-endian raw count)
+    uint8_t raw[2];
+    if (!_device.read(raw, sizeof(raw))) {
+        _sampleIntervalMs = LIGHT_SAMPLE_MIN_MS;  // Retry soon
+        if (_consecutiveFailures < 0xFF) _consecutiveFailures++;
+        return false;
+    }
+    _consecutiveFailures = 0;
+    uint16_t counts = ((uint16_t)raw[0] << 8) | raw[1];
+    _rawLux = counts * getResolution();
+    
+    // Remove the strip's own contribution (PWM is averaged by the integration)
+    float selfLux = _luxPerBrightness * _measureBrightness;
+    _instantLux = (_rawLux > selfLux) ? _rawLux - selfLux : 0.0f;
+    _measurementCount++;
+    
+    // Spikes shorter than half the median window never reach the decision
+    _lastLux = _filter.update(_instantLux, now - _lastFilterMs);
+    _lastFilterMs = now;
     
     // Update night detection status
-    updateNightStatus();
+    updateNightStatus(now);
+    
+    // A saturated reading is only a lower bound: measure again right away
+    bool saturated = (counts == 0xFFFF);
+    chooseSensitivity(saturated);
+    _sampleIntervalMs = saturated ? LIGHT_SAMPLE_MIN_MS : computeSampleInterval();
+    
+    return true;
+}
+
+float LightSensor::getResolution() const {
+    return (float)LIGHT_MTREG_DEFAULT /
+           (BH1750_COUNTS_PER_LUX * _measureMtreg * (_measureHighRes2 ? 2 : 1));
+}
+
+void LightSensor::chooseSensitivity(bool saturated) {
+    if (saturated) {
+        _nextMtreg = LIGHT_MTREG_MIN;
+        _nextHighRes2 = false;
+        return;
+    }
+    
+    // MTreg that puts the current level at the target count in H-resolution mode 2
+    // (the sensor sees the uncompensated light)
+    float counts = _rawLux * BH1750_COUNTS_PER_LUX * 2.0f;
+    if (counts < 0.01f) counts = 0.01f;
+    float mtreg = (float)LIGHT_TARGET_COUNTS * LIGHT_MTREG_DEFAULT / counts;
+    
+    // Too bright for mode 2 even at the shortest time: mode 1 doubles the range
+    _nextHighRes2 = (mtreg >= LIGHT_MTREG_MIN);
+    if (!_nextHighRes2) {
+        mtreg *= 2.0f;
+    }
+    if (mtreg < LIGHT_MTREG_MIN) mtreg = LIGHT_MTREG_MIN;
+    if (mtreg > LIGHT_MTREG_MAX) mtreg = LIGHT_MTREG_MAX;
+    _nextMtreg = (uint8_t)mtreg;
+}
+
+void LightSensor::setSamplingEnabled(bool enabled) {
+    if (enabled && !_samplingEnabled) {
+        // The last reading may be hours old: start over
+        _sampleIntervalMs = 0;
+        _filter.reset();
+    }
+    _samplingEnabled = enabled;
+}
+
+void LightSensor::setFilter(uint8_t medianSize, unsigned long riseTauMs, unsigned long fallTauMs) {
+    _filter.configure(medianSize, riseTauMs, fallTauMs);
+}
+
+void LightSensor::setSelfIllumination(uint8_t brightness) {
+    if (_state == State::MEASURING && brightness != _measureBrightness) {
+        _measureDisturbed = true;
+    }
+    _selfBrightness = brightness;
+}
+
+float LightSensor::learnSelfCoupling(float luxOn, float luxOff, uint8_t brightness) {
+    if (brightness == 0) {
+        return _luxPerBrightness;
+    }
+    
+    float sample = (luxOn > luxOff) ? (luxOn - luxOff) / brightness : 0.0f;
+    if (_couplingProbes == 0) {
+        _luxPerBrightness = sample;
+    } else {
+        _luxPerBrightness += (sample - _luxPerBrightness) * LIGHT_COUPLING_EMA;
+    }
+    if (_couplingProbes < 0xFFFF) _couplingProbes++;
+    return _luxPerBrightness;
+}
+
+void LightSensor::setNightThreshold(float threshold) {
+    setNightThresholds(threshold, threshold * LIGHT_DAY_THRESHOLD_RATIO);
+}
+
+void LightSensor::setNightThresholds(float night, float day) {
+    _nightThreshold = night;
+    _dayThreshold = (day < night) ? night : day;
+    _crossingSince = 0;
+    
+    // The new thresholds may be close to the current level: re-read soon
+    _sampleIntervalMs = LIGHT_SAMPLE_MIN_MS;
+}
+
+void LightSensor::updateNightStatus(unsigned long now) {
+    if (!_hasReading) {
+        // First reading: nothing to be hysteretic about
+        _isNight = (_lastLux < _nightThreshold);
+        _hasReading = true;
+        return;
+    }
     
-    return _lastLux;
+    // Only the threshold on the far side of the band can change the state
+    bool crossing = _isNight ? (_lastLux > _dayThreshold) : (_lastLux < _nightThreshold);
+    if (!crossing) {
+        _crossingSince = 0;
+        return;
+    }
+    
+    if (_crossingSince == 0) {
+        _crossingSince = now ? now : 1;
+    }
+    if (now - _crossingSince >= _minDwellMs) {
+        _isNight = !_isNight;
+        _crossingSince = 0;
+    }
 }
 
-void LightSensor::updateNightStatus() {
-    // Determine if it's night based on threshold
-    _isNight = (_lastLux < _nightThreshold);
+unsigned long LightSensor::computeSampleInterval() const {
+    // A pending change is confirmed (or rejected) at the fastest rate
+    if (_crossingSince != 0) {
+        return LIGHT_SAMPLE_MIN_MS;
+    }
+    
+    // How far (as a ratio) the reading is from the threshold that would flip the state
+    float ratio;
+    if (_isNight) {
+        if (_lastLux <= 0.0f) return LIGHT_SAMPLE_MAX_MS;
+        ratio = _dayThreshold / _lastLux;
+    } else {
+        if (_nightThreshold <= 0.0f) return LIGHT_SAMPLE_MAX_MS;
+        ratio = _lastLux / _nightThreshold;
+    }
+    
+    if (ratio <= 1.0f) {
+        return LIGHT_SAMPLE_MIN_MS;
+    }
+    float interval = LIGHT_SAMPLE_MIN_MS * ratio * ratio;
+    return (interval >= LIGHT_SAMPLE_MAX_MS) ? LIGHT_SAMPLE_MAX_MS : (unsigned long)interval;
 }
@@ -1,48 +1,178 @@
 #ifndef LIGHT_SENSOR_H
 #define LIGHT_SENSOR_H
 
-#include <Wire.h>
-#include <BH1750.h>
+#include <Arduino.h>
+#include "I2CBus.h"
+#include "LuxFilter.h"
+
+// Night/day hysteresis: night starts below the night threshold and ends above
+// threshold * LIGHT_DAY_THRESHOLD_RATIO; either change must persist for the dwell time
+#define LIGHT_DAY_THRESHOLD_RATIO 1.5f
+#define LIGHT_MIN_DWELL_MS 30000
+
+// Adaptive sampling: the interval grows with the square of the ratio between the
+// reading and the threshold that would change the state (2x away: 2 s, 10x: 50 s)
+#define LIGHT_SAMPLE_MIN_MS 500
+#define LIGHT_SAMPLE_MAX_MS 60000
+
+// One-shot measurements: the measurement time register (MTreg, 31..254) and the
+// resolution mode are chosen from the previous reading so the next raw count lands
+// near LIGHT_TARGET_COUNTS (0.11 lx per count in the dark, up to ~120 klx in sun)
+#define LIGHT_MTREG_MIN 31
+#define LIGHT_MTREG_DEFAULT 69
+#define LIGHT_MTREG_MAX 254
+#define LIGHT_TARGET_COUNTS 20000
+
+// Self-illumination: weight of a new probe result in the lux-per-brightness estimate
+#define LIGHT_COUPLING_EMA 0.25f
+
+// Consecutive failed readings before isReady() reports the sensor as failed
+#define LIGHT_MAX_FAILURES 5
 
 /**
  * @brief Light sensor wrapper class for BH1750
  * 
  * Manages the BH1750 ambient light sensor with OOP principles.
- * Provides lux readings and night/day detection based on configurable threshold.
+ * Provides lux readings and night/day detection with separate enter/exit
+ * thresholds and a minimum dwell time, sampled on an adaptive schedule.
+ * Each reading is a one-time measurement (the sensor powers down after it):
+ * update() starts it and collects the result on a later call once the
+ * conversion time has passed, so the caller never waits.
+ * Light from the LED strip that reaches the sensor is subtracted using a
+ * learned lux-per-brightness factor; readings during which the strip
+ * brightness changed are discarded. The compensated value then goes
+ * through a median + EMA filter (see LuxFilter) so a passing headlight or
+ * torch does not turn night into day.
+ * The sensor is driven directly through the shared I2CBus so its transactions
+ * are bounded and counted like the IMU's.
  */
 class LightSensor {
 public:
     /**
      * @brief Constructor
+     * @param bus Shared I2C bus
      * @param address I2C address of the BH1750 sensor
      */
-    explicit LightSensor(uint8_t address = 0x23);
+    explicit LightSensor(I2CBus& bus, uint8_t address = 0x23);
     
     /**
-     * @brief Initialize the sensor
-     * @param sda SDA pin for I2C
-     * @param scl SCL pin for I2C
+     * @brief Initialize the sensor and take a first (blocking) reading
      * @return true if initialization successful, false otherwise
+     * @note The bus must already be started
      */
-    bool begin(int sda, int scl);
+    bool begin();
     
     /**
-     * @brief Read current light level in lux
+     * @brief Measure now, waiting for the conversion (setup/diagnostics only)
      * @return Light level in lux, or -1.0f on error
      */
     float readLux();
     
     /**
-     * @brief Check if it's currently night (below threshold)
+     * @brief Advance the measurement state machine (non-blocking)
+     *
+     * Starts a measurement when the adaptive sampling interval has elapsed and
+     * collects it once the conversion time has passed.
+     * @return true if a new reading completed
+     */
+    bool update();
+    
+    /**
+     * @brief Report the LED strip brightness (call before every update())
+     */
+    void setSelfIllumination(uint8_t brightness);
+    
+    /**
+     * @brief Pause or resume sampling (a measurement in progress still completes)
+     * Resuming starts a measurement on the next update().
+     */
+    void setSamplingEnabled(bool enabled);
+    bool isSamplingEnabled() const { return _samplingEnabled; }
+    
+    /**
+     * @brief Start a measurement on the next update() regardless of the interval
+     */
+    void requestReading() { _sampleIntervalMs = 0; }
+    
+    /**
+     * @brief Fold one on/off probe into the lux-per-brightness factor
+     * @param luxOn Uncompensated reading with the strip at brightness
+     * @param luxOff Uncompensated reading with the strip off
+     * @param brightness Strip brightness during the "on" reading
+     * @return Updated factor (lux per brightness step)
+     */
+    float learnSelfCoupling(float luxOn, float luxOff, uint8_t brightness);
+    void setSelfCoupling(float luxPerBrightness) {
+        // A stored factor weighs like one probe
+        _luxPerBrightness = luxPerBrightness;
+        _couplingProbes = (luxPerBrightness > 0.0f) ? 1 : 0;
+    }
+    float getSelfCoupling() const { return _luxPerBrightness; }
+    
+    /**
+     * @brief Last reading before self-illumination compensation
+     */
+    float getRawLux() const { return _rawLux; }
+    
+    /**
+     * @brief Strip brightness during the last reading
+     */
+    uint8_t getReadingBrightness() const { return _measureBrightness; }
+    
+    /**
+     * @brief Number of valid readings since boot (increments once per new reading)
+     */
+    uint32_t getMeasurementCount() const { return _measurementCount; }
+    
+    /**
+     * @brief Measurement time register used for the last reading
+     */
+    uint8_t getMTreg() const { return _measureMtreg; }
+    
+    /**
+     * @brief Lux per raw count of the last reading
+     */
+    float getResolution() const;
+    
+    /**
+     * @brief Check if it's currently night (with hysteresis and dwell)
      * @return true if light level is below night threshold
      */
     bool isNight() const { return _isNight; }
     
     /**
-     * @brief Set the night threshold in lux
+     * @brief Set the night threshold in lux (the day threshold follows it)
      * @param threshold Lux value below which it's considered night
      */
-    void setNightThreshold(float threshold) { _nightThreshold = threshold; }
+    void setNightThreshold(float threshold);
+    
+    /**
+     * @brief Set both thresholds explicitly
+     * @param night Lux value below which night starts
+     * @param day Lux value above which night ends (>= night)
+     */
+    void setNightThresholds(float night, float day);
+    
+    /**
+     * @brief Get the lux value above which night ends
+     */
+    float getDayThreshold() const { return _dayThreshold; }
+    
+    /**
+     * @brief Set how long a crossing must persist before the state changes
+     */
+    void setMinDwellMs(unsigned long ms) { _minDwellMs = ms; }
+    unsigned long getMinDwellMs() const { return _minDwellMs; }
+    
+    /**
+     * @brief Current interval between readings (ms)
+     */
+    unsigned long getSampleIntervalMs() const { return _sampleIntervalMs; }
+    
+    /**
+     * @brief Number of readings taken since boot
+     */
+    uint32_t getReadCount() const { return _readCount; }
     
     /**
      * @brief Get the current night threshold
@@ -52,26 +182,94 @@ public:
     
     /**
      * @brief Get the last measured lux value
-     * @return Last lux reading
+     * @return Last lux reading (compensated and filtered)
      */
     float getLastLux() const { return _lastLux; }
     
+    /**
+     * @brief Last reading after self-illumination compensation, before filtering
+     */
+    float getInstantLux() const { return _instantLux; }
+    
+    /**
+     * @brief Configure the spike filter
+     * @param medianSize Median window (odd, 1 disables it)
+     * @param riseTauMs EMA time constant for increasing light (0 = none)
+     * @param fallTauMs EMA time constant for decreasing light (0 = none)
+     */
+    void setFilter(uint8_t medianSize, unsigned long riseTauMs, unsigned long fallTauMs);
+    const LuxFilter& getFilter() const { return _filter; }
+    
     /**
      * @brief Check if sensor is initialized and working
-     * @return true if sensor is ready
+     * @return true if sensor is ready (false after LIGHT_MAX_FAILURES failed readings in a row)
+     */
+    bool isReady() const { return _isInitialized && _consecutiveFailures < LIGHT_MAX_FAILURES; }
+    
+    /**
+     * @brief Get bus statistics for the sensor
+     * @return I2C device handle
      */
-    bool isReady() const { return _isInitialized; }
+    const I2CDevice& getI2CDevice() const { return _device; }
 
 private:
-    BH1750 _sensor;
+    I2CDevice _device;
     uint8_t _address;
     float _nightThreshold;
+    float _dayThreshold;
     float _lastLux;
     bool _isNight;
     bool _isInitialized;
+    bool _hasReading;
+    bool _samplingEnabled;
+    uint8_t _consecutiveFailures;
+    
+    // Hysteresis state
+    unsigned long _minDwellMs;
+    unsigned long _crossingSince;   // 0 = no pending state change
+    
+    // Sampling schedule
+    unsigned long _lastReadMs;
+    unsigned long _sampleIntervalMs;
+    uint32_t _readCount;
+    
+    // One-shot measurement state machine
+    enum class State : uint8_t {
+        IDLE,
+        MEASURING
+    };
+    State _state;
+    unsigned long _measureStartMs;
+    unsigned long _conversionMs;
+    uint8_t _mtreg;             // Value programmed in the sensor
+    uint8_t _nextMtreg;         // Chosen from the last reading
+    bool _nextHighRes2;
+    uint8_t _measureMtreg;      // Settings of the measurement in progress / last collected
+    bool _measureHighRes2;
+    
+    // Spike filter
+    LuxFilter _filter;
+    float _instantLux;
+    unsigned long _lastFilterMs;
+    
+    // Self-illumination compensation
+    float _rawLux;
+    float _luxPerBrightness;
+    uint16_t _couplingProbes;
+    uint8_t _selfBrightness;    // Last reported strip brightness
+    uint8_t _measureBrightness; // Strip brightness when the measurement started
+    bool _measureDisturbed;     // Brightness changed during the conversion
+    uint32_t _measurementCount;
+    
+    bool startMeasurement();
+    bool collect();
+    void chooseSensitivity(bool saturated);
     
     // Update night detection based on current lux reading
-    void updateNightStatus();
+    void updateNightStatus(unsigned long now);
+    
+    // Interval until the next reading, from the distance to the active threshold
+    unsigned long computeSampleInterval() const;
 };
 
 #endif // LIGHT_SENSOR_H
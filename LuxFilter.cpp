@@ -0,0 +1,60 @@
+#include "LuxFilter.h"
+
+LuxFilter::LuxFilter()
+    : _size(LUX_FILTER_DEFAULT_MEDIAN)
+    , _count(0)
+    , _head(0)
+    , _riseTauMs(LUX_FILTER_DEFAULT_RISE_TAU_MS)
+    , _fallTauMs(LUX_FILTER_DEFAULT_FALL_TAU_MS)
+    , _value(0.0f)
+{
+}
+
+void LuxFilter::configure(uint8_t medianSize, unsigned long riseTauMs, unsigned long fallTauMs) {
+    if (medianSize < 1) medianSize = 1;
+    if (medianSize > LUX_FILTER_MAX_MEDIAN) medianSize = LUX_FILTER_MAX_MEDIAN;
+    _size = medianSize | 1;  // Odd, so the median is a real sample
+    if (_size > LUX_FILTER_MAX_MEDIAN) _size -= 2;
+    _riseTauMs = riseTauMs;
+    _fallTauMs = fallTauMs;
+    reset();
+}
+
+void LuxFilter::reset() {
+    _count = 0;
+    _head = 0;
+    _value = 0.0f;
+}
+
+float LuxFilter::update(float lux, unsigned long dtMs) {
+    _window[_head] = lux;
+    _head = (_head + 1 == _size) ? 0 : _head + 1;
+    bool first = (_count == 0);
+    if (_count < _size) _count++;
+
+    float m = median();
+    if (first) {
+        _value = m;
+        return _value;
+    }
+
+    unsigned long tau = (m > _value) ? _riseTauMs : _fallTauMs;
+    float alpha = (tau == 0) ? 1.0f : (float)dtMs / (float)(tau + dtMs);
+    _value += alpha * (m - _value);
+    return _value;
+}
+
+float LuxFilter::median() const {
+    // Insertion sort of a copy: at most LUX_FILTER_MAX_MEDIAN elements
+    float sorted[LUX_FILTER_MAX_MEDIAN] = {};
+    for (uint8_t i = 0; i < _count; i++) {
+        float x = _window[i];
+        int8_t j = i - 1;
+        while (j >= 0 && sorted[j] > x) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = x;
+    }
+    return sorted[(_count - 1) / 2];
+}
@@ -0,0 +1,71 @@
+#ifndef LUX_FILTER_H
+#define LUX_FILTER_H
+
+#include <stdint.h>
+
+// Longest median window (samples)
+#define LUX_FILTER_MAX_MEDIAN 7
+
+// Defaults: a 5-sample median drops spikes shorter than 3 readings, the slow rise
+// keeps a passing headlight from reaching the day threshold, the fast fall keeps
+// dusk (and a shadow) responsive
+#define LUX_FILTER_DEFAULT_MEDIAN 5
+#define LUX_FILTER_DEFAULT_RISE_TAU_MS 20000
+#define LUX_FILTER_DEFAULT_FALL_TAU_MS 3000
+
+/**
+ * @brief Spike-rejecting lux filter: fixed-size median window feeding an EMA
+ *
+ * The EMA has separate time constants for rising and falling light and uses
+ * the real time between readings (the light sensor samples at an adaptive
+ * interval): alpha = dt / (tau + dt), the discretised first-order low-pass,
+ * so no transcendental function is needed.
+ *
+ * No allocation; worst-case cost per sample is one ring-buffer store, a copy
+ * of at most LUX_FILTER_MAX_MEDIAN floats, an insertion sort of them (21
+ * compare/moves for 7, 10 for the default 5) and one float division: well
+ * under 2 us on the ESP32-S3 FPU.
+ */
+class LuxFilter {
+public:
+    LuxFilter();
+
+    /**
+     * @brief Set the median length (odd, 1..LUX_FILTER_MAX_MEDIAN) and the
+     * EMA time constants (0 = no smoothing in that direction); clears the state
+     */
+    void configure(uint8_t medianSize, unsigned long riseTauMs, unsigned long fallTauMs);
+
+    /**
+     * @brief Drop all samples: the next one seeds the filter
+     */
+    void reset();
+
+    /**
+     * @brief Add a sample
+     * @param lux Instantaneous reading
+     * @param dtMs Time since the previous sample (ignored for the first one)
+     * @return Filtered value
+     */
+    float update(float lux, unsigned long dtMs);
+
+    float getValue() const { return _value; }
+    bool isPrimed() const { return _count > 0; }
+    uint8_t getMedianSize() const { return _size; }
+    unsigned long getRiseTauMs() const { return _riseTauMs; }
+    unsigned long getFallTauMs() const { return _fallTauMs; }
+
+private:
+    float _window[LUX_FILTER_MAX_MEDIAN];
+    uint8_t _size;
+    uint8_t _count;
+    uint8_t _head;
+    unsigned long _riseTauMs;
+    unsigned long _fallTauMs;
+    float _value;
+
+    // Median of the samples held so far (lower middle while filling with an even count)
+    float median() const;
+};
+
+#endif // LUX_FILTER_H
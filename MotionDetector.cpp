@@ -1,24 +1,102 @@
 #include "MotionDetector.h"
 #include <Arduino.h>
 #include <math.h>
+#include <Preferences.h>
+
+// Reference for filtered signals: the high-pass already removed the offset
+static const int16_t ZERO_XYZ[3] = { 0, 0, 0 };
+
+// Goertzel bin frequencies (Hz)
+static const float SPECTRUM_BINS_HZ[MOTION_SPECTRUM_BIN_COUNT] = MOTION_SPECTRUM_BINS_HZ;
 
 MotionDetector::MotionDetector(Qmi8658c* imu) 
     : _imu(imu),
+      _fifoEnabled(false),
+      _samplePeriodUs(0),
+      _samplesProcessed(0),
+      _fifoOverflows(0),
+      _samplingTask(nullptr),
+      _imuMutex(nullptr),
+      _interruptCount(0),
+      _lastInterruptUs(0),
+      _fallbackPollCount(0),
+      _lastWakeLatencyUs(0),
+      _intPin(-1),
+      _imuIntLine(1),
+      _samplingPaused(false),
+      _womArmed(false),
+      _adaptiveOdr(false),
+      _highRate(true),
+      _batchHadMotion(false),
+      _odrQuietMs(0),
+      _adaptiveSince(0),
+      _odrModeSince(0),
+      _highRateMs(0),
+      _gyroValidFrom(0),
+      _odrSwitches(0),
+      _lastMotionWallMs(0),
+      _stampValid(false),
+      _lastStamp(0),
+      _sensorMs(0),
+      _sensorUsRem(0),
+      _droppedSamples(0),
+      _duplicateSamples(0),
       _accMotionThreshold(0.10),
       _gyroMotionThreshold(5.0),
       _motionWindowMs(500),
       _motionStopDelayMs(1000),
       _motionPulseCount(3),
-      _accBaselineX(0), _accBaselineY(0), _accBaselineZ(0),
-      _gyroBaselineX(0), _gyroBaselineY(0), _gyroBaselineZ(0),
+      _filterEnabled(false),
+      _axisWeighting(false),
+      _accNoiseSamples(0),
+      _gyroNoiseSamples(0),
+      _gyroBiasEnabled(false),
+      _gyroBiasTemp(0),
+      _gyroBiasRefreshMs(0),
+      _gyroBiasStale(true),
+      _bladePower(0),
+      _locomotionPower(0),
+      _bladePowerThreshold(0),
+      _locomotionPowerThreshold(0),
+      _bladeRunning(false),
+      _bladeBlocks(0),
+      _spectrumValid(false),
+      _detectionMode(DetectionMode::PULSE),
+      _windowMs(250),
+      _rmsStrategy(false),
+      _varianceStrategy(true),
+      _strategy(&_pulseStrategy),
+      _shadow(nullptr),
+      _shadowMode(DetectionMode::PULSE),
+      _accThresholdSq(0),
+      _gyroThresholdSq(0),
       _isCalibrated(false),
+      _baselineTracking(false),
+      _quietStart(0),
+      _baselineFastRemaining(0),
+      _baselineUpdates(0),
+      _baselineSavePending(false),
+      _lastBaselineSaveMs(0),
       _isMoving(false),
-      _lastMotionTime(0),
-      _motionWindowStart(0),
-      _motionPulseCounter(0),
-      _lastPulseTime(0),
-      _maxAccDeviation(0),
-      _maxGyroDeviation(0) {
+      _lastSampleTime(0),
+      _maxAccDeviationSq(0),
+      _maxGyroDeviationSq(0) {
+    memset(&_data, 0, sizeof(_data));
+    memset(&_activeCfg, 0, sizeof(_activeCfg));
+    memset(_accBaseline, 0, sizeof(_accBaseline));
+    memset(_gyroBaseline, 0, sizeof(_gyroBaseline));
+    memset(_accBaselineQ, 0, sizeof(_accBaselineQ));
+    memset(_gyroBaselineQ, 0, sizeof(_gyroBaselineQ));
+    memset(_savedAccBaseline, 0, sizeof(_savedAccBaseline));
+    memset(_accSignal, 0, sizeof(_accSignal));
+    memset(_gyroSignal, 0, sizeof(_gyroSignal));
+    memset(_accNoiseQ, 0, sizeof(_accNoiseQ));
+    memset(_gyroNoiseQ, 0, sizeof(_gyroNoiseQ));
+    for (int axis = 0; axis < 3; axis++) {
+        _accAxisWeight[axis] = 1UL << MOTION_WINDOW_WEIGHT_SHIFT;
+        _gyroAxisWeight[axis] = 1UL << MOTION_WINDOW_WEIGHT_SHIFT;
+    }
+    resetShadowStats();
 }
 
 bool MotionDetector::begin(qmi8658_cfg_t* config) {
@@ -28,12 +106,27 @@ bool MotionDetector::begin(qmi8658_cfg_t* config) {
         return false;
     }
     
+    _activeCfg = *config;
+    _highRate = true;
+    _samplePeriodUs = Qmi8658c::acc_odr_period_us(config->acc_odr);
+    updateScaledThresholds();
+    updateWindowLength();
+    configureFilters(config->acc_odr);
+    configureSpectrum();
+    _orientation.configure(_samplePeriodUs, _imu->acc_sensitivity(), _imu->gyro_sensitivity());
+    
+    // Warm start from the last persisted baseline
+    if (loadBaseline()) {
+        _isCalibrated = true;
+    }
+    loadGyroBias();
+    
     // Wait for sensor to stabilize
     delay(100);
     
     // Perform dummy reads to flush initial values
     for(int i = 0; i < 5; i++) {
-        _imu->read(&_data);
+        _imu->read_raw(&_data);
         delay(20);
     }
     
@@ -41,138 +134,1191 @@ bool MotionDetector::begin(qmi8658_cfg_t* config) {
 }
 
 void MotionDetector::calibrate(int samples) {
-    float accSumX = 0, accSumY = 0, accSumZ = 0;
-    float gyroSumX = 0, gyroSumY = 0, gyroSumZ = 0;
+    lockImu();
+    
+    // The gyroscope baseline needs the full configuration
+    if (!_highRate) {
+        setHighRate(true, millis());
+        delay(MOTION_GYRO_SETTLE_MS);
+    }
+    
+    int32_t accSum[3] = { 0, 0, 0 };
+    int32_t gyroSum[3] = { 0, 0, 0 };
+    
+    if (samples < 1) samples = 1;
     
     for (int i = 0; i < samples; i++) {
-        _imu->read(&_data);
-        accSumX += _data.acc_xyz.x;
-        accSumY += _data.acc_xyz.y;
-        accSumZ += _data.acc_xyz.z;
-        gyroSumX += _data.gyro_xyz.x;
-        gyroSumY += _data.gyro_xyz.y;
-        gyroSumZ += _data.gyro_xyz.z;
+        _imu->read_raw_motion(&_data);
+        for (int axis = 0; axis < 3; axis++) {
+            accSum[axis] += _data.acc[axis];
+            gyroSum[axis] += _data.gyro[axis];
+        }
         delay(10);
     }
     
-    _accBaselineX = accSumX / samples;
-    _accBaselineY = accSumY / samples;
-    _accBaselineZ = accSumZ / samples;
-    _gyroBaselineX = gyroSumX / samples;
-    _gyroBaselineY = gyroSumY / samples;
-    _gyroBaselineZ = gyroSumZ / samples;
+    int16_t acc[3], gyro[3];
+    for (int axis = 0; axis < 3; axis++) {
+        acc[axis] = (int16_t)(accSum[axis] / samples);
+        gyro[axis] = (int16_t)(gyroSum[axis] / samples);
+    }
+    setBaseline(acc, gyro);
     
     _isCalibrated = true;
-    _maxAccDeviation = 0;
-    _maxGyroDeviation = 0;
-    _motionPulseCounter = 0;
-    _motionWindowStart = 0;
+    _baselineFastRemaining = 0;
+    _baselineSavePending = true;
+    _maxAccDeviationSq = 0;
+    _maxGyroDeviationSq = 0;
+    _strategy->reset(_isMoving, _lastSampleTime);
+    if (_shadow) _shadow->reset(_isMoving, _lastSampleTime);
+    _accWindow.reset();
+    _gyroWindow.reset();
+    
+    // Samples queued during calibration are stale
+    if (_fifoEnabled) {
+        _imu->fifo_reset();
+    }
+    resyncSensorTime(millis());
+    
+    unlockImu();
+    saveBaseline();
+}
+
+void MotionDetector::recalibrate() {
+    lockImu();
+    _baselineFastRemaining = MOTION_BASELINE_FAST_SAMPLES;
+    unlockImu();
+}
+
+bool MotionDetector::enableFifo(uint8_t watermark) {
+    if (_samplePeriodUs == 0) return false;  // begin() not called
+    
+    // Stream mode keeps the newest samples if the loop stalls
+    _imu->fifo_config(qmi8658_fifo_stream, qmi8658_fifo_size_64, watermark);
+    _fifoEnabled = true;
+    resyncSensorTime(millis());
+    return true;
+}
+
+void MotionDetector::disableFifo() {
+    _imu->fifo_config(qmi8658_fifo_bypass, qmi8658_fifo_size_16, 0);
+    _fifoEnabled = false;
+    resyncSensorTime(millis());
 }
 
 bool MotionDetector::detectMotion() {
-    if (!_isCalibrated) return false;
+    // The filtered path needs no baseline and tracking learns one: calibration is optional there
+    if ((!_isCalibrated && !_filterEnabled && !_baselineTracking) || _womArmed) return _isMoving;
     
-    // Read current IMU data
-    _imu->read(&_data);
+    lockImu();
+    unsigned long now = millis();
+    _batchHadMotion = false;
     
-    // Calculate deviations
-    float accTotalDev = calculateAccDeviation();
-    float gyroTotalDev = calculateGyroDeviation();
+    if (_fifoEnabled) {
+        // Drain everything queued since the last call
+        uint16_t count = _imu->fifo_read(_fifoSamples, MOTION_FIFO_MAX_SAMPLES);
+        if (_imu->fifo_overflowed()) _fifoOverflows++;
+        
+        for (uint16_t i = 0; i < count; i++) {
+            _data = _fifoSamples[i];
+            _trace.push(_data, _highRate);
+            if (advanceSensorTime(_data.timestamp)) {
+                processSample(_sensorMs);
+            }
+        }
+    } else {
+        // Read current IMU data (skipped if it is the sample already seen)
+        if (_imu->read_raw(&_data)) {
+            _trace.push(_data, _highRate);
+            if (advanceSensorTime(_data.timestamp)) {
+                processSample(_sensorMs);
+            }
+        }
+    }
     
-    // Track maximum deviations for tuning
-    if (accTotalDev > _maxAccDeviation) _maxAccDeviation = accTotalDev;
-    if (gyroTotalDev > _maxGyroDeviation) _maxGyroDeviation = gyroTotalDev;
+    if (_batchHadMotion) {
+        _lastMotionWallMs = now;
+    }
     
-    // Check if motion exceeds threshold
-    bool currentMotion = (accTotalDev > _accMotionThreshold) || (gyroTotalDev > _gyroMotionThreshold);
+    // Reconfigure only between batches so the sensor time base stays consistent
+    if (_adaptiveOdr) {
+        applyOdrPolicy(now);
+    }
     
-    unsigned long now = millis();
+    unlockImu();
     
-    if (currentMotion) {
-        _lastMotionTime = now;
+    return _isMoving;
+}
+
+bool MotionDetector::startSamplingTask(int intPin, uint8_t imuIntLine) {
+    if (_samplingTask || intPin < 0) return false;
+    
+    _imuMutex = xSemaphoreCreateMutex();
+    if (!_imuMutex) return false;
+    
+    // Same core as loop() so Wire is never driven from two cores at once
+    if (xTaskCreatePinnedToCore(samplingTaskEntry, "imu_sampling", MOTION_TASK_STACK_SIZE,
+                                this, MOTION_TASK_PRIORITY, &_samplingTask,
+                                ARDUINO_RUNNING_CORE) != pdPASS) {
+        _samplingTask = nullptr;
+        return false;
+    }
+    
+    pinMode(intPin, INPUT);
+    attachInterruptArg(digitalPinToInterrupt(intPin), dataReadyISR, this, RISING);
+    _intPin = intPin;
+    _imuIntLine = imuIntLine;
+    _imu->int_enable(imuIntLine);
+    return true;
+}
+
+void MotionDetector::pauseSamplingTask() {
+    if (!_samplingTask || _samplingPaused) return;
+    
+    detachInterrupt(digitalPinToInterrupt(_intPin));
+    
+    // Under the lock the task is not mid-read; it parks at its next wait
+    lockImu();
+    _samplingPaused = true;
+    unlockImu();
+}
+
+void MotionDetector::resumeSamplingTask() {
+    if (!_samplingTask || !_samplingPaused) return;
+    
+    _samplingPaused = false;
+    attachInterruptArg(digitalPinToInterrupt(_intPin), dataReadyISR, this, RISING);
+    xTaskNotifyGive(_samplingTask);
+}
+
+bool MotionDetector::armWakeOnMotion(uint8_t thresholdMg) {
+    lockImu();
+    _womArmed = _imu->wom_enable(thresholdMg, _imuIntLine, MOTION_WOM_BLANKING_SAMPLES, MOTION_WOM_ODR);
+    unlockImu();
+    return _womArmed;
+}
+
+void MotionDetector::disarmWakeOnMotion() {
+    if (!_womArmed) return;
+    
+    lockImu();
+    _imu->wom_disable();
+    _imu->int_enable(_imuIntLine);
+    if (_fifoEnabled) {
+        _imu->fifo_reset();
+    }
+    resyncSensorTime(millis());
+    _womArmed = false;
+    unlockImu();
+}
+
+void IRAM_ATTR MotionDetector::notifyDataReady() {
+    _interruptCount++;
+    _lastInterruptUs = micros();
+    if (_samplingTask) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(_samplingTask, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+void IRAM_ATTR MotionDetector::dataReadyISR(void* arg) {
+    static_cast<MotionDetector*>(arg)->notifyDataReady();
+}
+
+void MotionDetector::samplingTaskEntry(void* arg) {
+    MotionDetector* self = static_cast<MotionDetector*>(arg);
+    
+    for (;;) {
+        // Paused: no fallback polls either until resumeSamplingTask() notifies
+        if (self->_samplingPaused) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
         
-        // Start a new motion detection window if needed
-        if (_motionWindowStart == 0) {
-            _motionWindowStart = now;
-            _motionPulseCounter = 1;
+        // Sleep until the IMU signals new data; poll anyway if the line stays quiet
+        uint32_t notified = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MOTION_TASK_FALLBACK_MS));
+        if (self->_samplingPaused) continue;
+        if (notified > 0) {
+            self->_lastWakeLatencyUs = micros() - self->_lastInterruptUs;
         } else {
-            // Check if we're still within the detection window
-            if (now - _motionWindowStart <= _motionWindowMs) {
-                // Count this pulse (but avoid counting continuously - needs gap)
-                if (now - _lastPulseTime > 50) { // At least 50ms between pulses
-                    _motionPulseCounter++;
-                    _lastPulseTime = now;
-                }
-            } else {
-                // Window expired, restart
-                _motionWindowStart = now;
-                _motionPulseCounter = 1;
-            }
+            self->_fallbackPollCount++;
         }
-        
-        // If we've detected enough motion pulses, declare moving
-        if (_motionPulseCounter >= _motionPulseCount) {
-            _isMoving = true;
+        self->detectMotion();
+    }
+}
+
+void MotionDetector::lockImu() {
+    if (_imuMutex) xSemaphoreTake(_imuMutex, portMAX_DELAY);
+}
+
+void MotionDetector::unlockImu() {
+    if (_imuMutex) xSemaphoreGive(_imuMutex);
+}
+
+void MotionDetector::processSample(unsigned long now) {
+    // Never step back in time across batches
+    if ((long)(now - _lastSampleTime) < 0) now = _lastSampleTime;
+    _lastSampleTime = now;
+    _samplesProcessed++;
+    
+    // Calculate squared deviations in sensor counts (integer only, no sqrt).
+    // The gyroscope is ignored while it is off or still starting up.
+    bool gyroValid = _highRate && (long)(now - _gyroValidFrom) >= 0;
+    
+    // Gyro baseline follows the die temperature: re-interpolated on a 1/4 degree change,
+    // a newly trusted bin or the refresh schedule, not on every sample
+    if (_gyroBiasEnabled && (_gyroBiasStale ||
+                             abs(_data.temperature - _gyroBiasTemp) >= MOTION_GYRO_BIAS_REFRESH_DELTA ||
+                             now - _gyroBiasRefreshMs >= MOTION_GYRO_BIAS_REFRESH_MS)) {
+        refreshGyroBias(now);
+    }
+    if (_filterEnabled) {
+        _accFilter.process(_data.acc, _accSignal);
+        if (gyroValid) {
+            _gyroFilter.process(_data.gyro, _gyroSignal);
+        } else {
+            _gyroFilter.reset();
         }
     } else {
-        // No motion detected right now
-        // Check if motion window has expired without enough pulses
-        if (!_isMoving && _motionWindowStart != 0 && (now - _motionWindowStart > _motionWindowMs)) {
-            // Reset if we didn't get enough pulses
-            _motionWindowStart = 0;
-            _motionPulseCounter = 0;
+        memcpy(_accSignal, _data.acc, sizeof(_accSignal));
+        memcpy(_gyroSignal, _data.gyro, sizeof(_gyroSignal));
+    }
+    
+    uint64_t accDevSq = calculateAccDeviationSq();
+    uint64_t gyroDevSq = gyroValid ? calculateGyroDeviationSq() : 0;
+    
+    // Track maximum deviations for tuning
+    if (accDevSq > _maxAccDeviationSq) _maxAccDeviationSq = accDevSq;
+    if (gyroDevSq > _maxGyroDeviationSq) _maxGyroDeviationSq = gyroDevSq;
+    
+    // Check if motion exceeds threshold (both sides squared)
+    bool currentMotion = (accDevSq > _accThresholdSq) || (gyroDevSq > _gyroThresholdSq);
+    
+    // Windows are kept up to date in every mode (O(1) per sample)
+    _accWindow.push(_accSignal, accDevSq);
+    if (gyroValid) {
+        _gyroWindow.push(_gyroSignal, gyroDevSq);
+    } else {
+        _gyroWindow.reset();
+    }
+    
+    // Spectral features need the raw signal (the low-pass removes the blade band)
+    // and the full rate; in the idle rate the blade band is above Nyquist anyway
+    if (_highRate && _spectrum.push(_data.acc)) {
+        updateSpectrum();
+    }
+    
+    // Orientation uses the raw samples (the high-pass would remove gravity), minus the gyro bias
+    int16_t gyroRate[3];
+    for (int axis = 0; axis < 3; axis++) {
+        gyroRate[axis] = _isCalibrated ? _data.gyro[axis] - _gyroBaseline[axis] : _data.gyro[axis];
+    }
+    _orientation.update(_data.acc, gyroRate, gyroValid, isStationary(gyroValid), now);
+    
+    if (_baselineTracking) {
+        updateBaseline(now, gyroValid);
+    }
+    
+    // Without filtering, nothing can be decided until a baseline exists
+    if (!_isCalibrated && !_filterEnabled) {
+        return;
+    }
+    
+    updateTuning(accDevSq, gyroDevSq, gyroValid);
+    
+    // Noise floor from the spread inside the window while not moving
+    if (_axisWeighting && !_isMoving) {
+        learnNoise(_accWindow, _accNoiseQ, _accNoiseSamples, _accAxisWeight);
+        if (gyroValid) {
+            learnNoise(_gyroWindow, _gyroNoiseQ, _gyroNoiseSamples, _gyroAxisWeight);
         }
+    }
+    
+    // Even when a windowed strategy ignores single spikes, a spike still
+    // wakes the adaptive ODR immediately
+    if (currentMotion) {
+        _batchHadMotion = true;
+    }
+    
+    MotionFeatures features;
+    features.now = now;
+    features.sampleAbove = currentMotion;
+    features.accWindow = &_accWindow;
+    features.gyroWindow = &_gyroWindow;
+    features.accThresholdSq = _accThresholdSq;
+    features.gyroThresholdSq = _gyroThresholdSq;
+    features.spectrumValid = _highRate && _spectrumValid;
+    features.locomotionAbove = _locomotionPower > _locomotionPowerThreshold;
+    features.bladeRunning = _bladeRunning;
+    features.pulseWindowMs = _motionWindowMs;
+    features.pulseCount = _motionPulseCount;
+    features.stopDelayMs = _motionStopDelayMs;
+    runStrategies(features);
+}
+
+void MotionDetector::runStrategies(const MotionFeatures& features) {
+    if (!_shadow) {
+        _isMoving = _strategy->update(features);
+        return;
+    }
+    
+    uint32_t start = ESP.getCycleCount();
+    _isMoving = _strategy->update(features);
+    uint32_t middle = ESP.getCycleCount();
+    bool shadowMoving = _shadow->update(features);
+    uint32_t end = ESP.getCycleCount();
+    
+    recordCost(_primaryCost, middle - start);
+    recordCost(_shadowCost, end - middle);
+    _shadowSamples++;
+    
+    bool disagree = (shadowMoving != _isMoving);
+    if (disagree) {
+        _shadowDisagreeSamples++;
+    }
+    if (disagree == _shadowDisagree) return;
+    _shadowDisagree = disagree;
+    
+    // Episode boundaries only: the per-sample path stays quiet
+    if (disagree) {
+        uint8_t slot = _shadowLogHead;
+        _shadowLogHead = (_shadowLogHead + 1) % MOTION_SHADOW_LOG_SIZE;
+        if (_shadowLogCount < MOTION_SHADOW_LOG_SIZE) _shadowLogCount++;
+        _shadowLog[slot].startMs = features.now;
+        _shadowLog[slot].durationMs = 0;
+        _shadowLog[slot].primaryMoving = _isMoving;
+        _shadowEpisodes++;
         
-        // If already moving, wait for stop delay
-        if (_isMoving && (now - _lastMotionTime > _motionStopDelayMs)) {
-            _isMoving = false;
-            _motionWindowStart = 0;
-            _motionPulseCounter = 0;
+        Serial.print("[IMU] Shadow disagrees: ");
+        Serial.print(_strategy->name());
+        Serial.print(_isMoving ? " moving, " : " still, ");
+        Serial.print(_shadow->name());
+        Serial.println(shadowMoving ? " moving" : " still");
+    } else {
+        uint8_t slot = (_shadowLogHead + MOTION_SHADOW_LOG_SIZE - 1) % MOTION_SHADOW_LOG_SIZE;
+        uint32_t duration = features.now - _shadowLog[slot].startMs;
+        _shadowLog[slot].durationMs = duration ? duration : 1;
+        
+        Serial.print("[IMU] Shadow agrees again after ");
+        Serial.print(duration);
+        Serial.println(" ms");
+    }
+}
+
+void MotionDetector::recordCost(StrategyCost& cost, uint32_t cycles) {
+    cost.cycles += cycles;
+    if (cycles > cost.maxCycles) cost.maxCycles = cycles;
+}
+
+void MotionDetector::enableAdaptiveOdr(unsigned long quietMs) {
+    lockImu();
+    unsigned long now = millis();
+    _odrQuietMs = quietMs;
+    _adaptiveSince = now;
+    _odrModeSince = now;
+    _highRateMs = 0;
+    _adaptiveOdr = true;
+    unlockImu();
+}
+
+void MotionDetector::disableAdaptiveOdr() {
+    lockImu();
+    if (!_highRate) {
+        setHighRate(true, millis());
+    }
+    _adaptiveOdr = false;
+    unlockImu();
+}
+
+float MotionDetector::getHighRateDutyCycle() const {
+    return highRateDutyCycle(millis());
+}
+
+float MotionDetector::highRateDutyCycle(unsigned long now) const {
+    if (!_adaptiveOdr) return 1.0f;
+    
+    unsigned long total = now - _adaptiveSince;
+    unsigned long high = _highRateMs + (_highRate ? now - _odrModeSince : 0);
+    return total ? (float)high / total : (_highRate ? 1.0f : 0.0f);
+}
+
+void MotionDetector::applyOdrPolicy(unsigned long now) {
+    if (!_highRate) {
+        // Full rate from the first above-threshold sample
+        if (_batchHadMotion) {
+            setHighRate(true, now);
+        }
+    } else if (!_isMoving) {
+        // Quiet period measured from the last motion sample or the last switch
+        unsigned long quietSince = ((long)(_lastMotionWallMs - _odrModeSince) > 0) ? _lastMotionWallMs : _odrModeSince;
+        if (now - quietSince > _odrQuietMs) {
+            setHighRate(false, now);
         }
     }
+}
+
+bool MotionDetector::setHighRate(bool high, unsigned long now) {
+    qmi8658_cfg_t cfg = _activeCfg;
+    
+    if (!high) {
+        cfg.qmi8658_mode = qmi8658_mode_acc_only;
+        cfg.acc_odr = MOTION_IDLE_ODR;
+    }
+    
+    if (!_imu->set_config(&cfg)) {
+        return false;
+    }
+    
+    applyRate(high, now);
+    return true;
+}
+
+void MotionDetector::applyRate(bool high, unsigned long now) {
+    acc_odr_t odr = high ? _activeCfg.acc_odr : MOTION_IDLE_ODR;
+    
+    if (_highRate) {
+        _highRateMs += now - _odrModeSince;
+    }
+    _odrModeSince = now;
+    _highRate = high;
+    if (!high) {
+        // No spectrum at the idle rate: the blade band is above Nyquist
+        _bladeRunning = false;
+        _bladeBlocks = 0;
+    }
+    resyncSensorTime(now);
+    _gyroValidFrom = _sensorMs + MOTION_GYRO_SETTLE_MS;
+    _samplePeriodUs = Qmi8658c::acc_odr_period_us(odr);
+    _odrSwitches++;
+    updateScaledThresholds();
+    updateWindowLength();
+    configureFilters(odr);
+    configureSpectrum();
+    _orientation.configure(_samplePeriodUs, _imu->acc_sensitivity(), _imu->gyro_sensitivity());
+    
+    Serial.print("[IMU] ");
+    Serial.print(high ? "High rate (accel+gyro)" : "Idle rate (accel only)");
+    Serial.print(", duty cycle ");
+    Serial.println(highRateDutyCycle(now), 3);
+}
+
+void MotionDetector::startTrace() {
+    ImuTraceHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = IMU_TRACE_MAGIC;
+    header.version = IMU_TRACE_VERSION;
+    header.recordSize = sizeof(ImuTraceRecord);
     
+    lockImu();
+    header.highOdr = _activeCfg.acc_odr;
+    header.idleOdr = MOTION_IDLE_ODR;
+    header.accScale = _activeCfg.acc_scale;
+    header.gyroScale = _activeCfg.gyro_scale;
+    header.accSensitivity = _imu->acc_sensitivity();
+    header.gyroSensitivity = _imu->gyro_sensitivity();
+    header.highPeriodUs = Qmi8658c::acc_odr_period_us(_activeCfg.acc_odr);
+    header.idlePeriodUs = Qmi8658c::acc_odr_period_us(MOTION_IDLE_ODR);
+    header.startMs = millis();
+    _trace.start(header);
+    unlockImu();
+}
+
+void MotionDetector::stopTrace() {
+    lockImu();
+    _trace.stop();
+    unlockImu();
+}
+
+uint16_t MotionDetector::readTrace(ImuTraceRecord* out, uint16_t max) {
+    lockImu();
+    uint16_t n = _trace.read(out, max);
+    unlockImu();
+    return n;
+}
+
+bool MotionDetector::feedRecord(const ImuTraceRecord& record) {
+    lockImu();
+    
+    // Trace time, not the wall clock: the record's sample counter on the current
+    // time base (a restarted counter after a resync continues from the last sample)
+    unsigned long now = _sensorMs;
+    uint32_t delta = record.timestamp - _lastStamp;
+    if (_stampValid && delta < 0x80000000UL) {
+        now += (unsigned long)(((uint64_t)delta * _samplePeriodUs + _sensorUsRem) / 1000);
+    }
+    
+    bool high = (record.flags & IMU_TRACE_FLAG_HIGH_RATE) != 0;
+    if (high != _highRate) {
+        applyRate(high, now);  // Resyncs as well
+    } else if (record.flags & IMU_TRACE_FLAG_RESYNC) {
+        resyncSensorTime(now);
+    }
+    
+    ImuTraceRecorder::decode(record, &_data);
+    if (advanceSensorTime(_data.timestamp)) {
+        processSample(_sensorMs);
+    }
+    
+    unlockImu();
     return _isMoving;
 }
 
+bool MotionDetector::advanceSensorTime(uint32_t stamp) {
+    if (!_stampValid) {
+        _stampValid = true;
+        _lastStamp = stamp;
+        return true;
+    }
+    
+    // Same (or an older) sample read again
+    uint32_t delta = stamp - _lastStamp;
+    if (delta == 0 || delta > 0x80000000UL) {
+        _duplicateSamples++;
+        return false;
+    }
+    
+    // Samples produced by the IMU but never seen here
+    if (delta > 1) {
+        _droppedSamples += delta - 1;
+    }
+    
+    _lastStamp = stamp;
+    _sensorUsRem += delta * _samplePeriodUs;
+    _sensorMs += _sensorUsRem / 1000;
+    _sensorUsRem %= 1000;
+    return true;
+}
+
+void MotionDetector::resyncSensorTime(unsigned long now) {
+    // Reconfiguration or sleep may restart the IMU counter: re-anchor on the next
+    // sample, and never let sensor time fall behind the wall clock across the gap
+    _stampValid = false;
+    _trace.markResync();
+    _accFilter.reset();
+    _gyroFilter.reset();
+    _spectrum.reset();
+    _orientation.reset();
+    if ((long)(now - _sensorMs) > 0) {
+        _sensorMs = now;
+        _sensorUsRem = 0;
+    }
+    _quietStart = _sensorMs;
+}
+
 void MotionDetector::resetStatistics() {
-    _maxAccDeviation = 0;
-    _maxGyroDeviation = 0;
+    _maxAccDeviationSq = 0;
+    _maxGyroDeviationSq = 0;
+}
+
+bool MotionDetector::isStationary(bool gyroValid) const {
+    // Confidently stationary: low spread within the window, independent of the
+    // current baseline (so a wrong baseline cannot keep it from converging)
+    bool quiet = _accWindow.isReady() && !_accWindow.varianceAbove(_accThresholdSq >> MOTION_BASELINE_QUIET_SHIFT);
+    if (gyroValid) {
+        quiet = quiet && _gyroWindow.isReady() && !_gyroWindow.varianceAbove(_gyroThresholdSq >> MOTION_BASELINE_QUIET_SHIFT);
+    }
+    return quiet;
 }
 
-float MotionDetector::calculateAccDeviation() const {
-    float devX = abs(_data.acc_xyz.x - _accBaselineX);
-    float devY = abs(_data.acc_xyz.y - _accBaselineY);
-    float devZ = abs(_data.acc_xyz.z - _accBaselineZ);
+void MotionDetector::updateBaseline(unsigned long now, bool gyroValid) {
+    if (!isStationary(gyroValid)) {
+        _quietStart = now;
+        return;
+    }
+    
+    // First quiet sample without any baseline: start from it
+    if (!_isCalibrated) {
+        setBaseline(_data.acc, _data.gyro);
+        _isCalibrated = true;
+        _baselineFastRemaining = MOTION_BASELINE_FAST_SAMPLES;
+        return;
+    }
+    
+    bool fast = _baselineFastRemaining > 0;
+    if (!fast && now - _quietStart < MOTION_BASELINE_QUIET_MS) {
+        return;
+    }
     
-    return sqrt(devX*devX + devY*devY + devZ*devZ);
+    uint8_t shift = fast ? MOTION_BASELINE_FAST_SHIFT : MOTION_BASELINE_EMA_SHIFT;
+    for (int axis = 0; axis < 3; axis++) {
+        _accBaselineQ[axis] += (((int32_t)_data.acc[axis] << 8) - _accBaselineQ[axis]) >> shift;
+        _accBaseline[axis] = (int16_t)((_accBaselineQ[axis] + 128) >> 8);
+        if (gyroValid && !_gyroBiasEnabled) {
+            _gyroBaselineQ[axis] += (((int32_t)_data.gyro[axis] << 8) - _gyroBaselineQ[axis]) >> shift;
+            _gyroBaseline[axis] = (int16_t)((_gyroBaselineQ[axis] + 128) >> 8);
+        }
+    }
+    if (gyroValid && _gyroBiasEnabled && _gyroBias.learn(_data.temperature, _data.gyro)) {
+        _gyroBiasStale = true;
+    }
+    _baselineUpdates++;
+    
+    if (fast) {
+        if (--_baselineFastRemaining == 0) {
+            _baselineSavePending = true;
+        }
+        return;
+    }
+    
+    // Persist drift rarely (flash wear)
+    if (now - _lastBaselineSaveMs > MOTION_BASELINE_SAVE_MS) {
+        if (_gyroBiasEnabled && _gyroBias.isDirty()) {
+            _baselineSavePending = true;
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            if (abs(_accBaseline[axis] - _savedAccBaseline[axis]) > MOTION_BASELINE_SAVE_MIN_DELTA) {
+                _baselineSavePending = true;
+                break;
+            }
+        }
+    }
+}
+
+void MotionDetector::setBaseline(const int16_t* acc, const int16_t* gyro) {
+    for (int axis = 0; axis < 3; axis++) {
+        _accBaseline[axis] = acc[axis];
+        _gyroBaseline[axis] = gyro[axis];
+        _accBaselineQ[axis] = (int32_t)acc[axis] << 8;
+        _gyroBaselineQ[axis] = (int32_t)gyro[axis] << 8;
+    }
+}
+
+// Persisted baseline, only valid for the scales it was measured at
+struct BaselineRecord {
+    int16_t acc[3];
+    int16_t gyro[3];
+    uint16_t accSensitivity;
+    uint16_t gyroSensitivity;
+};
+
+bool MotionDetector::loadBaseline() {
+    Preferences prefs;
+    BaselineRecord record;
+    
+    if (!prefs.begin(MOTION_PREFS_NAMESPACE, true)) {
+        return false;
+    }
+    size_t len = prefs.getBytes(MOTION_PREFS_BASELINE_KEY, &record, sizeof(record));
+    prefs.end();
+    
+    if (len != sizeof(record) ||
+        record.accSensitivity != _imu->acc_sensitivity() ||
+        record.gyroSensitivity != _imu->gyro_sensitivity()) {
+        return false;
+    }
+    
+    setBaseline(record.acc, record.gyro);
+    memcpy(_savedAccBaseline, record.acc, sizeof(_savedAccBaseline));
+    return true;
+}
+
+void MotionDetector::saveBaselineIfPending() {
+    if (_baselineSavePending) {
+        saveBaseline();
+    }
+}
+
+void MotionDetector::saveBaseline() {
+    BaselineRecord record;
+    
+    lockImu();
+    memcpy(record.acc, _accBaseline, sizeof(record.acc));
+    memcpy(record.gyro, _gyroBaseline, sizeof(record.gyro));
+    record.accSensitivity = _imu->acc_sensitivity();
+    record.gyroSensitivity = _imu->gyro_sensitivity();
+    _baselineSavePending = false;
+    unlockImu();
+    
+    Preferences prefs;
+    if (!prefs.begin(MOTION_PREFS_NAMESPACE, false)) {
+        return;
+    }
+    prefs.putBytes(MOTION_PREFS_BASELINE_KEY, &record, sizeof(record));
+    prefs.end();
+    
+    memcpy(_savedAccBaseline, record.acc, sizeof(_savedAccBaseline));
+    _lastBaselineSaveMs = _sensorMs;
+    
+    if (_gyroBiasEnabled && _gyroBias.isDirty()) {
+        saveGyroBias();
+    }
+}
+
+void MotionDetector::setGyroBiasCompensation(bool enabled) {
+    lockImu();
+    _gyroBiasEnabled = enabled;
+    _gyroBiasStale = true;
+    unlockImu();
+}
+
+void MotionDetector::refreshGyroBias(unsigned long now) {
+    int16_t bias[3];
+    
+    _gyroBiasTemp = _data.temperature;
+    _gyroBiasRefreshMs = now;
+    _gyroBiasStale = false;
+    
+    // Until a bin is trusted the plain baseline (calibration or EMA) stays in use
+    if (!_gyroBias.bias(_gyroBiasTemp, bias)) return;
+    
+    for (int axis = 0; axis < 3; axis++) {
+        _gyroBaseline[axis] = bias[axis];
+        _gyroBaselineQ[axis] = (int32_t)bias[axis] << 8;
+    }
+}
+
+// Persisted bias table, only valid for the gyro scale it was learned at
+struct GyroBiasRecord {
+    uint16_t gyroSensitivity;
+    uint16_t bins;
+    GyroBiasModel::Bin table[GYRO_BIAS_BINS];
+};
+
+void MotionDetector::loadGyroBias() {
+    Preferences prefs;
+    GyroBiasRecord record;
+    
+    if (!prefs.begin(MOTION_PREFS_NAMESPACE, true)) {
+        return;
+    }
+    size_t len = prefs.getBytes(MOTION_PREFS_GYRO_BIAS_KEY, &record, sizeof(record));
+    prefs.end();
+    
+    if (len != sizeof(record) || record.bins != GYRO_BIAS_BINS ||
+        record.gyroSensitivity != _imu->gyro_sensitivity()) {
+        return;
+    }
+    
+    _gyroBias.setBins(record.table);
+    _gyroBiasStale = true;
+}
+
+void MotionDetector::saveGyroBias() {
+    GyroBiasRecord record;
+    
+    lockImu();
+    record.gyroSensitivity = _imu->gyro_sensitivity();
+    record.bins = GYRO_BIAS_BINS;
+    memcpy(record.table, _gyroBias.getBins(), sizeof(record.table));
+    _gyroBias.clearDirty();
+    unlockImu();
+    
+    Preferences prefs;
+    if (!prefs.begin(MOTION_PREFS_NAMESPACE, false)) {
+        return;
+    }
+    prefs.putBytes(MOTION_PREFS_GYRO_BIAS_KEY, &record, sizeof(record));
+    prefs.end();
+}
+
+void MotionDetector::configureSpectrum() {
+    _spectrum.configure(_samplePeriodUs, MOTION_SPECTRUM_BLOCK, SPECTRUM_BINS_HZ, MOTION_SPECTRUM_BIN_COUNT);
+    
+    // A sinusoid of amplitude A gives |X|^2 = (A * N / 2)^2 in its bin
+    float amplitude = MOTION_BLADE_MIN_G * _imu->acc_sensitivity() * MOTION_SPECTRUM_BLOCK / 2;
+    _bladePowerThreshold = (uint64_t)(amplitude * amplitude);
+    amplitude = MOTION_LOCOMOTION_MIN_G * _imu->acc_sensitivity() * MOTION_SPECTRUM_BLOCK / 2;
+    _locomotionPowerThreshold = (uint64_t)(amplitude * amplitude);
+    
+    // The bank restarts: the last block belongs to the old rate
+    _spectrumValid = false;
+}
+
+void MotionDetector::updateSpectrum() {
+    uint64_t locomotion = 0, blade = 0;
+    
+    for (uint8_t i = 0; i < MOTION_SPECTRUM_BIN_COUNT; i++) {
+        if (i < MOTION_LOCOMOTION_BINS) {
+            locomotion += _spectrum.getPower(i);
+        } else {
+            blade += _spectrum.getPower(i);
+        }
+    }
+    _locomotionPower = locomotion;
+    _bladePower = blade;
+    _spectrumValid = true;
+    
+    // Hysteresis in blocks: a bump or a short carry does not count as mowing
+    if (blade > _bladePowerThreshold) {
+        if (_bladeBlocks < MOTION_BLADE_OFF_BLOCKS) _bladeBlocks++;
+        if (_bladeBlocks >= MOTION_BLADE_ON_BLOCKS) _bladeRunning = true;
+    } else {
+        if (_bladeBlocks > 0) _bladeBlocks--;
+        if (_bladeBlocks == 0) _bladeRunning = false;
+    }
+}
+
+float MotionDetector::bandLevel(uint64_t power) const {
+    uint16_t sensitivity = _imu->acc_sensitivity();
+    return sensitivity ? 2.0f * sqrtf((float)power) / MOTION_SPECTRUM_BLOCK / sensitivity : 0;
+}
+
+void MotionDetector::setFilterEnabled(bool enabled) {
+    lockImu();
+    _filterEnabled = enabled;
+    _accFilter.reset();
+    _gyroFilter.reset();
+    _accWindow.reset();
+    _gyroWindow.reset();
+    unlockImu();
+}
+
+void MotionDetector::configureFilters(acc_odr_t odr) {
+    // Picks the constexpr coefficient row; the next sample re-primes the state
+    _accFilter.configure(odr);
+    _gyroFilter.configure(odr);
+}
+
+uint64_t MotionDetector::calculateAccDeviationSq() const {
+    return deviationSq(_accSignal, _filterEnabled ? ZERO_XYZ : _accBaseline, _accAxisWeight);
+}
+
+uint64_t MotionDetector::calculateGyroDeviationSq() const {
+    return deviationSq(_gyroSignal, _filterEnabled ? ZERO_XYZ : _gyroBaseline, _gyroAxisWeight);
+}
+
+void MotionDetector::setDetectionMode(DetectionMode mode) {
+    lockImu();
+    _detectionMode = mode;
+    _strategy = strategyFor(mode);
+    _strategy->reset(_isMoving, _lastSampleTime);
+    if (_shadow == _strategy) {
+        // Comparing a strategy with itself is meaningless
+        _shadow = nullptr;
+    }
+    unlockImu();
+}
+
+MotionStrategy* MotionDetector::strategyFor(DetectionMode mode) {
+    switch (mode) {
+        case DetectionMode::WINDOW_RMS:      return &_rmsStrategy;
+        case DetectionMode::WINDOW_VARIANCE: return &_varianceStrategy;
+        case DetectionMode::SPECTRAL:        return &_spectralStrategy;
+        case DetectionMode::HYBRID:          return &_hybridStrategy;
+        default:                             return &_pulseStrategy;
+    }
+}
+
+const char* MotionDetector::modeName(DetectionMode mode) {
+    switch (mode) {
+        case DetectionMode::WINDOW_RMS:      return "rms";
+        case DetectionMode::WINDOW_VARIANCE: return "variance";
+        case DetectionMode::SPECTRAL:        return "spectral";
+        case DetectionMode::HYBRID:          return "hybrid";
+        default:                             return "pulse";
+    }
+}
+
+void MotionDetector::setShadowMode(DetectionMode mode) {
+    lockImu();
+    MotionStrategy* shadow = strategyFor(mode);
+    if (shadow == _strategy) {
+        _shadow = nullptr;
+    } else {
+        // Start from the primary decision so only real disagreements count
+        shadow->reset(_isMoving, _lastSampleTime);
+        _shadow = shadow;
+        _shadowMode = mode;
+    }
+    resetShadowStats();
+    unlockImu();
+}
+
+void MotionDetector::disableShadow() {
+    lockImu();
+    _shadow = nullptr;
+    unlockImu();
+}
+
+void MotionDetector::resetShadowStats() {
+    memset(&_primaryCost, 0, sizeof(_primaryCost));
+    memset(&_shadowCost, 0, sizeof(_shadowCost));
+    _shadowSamples = 0;
+    _shadowDisagreeSamples = 0;
+    _shadowEpisodes = 0;
+    _shadowDisagree = false;
+    _shadowLogHead = 0;
+    _shadowLogCount = 0;
+}
+
+uint32_t MotionDetector::getStrategyCycles(bool shadow) const {
+    if (_shadowSamples == 0) return 0;
+    return (uint32_t)((shadow ? _shadowCost.cycles : _primaryCost.cycles) / _shadowSamples);
+}
+
+uint8_t MotionDetector::getShadowLog(ShadowEpisode* out, uint8_t max) {
+    lockImu();
+    uint8_t n = (max < _shadowLogCount) ? max : _shadowLogCount;
+    uint8_t first = (_shadowLogHead + MOTION_SHADOW_LOG_SIZE - _shadowLogCount) % MOTION_SHADOW_LOG_SIZE;
+    for (uint8_t i = 0; i < n; i++) {
+        out[i] = _shadowLog[(first + i) % MOTION_SHADOW_LOG_SIZE];
+    }
+    unlockImu();
+    return n;
+}
+
+void MotionDetector::setWindowMs(unsigned long ms) {
+    lockImu();
+    _windowMs = ms;
+    updateWindowLength();
+    unlockImu();
+}
+
+void MotionDetector::updateWindowLength() {
+    if (_samplePeriodUs == 0) return;  // begin() not called
+    
+    unsigned long samples = (_windowMs * 1000UL) / _samplePeriodUs;
+    if (samples > MOTION_WINDOW_MAX_SAMPLES) samples = MOTION_WINDOW_MAX_SAMPLES;
+    _accWindow.setLength(samples);
+    _gyroWindow.setLength(samples);
+}
+
+uint64_t MotionDetector::decisionMetricSq(const MotionWindow& window, uint64_t sampleDevSq) const {
+    switch (_detectionMode) {
+        case DetectionMode::PULSE:           return sampleDevSq;
+        case DetectionMode::WINDOW_RMS:      return window.getMeanDevSq();
+        default:                             return window.getVarianceSq();  // Also the spectral fallback and hybrid
+    }
+}
+
+void MotionDetector::updateTuning(uint64_t accDevSq, uint64_t gyroDevSq, bool gyroValid) {
+    // Windowed metrics are meaningless until the window has filled
+    if (_detectionMode != DetectionMode::PULSE && !_accWindow.isReady()) return;
+    
+    (_isMoving ? _accMovingHist : _accIdleHist).add(decisionMetricSq(_accWindow, accDevSq));
+    if (gyroValid && (_detectionMode == DetectionMode::PULSE || _gyroWindow.isReady())) {
+        (_isMoving ? _gyroMovingHist : _gyroIdleHist).add(decisionMetricSq(_gyroWindow, gyroDevSq));
+    }
+}
+
+void MotionDetector::startAutoTune() {
+    lockImu();
+    _accIdleHist.reset();
+    _accMovingHist.reset();
+    _gyroIdleHist.reset();
+    _gyroMovingHist.reset();
+    unlockImu();
+}
+
+float MotionDetector::getDeviationQuantile(bool gyro, bool moving, float q) const {
+    const DeviationHistogram& hist = gyro
+        ? (moving ? _gyroMovingHist : _gyroIdleHist)
+        : (moving ? _accMovingHist : _accIdleHist);
+    uint16_t sensitivity = gyro ? _imu->gyro_sensitivity() : _imu->acc_sensitivity();
+    return sensitivity ? hist.quantile(q) / sensitivity : 0;
+}
+
+float MotionDetector::proposeThreshold(const DeviationHistogram& idle, const DeviationHistogram& moving, uint16_t sensitivity) {
+    if (idle.getCount() < MOTION_TUNE_MIN_IDLE_SAMPLES || !sensitivity) return 0;
+    
+    float floor = idle.quantile(MOTION_TUNE_IDLE_QUANTILE);
+    float proposal = floor * MOTION_TUNE_MARGIN;
+    
+    if (moving.getCount() >= MOTION_TUNE_MIN_MOVING_SAMPLES) {
+        float active = moving.quantile(MOTION_TUNE_MOVING_QUANTILE);
+        if (active > proposal) {
+            proposal = sqrtf(floor * active);
+        }
+    }
+    
+    // Never below one count: quantisation noise alone would trigger it
+    if (proposal < 1.0f) proposal = 1.0f;
+    return proposal / sensitivity;
+}
+
+bool MotionDetector::getProposedThresholds(float& acc, float& gyro) const {
+    acc = proposeThreshold(_accIdleHist, _accMovingHist, _imu->acc_sensitivity());
+    gyro = proposeThreshold(_gyroIdleHist, _gyroMovingHist, _imu->gyro_sensitivity());
+    
+    // Without gyroscope data (idle rate only) keep the current gyro threshold
+    if (gyro == 0) gyro = _gyroMotionThreshold;
+    return acc > 0;
+}
+
+bool MotionDetector::applyProposedThresholds() {
+    float acc, gyro;
+    if (!getProposedThresholds(acc, gyro)) return false;
+    
+    lockImu();
+    setAccThreshold(acc);
+    setGyroThreshold(gyro);
+    unlockImu();
+    
+    Serial.print("[IMU] Auto-tuned thresholds: acc ");
+    Serial.print(acc, 4);
+    Serial.print(" g, gyro ");
+    Serial.print(gyro, 2);
+    Serial.println(" dps");
+    return true;
+}
+
+void MotionDetector::setAxisWeighting(bool enabled) {
+    lockImu();
+    _axisWeighting = enabled;
+    memset(_accNoiseQ, 0, sizeof(_accNoiseQ));
+    memset(_gyroNoiseQ, 0, sizeof(_gyroNoiseQ));
+    _accNoiseSamples = 0;
+    _gyroNoiseSamples = 0;
+    resetAxisWeights();
+    unlockImu();
 }
 
-float MotionDetector::calculateGyroDeviation() const {
-    float devX = abs(_data.gyro_xyz.x - _gyroBaselineX);
-    float devY = abs(_data.gyro_xyz.y - _gyroBaselineY);
-    float devZ = abs(_data.gyro_xyz.z - _gyroBaselineZ);
+void MotionDetector::resetAxisWeights() {
+    for (int axis = 0; axis < 3; axis++) {
+        _accAxisWeight[axis] = 1UL << MOTION_WINDOW_WEIGHT_SHIFT;
+        _gyroAxisWeight[axis] = 1UL << MOTION_WINDOW_WEIGHT_SHIFT;
+    }
+    _accWindow.setAxisWeights(_accAxisWeight);
+    _gyroWindow.setAxisWeights(_gyroAxisWeight);
+}
+
+void MotionDetector::learnNoise(const MotionWindow& window, uint64_t* noiseQ, uint32_t& samples, uint32_t* weights) {
+    if (!window.isReady()) return;
+    
+    for (int axis = 0; axis < 3; axis++) {
+        uint64_t variance = window.getAxisVarianceSq(axis) << 8;
+        if (samples == 0) {
+            noiseQ[axis] = variance;
+        } else if (variance > noiseQ[axis]) {
+            noiseQ[axis] += (variance - noiseQ[axis]) >> MOTION_NOISE_EMA_SHIFT;
+        } else {
+            noiseQ[axis] -= (noiseQ[axis] - variance) >> MOTION_NOISE_EMA_SHIFT;
+        }
+    }
+    samples++;
     
-    return sqrt(devX*devX + devY*devY + devZ*devZ);
+    // Weights change rarely so the per-sample cost stays three multiplies
+    if (samples >= MOTION_NOISE_MIN_SAMPLES && samples % MOTION_NOISE_UPDATE_SAMPLES == 0) {
+        computeAxisWeights(noiseQ, weights);
+        _accWindow.setAxisWeights(_accAxisWeight);
+        _gyroWindow.setAxisWeights(_gyroAxisWeight);
+    }
+}
+
+void MotionDetector::computeAxisWeights(const uint64_t* noiseQ, uint32_t* weights) {
+    // At least one count^2 per axis: a perfectly quiet axis must not get an infinite weight
+    float noise[3];
+    float mean = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        noise[axis] = max((float)noiseQ[axis] / 256.0f, 1.0f);
+        mean += noise[axis] / 3;
+    }
+    
+    for (int axis = 0; axis < 3; axis++) {
+        float weight = constrain(mean / noise[axis], MOTION_AXIS_WEIGHT_MIN, MOTION_AXIS_WEIGHT_MAX);
+        weights[axis] = (uint32_t)(weight * (1UL << MOTION_WINDOW_WEIGHT_SHIFT) + 0.5f);
+    }
+}
+
+void MotionDetector::noiseFloor(const uint64_t* noiseQ, uint16_t sensitivity, float& x, float& y, float& z) {
+    if (!sensitivity) {
+        x = y = z = 0;
+        return;
+    }
+    x = sqrtf(noiseQ[0] / 256.0f) / sensitivity;
+    y = sqrtf(noiseQ[1] / 256.0f) / sensitivity;
+    z = sqrtf(noiseQ[2] / 256.0f) / sensitivity;
+}
+
+void MotionDetector::getAccNoiseFloor(float& x, float& y, float& z) const {
+    noiseFloor(_accNoiseQ, _imu->acc_sensitivity(), x, y, z);
+}
+
+void MotionDetector::getGyroNoiseFloor(float& x, float& y, float& z) const {
+    noiseFloor(_gyroNoiseQ, _imu->gyro_sensitivity(), x, y, z);
+}
+
+void MotionDetector::setAccThreshold(float threshold) {
+    _accMotionThreshold = threshold;
+    updateScaledThresholds();
+}
+
+void MotionDetector::setGyroThreshold(float threshold) {
+    _gyroMotionThreshold = threshold;
+    updateScaledThresholds();
+}
+
+void MotionDetector::updateScaledThresholds() {
+    // Sensitivities are 0 until the IMU is opened; begin() calls this again
+    _accThresholdSq = scaleThresholdSq(_accMotionThreshold, _imu->acc_sensitivity());
+    _gyroThresholdSq = scaleThresholdSq(_gyroMotionThreshold, _imu->gyro_sensitivity());
+}
+
+uint32_t MotionDetector::scaleThresholdSq(float threshold, uint16_t sensitivity) {
+    // Largest per-axis deviation between two int16 readings
+    float counts = threshold * sensitivity;
+    if (counts < 0) counts = 0;
+    if (counts > 65535.0f) counts = 65535.0f;
+    
+    uint32_t c = (uint32_t)(counts + 0.5f);
+    return c * c;
+}
+
+uint64_t MotionDetector::deviationSq(const int16_t* sample, const int16_t* baseline, const uint32_t* weightsQ16) {
+    // |delta| <= 65535, so each square fits in 32 bits; weighted (Q16, <= 2^19) in 64
+    uint32_t dx = abs((int32_t)sample[0] - baseline[0]);
+    uint32_t dy = abs((int32_t)sample[1] - baseline[1]);
+    uint32_t dz = abs((int32_t)sample[2] - baseline[2]);
+    
+    return ((uint64_t)(dx*dx) * weightsQ16[0]
+          + (uint64_t)(dy*dy) * weightsQ16[1]
+          + (uint64_t)(dz*dz) * weightsQ16[2]) >> MOTION_WINDOW_WEIGHT_SHIFT;
+}
+
+// Conversions back to g / dps are only done for reporting
+
+float MotionDetector::getMaxAccDeviation() const {
+    uint16_t sensitivity = _imu->acc_sensitivity();
+    return sensitivity ? sqrtf((float)_maxAccDeviationSq) / sensitivity : 0;
+}
+
+float MotionDetector::getMaxGyroDeviation() const {
+    uint16_t sensitivity = _imu->gyro_sensitivity();
+    return sensitivity ? sqrtf((float)_maxGyroDeviationSq) / sensitivity : 0;
 }
 
 float MotionDetector::getCurrentAccDeviation() const {
-    if (!_isCalibrated) return 0;
-    return calculateAccDeviation();
+    uint16_t sensitivity = _imu->acc_sensitivity();
+    if (!_isCalibrated || !sensitivity) return 0;
+    return sqrtf((float)calculateAccDeviationSq()) / sensitivity;
 }
 
 float MotionDetector::getCurrentGyroDeviation() const {
-    if (!_isCalibrated) return 0;
-    return calculateGyroDeviation();
+    uint16_t sensitivity = _imu->gyro_sensitivity();
+    if (!_isCalibrated || !sensitivity) return 0;
+    return sqrtf((float)calculateGyroDeviationSq()) / sensitivity;
+}
+
+float MotionDetector::getWindowAccRms() const {
+    uint16_t sensitivity = _imu->acc_sensitivity();
+    return sensitivity ? _accWindow.getRms() / sensitivity : 0;
+}
+
+float MotionDetector::getWindowAccStdDev() const {
+    uint16_t sensitivity = _imu->acc_sensitivity();
+    return sensitivity ? _accWindow.getStdDev() / sensitivity : 0;
+}
+
+float MotionDetector::getWindowGyroRms() const {
+    uint16_t sensitivity = _imu->gyro_sensitivity();
+    return sensitivity ? _gyroWindow.getRms() / sensitivity : 0;
+}
+
+float MotionDetector::getWindowGyroStdDev() const {
+    uint16_t sensitivity = _imu->gyro_sensitivity();
+    return sensitivity ? _gyroWindow.getStdDev() / sensitivity : 0;
 }
 
 void MotionDetector::getAccBaseline(float& x, float& y, float& z) const {
-    x = _accBaselineX;
-    y = _accBaselineY;
-    z = _accBaselineZ;
+    float sensitivity = _imu->acc_sensitivity() ? _imu->acc_sensitivity() : 1;
+    x = _accBaseline[0] / sensitivity;
+    y = _accBaseline[1] / sensitivity;
+    z = _accBaseline[2] / sensitivity;
 }
 
 void MotionDetector::getGyroBaseline(float& x, float& y, float& z) const {
-    x = _gyroBaselineX;
-    y = _gyroBaselineY;
-    z = _gyroBaselineZ;
+    float sensitivity = _imu->gyro_sensitivity() ? _imu->gyro_sensitivity() : 1;
+    x = _gyroBaseline[0] / sensitivity;
+    y = _gyroBaseline[1] / sensitivity;
+    z = _gyroBaseline[2] / sensitivity;
 }
@@ -2,30 +2,231 @@
 #define MOTION_DETECTOR_H
 
 #include "Qmi8658c.h"
+#include "MotionWindow.h"
+#include "IirFilter.h"
+#include "GoertzelBank.h"
+#include "ImuTrace.h"
+#include "DeviationHistogram.h"
+#include "OrientationEstimator.h"
+#include "GyroBiasModel.h"
+#include "MotionStrategy.h"
+
+// Maximum samples drained from the IMU FIFO per detectMotion() call
+#define MOTION_FIFO_MAX_SAMPLES 64
+
+// Sampling task: poll anyway if no IMU interrupt arrives within this time
+#define MOTION_TASK_FALLBACK_MS 100
+#define MOTION_TASK_STACK_SIZE 4096
+#define MOTION_TASK_PRIORITY 2
+
+// Wake-on-Motion: low-power accelerometer rate and post-arm blanking
+#define MOTION_WOM_ODR acc_odr_21
+#define MOTION_WOM_BLANKING_SAMPLES 4
+
+// Adaptive ODR: idle configuration and gyroscope start-up time after re-enabling it
+#define MOTION_IDLE_ODR acc_odr_21
+#define MOTION_GYRO_SETTLE_MS 60
+
+// Minimum sensor time between two counted motion pulses
+#define MOTION_PULSE_GAP_MS 50
+
+// Filter pipeline (see IirFilter.h): high-pass removes gravity and slow tilt/bias
+// drift, low-pass rejects electrical noise. Coefficients are constexpr per ODR.
+#define MOTION_HP_CUTOFF_MHZ 500      // 0.5 Hz
+#define MOTION_LP_CUTOFF_MHZ 15000    // 15 Hz
+typedef IirChain<FirstOrderHighPass<MOTION_HP_CUTOFF_MHZ>,
+                 BiquadLowPass<MOTION_LP_CUTOFF_MHZ>> MotionFilterChain;
+
+// Background baseline tracking: EMA of the raw samples while the windowed standard
+// deviation stays below 1/4 of the thresholds for MOTION_BASELINE_QUIET_MS
+#define MOTION_BASELINE_EMA_SHIFT 8          // Time constant: 256 samples
+#define MOTION_BASELINE_FAST_SHIFT 3         // Time constant after recalibrate(): 8 samples
+#define MOTION_BASELINE_FAST_SAMPLES 64      // Quiet samples in fast mode
+#define MOTION_BASELINE_QUIET_SHIFT 4        // Variance limit = threshold^2 >> 4 (std dev < threshold / 4)
+#define MOTION_BASELINE_QUIET_MS 2000        // Quiet time before slow tracking starts
+#define MOTION_BASELINE_SAVE_MS 600000       // NVS write at most every 10 minutes...
+#define MOTION_BASELINE_SAVE_MIN_DELTA 32    // ...and only if an axis moved this many counts
+#define MOTION_PREFS_NAMESPACE "imu"
+
+// Gyro bias vs temperature: the baseline is re-interpolated when the die temperature
+// moved this far, when a bin becomes trusted, or on the temperature refresh schedule
+#define MOTION_GYRO_BIAS_REFRESH_DELTA (TEMPERATURE_SENSOR_RESOLUTION / 4)   // 1/4 degree C
+#define MOTION_GYRO_BIAS_REFRESH_MS QMI8658_TEMP_INTERVAL_MS
+
+// Spectral features (Goertzel bank on the raw accelerometer, full rate only).
+// Bins below MOTION_LOCOMOTION_BINS are locomotion (wheels, pushing, carrying),
+// the rest cover the blade motor band.
+#define MOTION_SPECTRUM_BLOCK 125            // Samples per block (0.5 s and 2 Hz bins at 250 Hz)
+#define MOTION_SPECTRUM_BINS_HZ { 2, 4, 6, 40, 45, 50, 55, 60 }
+#define MOTION_SPECTRUM_BIN_COUNT 8
+#define MOTION_LOCOMOTION_BINS 3
+#define MOTION_BLADE_MIN_G 0.02f             // Blade band amplitude for "blade running"
+#define MOTION_BLADE_ON_BLOCKS 2             // Consecutive blocks above to switch on
+#define MOTION_BLADE_OFF_BLOCKS 4            // Consecutive blocks below to switch off
+#define MOTION_LOCOMOTION_MIN_G 0.03f        // Locomotion band amplitude for the spectral strategies
+
+// Shadow mode: disagreement episodes kept for the API
+#define MOTION_SHADOW_LOG_SIZE 16
+#define MOTION_PREFS_BASELINE_KEY "baseline"
+#define MOTION_PREFS_GYRO_BIAS_KEY "gyro_bias"
+
+// Threshold auto-tuning: the proposal sits between the idle noise quantile and the
+// moving quantile (geometric mean), or MOTION_TUNE_MARGIN above the idle quantile
+// when the two overlap or no moving data exists yet
+#define MOTION_TUNE_IDLE_QUANTILE 0.99f
+#define MOTION_TUNE_MOVING_QUANTILE 0.50f
+#define MOTION_TUNE_MARGIN 2.0f
+#define MOTION_TUNE_MIN_IDLE_SAMPLES 2000
+#define MOTION_TUNE_MIN_MOVING_SAMPLES 500
+
+// Per-axis noise floor and weighting: the squared deviation becomes
+// sum(w_i * d_i^2) with w_i = mean noise variance / axis noise variance (a diagonal
+// inverse covariance), so a noisy axis needs a proportionally larger deviation.
+// Isotropic noise gives unit weights and leaves the thresholds unchanged.
+#define MOTION_NOISE_EMA_SHIFT 10            // Noise variance time constant: 1024 samples
+#define MOTION_NOISE_MIN_SAMPLES 1024        // Learned samples before weights change
+#define MOTION_NOISE_UPDATE_SAMPLES 256      // Weights recomputed this often (not per sample)
+#define MOTION_AXIS_WEIGHT_MIN 0.125f
+#define MOTION_AXIS_WEIGHT_MAX 8.0f
 
 class MotionDetector {
 public:
+    // How a sample stream becomes a moving/stationary decision
+    enum class DetectionMode : uint8_t {
+        PULSE = 0,          // Instantaneous deviation + pulse counting
+        WINDOW_RMS,         // RMS deviation over a sliding window
+        WINDOW_VARIANCE,    // Standard deviation over a sliding window (offset-free)
+        SPECTRAL,           // Locomotion band energy (windowed variance at the idle rate)
+        HYBRID              // Windowed variance, blade-only vibration ignored
+    };
+    
+    // One disagreement between the primary and the shadow strategy
+    struct ShadowEpisode {
+        uint32_t startMs;       // Sensor time
+        uint32_t durationMs;    // 0 while still open
+        bool primaryMoving;
+    };
+    
     // Constructor
     MotionDetector(Qmi8658c* imu);
     
     // Initialization
     bool begin(qmi8658_cfg_t* config);
     
-    // Calibration
+    // Calibration (blocking). Optional when baseline tracking is enabled.
     void calibrate(int samples = 100);
     bool isCalibrated() const { return _isCalibrated; }
     
+    // Background baseline tracking: the baseline follows the sensor whenever it is
+    // confidently stationary and is persisted to NVS (restored by begin())
+    void setBaselineTracking(bool enabled) { _baselineTracking = enabled; }
+    bool isBaselineTracking() const { return _baselineTracking; }
+    void recalibrate();  // Non-blocking: fast convergence over the next quiet samples
+    bool isRecalibrating() const { return _baselineFastRemaining > 0; }
+    uint32_t getBaselineUpdates() const { return _baselineUpdates; }
+    // NVS write of a baseline/bias change flagged by detectMotion(). Call from loop(),
+    // never from the sampling task: a flash write stalls the core for milliseconds.
+    void saveBaselineIfPending();
+    
     // Motion detection
     bool detectMotion();
     bool isMoving() const { return _isMoving; }
     
-    // Threshold setters
-    void setAccThreshold(float threshold) { _accMotionThreshold = threshold; }
-    void setGyroThreshold(float threshold) { _gyroMotionThreshold = threshold; }
+    // FIFO batching: evaluate every queued sample instead of one per call
+    bool enableFifo(uint8_t watermark);
+    void disableFifo();
+    bool isFifoEnabled() const { return _fifoEnabled; }
+    uint32_t getSamplesProcessed() const { return _samplesProcessed; }
+    uint32_t getFifoOverflows() const { return _fifoOverflows; }
+    
+    // Interrupt-driven sampling: an IMU INT pin ISR wakes a dedicated task
+    // that runs detectMotion(). loop() must not call detectMotion() while it runs.
+    bool startSamplingTask(int intPin, uint8_t imuIntLine);
+    bool isSamplingTaskRunning() const { return _samplingTask != nullptr; }
+    // Detach the INT pin ISR and park the task (e.g. while the pin is a sleep wakeup
+    // source); resume re-attaches the ISR and runs one pass for anything missed
+    void pauseSamplingTask();
+    void resumeSamplingTask();
+    bool isSamplingTaskPaused() const { return _samplingPaused; }
+    void notifyDataReady();  // ISR-safe; also usable to simulate the interrupt
+    uint32_t getInterruptCount() const { return _interruptCount; }
+    uint32_t getFallbackPollCount() const { return _fallbackPollCount; }
+    uint32_t getLastWakeLatencyUs() const { return _lastWakeLatencyUs; }
+    
+    // Wake-on-Motion: hand motion sensing to the IMU so the MCU can sleep.
+    // detectMotion() is suspended while armed.
+    bool armWakeOnMotion(uint8_t thresholdMg);
+    void disarmWakeOnMotion();
+    bool isWakeOnMotionArmed() const { return _womArmed; }
+    
+    // Adaptive ODR: accel-only at MOTION_IDLE_ODR while stationary, the begin()
+    // configuration from the first above-threshold sample, back to idle after quietMs
+    void enableAdaptiveOdr(unsigned long quietMs);
+    void disableAdaptiveOdr();
+    bool isAdaptiveOdrEnabled() const { return _adaptiveOdr; }
+    bool isHighRate() const { return _highRate; }
+    float getHighRateDutyCycle() const;  // Fraction of time at full rate since enabled
+    uint32_t getOdrSwitchCount() const { return _odrSwitches; }
+    
+    // Threshold setters (converted once to squared sensor counts for the hot path)
+    void setAccThreshold(float threshold);
+    void setGyroThreshold(float threshold);
     void setMotionWindowMs(unsigned long ms) { _motionWindowMs = ms; }
     void setMotionStopDelayMs(unsigned long ms) { _motionStopDelayMs = ms; }
     void setMotionPulseCount(int count) { _motionPulseCount = count; }
     
+    // Filtered deviation (no baseline needed) instead of baseline subtraction
+    void setFilterEnabled(bool enabled);
+    bool isFilterEnabled() const { return _filterEnabled; }
+    
+    // Per-axis noise floor (learned while not moving) and ellipsoidal thresholds
+    void setAxisWeighting(bool enabled);
+    bool isAxisWeighting() const { return _axisWeighting; }
+    void getAccNoiseFloor(float& x, float& y, float& z) const;   // Standard deviation (g)
+    void getGyroNoiseFloor(float& x, float& y, float& z) const;  // Standard deviation (dps)
+    float getAccAxisWeight(uint8_t axis) const { return axis < 3 ? _accAxisWeight[axis] / 65536.0f : 0; }
+    float getGyroAxisWeight(uint8_t axis) const { return axis < 3 ? _gyroAxisWeight[axis] / 65536.0f : 0; }
+    
+    // Temperature-compensated gyro bias: with baseline tracking, stationary gyro samples
+    // are learned per temperature bin and the gyro baseline follows the die temperature
+    void setGyroBiasCompensation(bool enabled);
+    bool isGyroBiasCompensation() const { return _gyroBiasEnabled; }
+    uint8_t getGyroBiasBins() const { return _gyroBias.getTrustedBins(); }
+    
+    // Orientation from the gravity vector (no extra bus traffic): lifted, tipped, upside down
+    typedef OrientationEstimator::Orientation Orientation;
+    void setUpAxis(uint8_t axis, int8_t sign) { _orientation.setUpAxis(axis, sign); }
+    Orientation getOrientation() const { return _orientation.getOrientation(); }
+    float getPitch() const { return _orientation.getPitch(); }
+    float getRoll() const { return _orientation.getRoll(); }
+    float getTilt() const { return _orientation.getTilt(); }
+    
+    // Spectral features: blade motor vibration vs low-frequency locomotion
+    bool isBladeRunning() const { return _bladeRunning; }
+    float getBladeBandLevel() const { return bandLevel(_bladePower); }        // Amplitude (g)
+    float getLocomotionBandLevel() const { return bandLevel(_locomotionPower); } // Amplitude (g)
+    
+    // Detection strategy
+    void setDetectionMode(DetectionMode mode);
+    DetectionMode getDetectionMode() const { return _detectionMode; }
+    void setWindowMs(unsigned long ms);
+    unsigned long getWindowMs() const { return _windowMs; }
+    static const char* modeName(DetectionMode mode);
+    
+    // Shadow mode: a second strategy runs on the same samples without affecting
+    // isMoving(); disagreements and the CPU cost of both are recorded
+    void setShadowMode(DetectionMode mode);  // Same as the detection mode: off
+    void disableShadow();
+    bool isShadowEnabled() const { return _shadow != nullptr; }
+    DetectionMode getShadowMode() const { return _shadowMode; }
+    bool isShadowMoving() const { return _shadow && _shadow->isMoving(); }
+    uint32_t getStrategyCycles(bool shadow) const;     // Average CPU cycles per sample
+    uint32_t getStrategyMaxCycles(bool shadow) const { return shadow ? _shadowCost.maxCycles : _primaryCost.maxCycles; }
+    uint32_t getShadowSamples() const { return _shadowSamples; }
+    uint32_t getShadowDisagreeSamples() const { return _shadowDisagreeSamples; }
+    uint32_t getShadowEpisodes() const { return _shadowEpisodes; }
+    uint8_t getShadowLog(ShadowEpisode* out, uint8_t max);  // Oldest first
+    
     // Threshold getters
     float getAccThreshold() const { return _accMotionThreshold; }
     float getGyroThreshold() const { return _gyroMotionThreshold; }
@@ -33,26 +234,101 @@ public:
     unsigned long getMotionStopDelayMs() const { return _motionStopDelayMs; }
     int getMotionPulseCount() const { return _motionPulseCount; }
     
+    // Threshold auto-tuning: log-binned histograms of the metric the current mode
+    // compares with the thresholds, split by the moving/idle state
+    void startAutoTune();  // Clear the histograms
+    float getDeviationQuantile(bool gyro, bool moving, float q) const;  // g / dps
+    uint32_t getTuneSampleCount(bool moving) const { return moving ? _accMovingHist.getCount() : _accIdleHist.getCount(); }
+    bool getProposedThresholds(float& acc, float& gyro) const;
+    bool applyProposedThresholds();
+    
     // Statistics
-    float getMaxAccDeviation() const { return _maxAccDeviation; }
-    float getMaxGyroDeviation() const { return _maxGyroDeviation; }
+    float getMaxAccDeviation() const;
+    float getMaxGyroDeviation() const;
     void resetStatistics();
     
     // Current deviation values
     float getCurrentAccDeviation() const;
     float getCurrentGyroDeviation() const;
     
+    // Windowed metrics (g / dps)
+    float getWindowAccRms() const;
+    float getWindowAccStdDev() const;
+    float getWindowGyroRms() const;
+    float getWindowGyroStdDev() const;
+    
     // Baseline values
     void getAccBaseline(float& x, float& y, float& z) const;
     void getGyroBaseline(float& x, float& y, float& z) const;
     
     // Current pulse count
-    int getCurrentPulseCount() const { return _motionPulseCounter; }
+    int getCurrentPulseCount() const { return _pulseStrategy.getPulseCount(); }
+    
+    // Trace capture: every sample read from the IMU is copied to a buffer that a
+    // reader drains with readTrace() (see ImuTrace.h for the format)
+    void startTrace();
+    void stopTrace();
+    bool isTracing() const { return _trace.isActive(); }
+    uint16_t readTrace(ImuTraceRecord* out, uint16_t max);
+    const ImuTraceHeader& getTraceHeader() const { return _trace.getHeader(); }
+    uint32_t getTraceDropped() const { return _trace.getDropped(); }
+    
+    // Replay: process a traced sample instead of reading the IMU. Rate changes and
+    // resyncs follow the record flags and all timing comes from the record sample
+    // counters, never millis(); disable adaptive ODR while replaying.
+    bool feedRecord(const ImuTraceRecord& record);
+    
+    // Sensor time base (from the IMU sample counter)
+    unsigned long getSensorTimeMs() const { return _sensorMs; }
+    uint32_t getDroppedSamples() const { return _droppedSamples; }
+    uint32_t getDuplicateSamples() const { return _duplicateSamples; }
 
 private:
     // IMU reference
     Qmi8658c* _imu;
-    qmi_data_t _data;
+    qmi_raw_data_t _data;
+    
+    // FIFO batching
+    bool _fifoEnabled;
+    uint32_t _samplePeriodUs;
+    qmi_raw_data_t _fifoSamples[MOTION_FIFO_MAX_SAMPLES];
+    uint32_t _samplesProcessed;
+    uint32_t _fifoOverflows;
+    
+    // Interrupt-driven sampling
+    TaskHandle_t _samplingTask;
+    SemaphoreHandle_t _imuMutex;
+    volatile uint32_t _interruptCount;
+    volatile uint32_t _lastInterruptUs;
+    uint32_t _fallbackPollCount;
+    uint32_t _lastWakeLatencyUs;
+    int _intPin;
+    uint8_t _imuIntLine;
+    volatile bool _samplingPaused;
+    
+    // Wake-on-Motion
+    bool _womArmed;
+    
+    // Adaptive ODR
+    qmi8658_cfg_t _activeCfg;
+    bool _adaptiveOdr;
+    bool _highRate;
+    bool _batchHadMotion;
+    unsigned long _odrQuietMs;
+    unsigned long _adaptiveSince;
+    unsigned long _odrModeSince;
+    unsigned long _highRateMs;
+    unsigned long _gyroValidFrom;
+    uint32_t _odrSwitches;
+    unsigned long _lastMotionWallMs;
+    
+    // Sensor time base: the pulse logic runs on sample counts, not on millis()
+    bool _stampValid;
+    uint32_t _lastStamp;
+    unsigned long _sensorMs;
+    uint32_t _sensorUsRem;
+    uint32_t _droppedSamples;
+    uint32_t _duplicateSamples;
     
     // Tunable thresholds
     float _accMotionThreshold;
@@ -61,25 +337,151 @@ private:
     unsigned long _motionStopDelayMs;
     int _motionPulseCount;
     
-    // Baseline calibration
-    float _accBaselineX, _accBaselineY, _accBaselineZ;
-    float _gyroBaselineX, _gyroBaselineY, _gyroBaselineZ;
+    // Filter pipeline; _accSignal/_gyroSignal hold the sample fed to detection
+    bool _filterEnabled;
+    IirFilter3<MotionFilterChain> _accFilter;
+    IirFilter3<MotionFilterChain> _gyroFilter;
+    int16_t _accSignal[3];
+    int16_t _gyroSignal[3];
+    
+    // Per-axis noise (counts^2 << 8) and the weights derived from it (Q16)
+    bool _axisWeighting;
+    uint64_t _accNoiseQ[3];
+    uint64_t _gyroNoiseQ[3];
+    uint32_t _accNoiseSamples;
+    uint32_t _gyroNoiseSamples;
+    uint32_t _accAxisWeight[3];
+    uint32_t _gyroAxisWeight[3];
+    
+    // Orientation
+    OrientationEstimator _orientation;
+    
+    // Gyro bias vs temperature
+    GyroBiasModel _gyroBias;
+    bool _gyroBiasEnabled;
+    int16_t _gyroBiasTemp;       // Temperature the baseline was last interpolated at
+    unsigned long _gyroBiasRefreshMs;  // Sensor time of that interpolation
+    bool _gyroBiasStale;
+    
+    // Spectral features
+    GoertzelBank _spectrum;
+    uint64_t _bladePower;
+    uint64_t _locomotionPower;
+    uint64_t _bladePowerThreshold;
+    uint64_t _locomotionPowerThreshold;
+    bool _bladeRunning;
+    uint8_t _bladeBlocks;
+    bool _spectrumValid;         // A block completed since the last reconfiguration
+    
+    // Trace capture
+    ImuTraceRecorder _trace;
+    
+    // Auto-tuning statistics (counts^2)
+    DeviationHistogram _accIdleHist;
+    DeviationHistogram _accMovingHist;
+    DeviationHistogram _gyroIdleHist;
+    DeviationHistogram _gyroMovingHist;
+    
+    // Windowed detection
+    DetectionMode _detectionMode;
+    unsigned long _windowMs;
+    MotionWindow _accWindow;
+    MotionWindow _gyroWindow;
+    
+    // Decision strategies: one instance each, primary and shadow point into these
+    PulseStrategy _pulseStrategy;
+    WindowStrategy _rmsStrategy;
+    WindowStrategy _varianceStrategy;
+    SpectralStrategy _spectralStrategy;
+    HybridStrategy _hybridStrategy;
+    MotionStrategy* _strategy;
+    MotionStrategy* _shadow;
+    DetectionMode _shadowMode;
+    
+    // Shadow statistics (CPU cycles of strategy updates only)
+    struct StrategyCost {
+        uint64_t cycles;
+        uint32_t maxCycles;
+    };
+    StrategyCost _primaryCost;
+    StrategyCost _shadowCost;
+    uint32_t _shadowSamples;
+    uint32_t _shadowDisagreeSamples;
+    uint32_t _shadowEpisodes;
+    bool _shadowDisagree;
+    ShadowEpisode _shadowLog[MOTION_SHADOW_LOG_SIZE];
+    uint8_t _shadowLogHead;
+    uint8_t _shadowLogCount;
+    
+    // Thresholds in squared sensor counts (see updateScaledThresholds())
+    uint32_t _accThresholdSq;
+    uint32_t _gyroThresholdSq;
+    
+    // Baseline calibration (sensor counts)
+    int16_t _accBaseline[3];
+    int16_t _gyroBaseline[3];
     bool _isCalibrated;
     
+    // Baseline tracking (EMA state in counts << 8)
+    bool _baselineTracking;
+    int32_t _accBaselineQ[3];
+    int32_t _gyroBaselineQ[3];
+    unsigned long _quietStart;
+    uint16_t _baselineFastRemaining;
+    uint32_t _baselineUpdates;
+    volatile bool _baselineSavePending;  // Set by the sampling task, written out by loop()
+    unsigned long _lastBaselineSaveMs;
+    int16_t _savedAccBaseline[3];
+    
     // Motion state
     bool _isMoving;
-    unsigned long _lastMotionTime;
-    unsigned long _motionWindowStart;
-    int _motionPulseCounter;
-    unsigned long _lastPulseTime;
+    unsigned long _lastSampleTime;
     
-    // Statistics
-    float _maxAccDeviation;
-    float _maxGyroDeviation;
+    // Statistics (squared sensor counts)
+    uint64_t _maxAccDeviationSq;
+    uint64_t _maxGyroDeviationSq;
     
     // Helper methods
-    float calculateAccDeviation() const;
-    float calculateGyroDeviation() const;
+    void processSample(unsigned long now);
+    void updateScaledThresholds();
+    void updateWindowLength();
+    MotionStrategy* strategyFor(DetectionMode mode);
+    void runStrategies(const MotionFeatures& features);
+    void recordCost(StrategyCost& cost, uint32_t cycles);
+    void resetShadowStats();
+    uint64_t decisionMetricSq(const MotionWindow& window, uint64_t sampleDevSq) const;
+    void updateTuning(uint64_t accDevSq, uint64_t gyroDevSq, bool gyroValid);
+    static float proposeThreshold(const DeviationHistogram& idle, const DeviationHistogram& moving, uint16_t sensitivity);
+    void applyOdrPolicy(unsigned long now);
+    bool advanceSensorTime(uint32_t stamp);
+    void resyncSensorTime(unsigned long now);
+    bool setHighRate(bool high, unsigned long now);
+    void applyRate(bool high, unsigned long now);
+    float highRateDutyCycle(unsigned long now) const;
+    static uint32_t scaleThresholdSq(float threshold, uint16_t sensitivity);
+    static uint64_t deviationSq(const int16_t* sample, const int16_t* baseline, const uint32_t* weightsQ16);
+    void learnNoise(const MotionWindow& window, uint64_t* noiseQ, uint32_t& samples, uint32_t* weights);
+    static void computeAxisWeights(const uint64_t* noiseQ, uint32_t* weights);
+    void resetAxisWeights();
+    static void noiseFloor(const uint64_t* noiseQ, uint16_t sensitivity, float& x, float& y, float& z);
+    void lockImu();
+    void unlockImu();
+    static void samplingTaskEntry(void* arg);
+    static void IRAM_ATTR dataReadyISR(void* arg);
+    void configureFilters(acc_odr_t odr);
+    void configureSpectrum();
+    void updateSpectrum();
+    float bandLevel(uint64_t power) const;
+    bool isStationary(bool gyroValid) const;
+    void updateBaseline(unsigned long now, bool gyroValid);
+    void setBaseline(const int16_t* acc, const int16_t* gyro);
+    bool loadBaseline();
+    void saveBaseline();
+    void refreshGyroBias(unsigned long now);
+    void loadGyroBias();
+    void saveGyroBias();
+    uint64_t calculateAccDeviationSq() const;
+    uint64_t calculateGyroDeviationSq() const;
 };
 
 #endif // MOTION_DETECTOR_H
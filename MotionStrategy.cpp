@@ -0,0 +1,89 @@
+#include "MotionStrategy.h"
+
+// MOTION_PULSE_GAP_MS lives with the other detector timing constants
+#include "MotionDetector.h"
+
+static bool windowAbove(const MotionWindow* window, uint32_t thresholdSq, bool variance) {
+    if (!window->isReady()) return false;
+    return variance ? window->varianceAbove(thresholdSq) : window->rmsAbove(thresholdSq);
+}
+
+static bool varianceAbove(const MotionFeatures& f) {
+    return windowAbove(f.accWindow, f.accThresholdSq, true) ||
+           windowAbove(f.gyroWindow, f.gyroThresholdSq, true);
+}
+
+bool MotionStrategy::hold(bool evidence, const MotionFeatures& f) {
+    if (evidence) {
+        _lastMotionTime = f.now;
+        _moving = true;
+    } else if (_moving && (f.now - _lastMotionTime > f.stopDelayMs)) {
+        _moving = false;
+    }
+    return _moving;
+}
+
+void PulseStrategy::reset(bool moving, unsigned long now) {
+    MotionStrategy::reset(moving, now);
+    _windowStart = 0;
+    _pulseCounter = 0;
+}
+
+bool PulseStrategy::update(const MotionFeatures& f) {
+    unsigned long now = f.now;
+
+    if (f.sampleAbove) {
+        _lastMotionTime = now;
+
+        // Start a new motion detection window if needed
+        if (_windowStart == 0) {
+            _windowStart = now;
+            _pulseCounter = 1;
+        } else if (now - _windowStart <= f.pulseWindowMs) {
+            // Count this pulse (but avoid counting continuously - needs gap)
+            if (now - _lastPulseTime > MOTION_PULSE_GAP_MS) {
+                _pulseCounter++;
+                _lastPulseTime = now;
+            }
+        } else {
+            // Window expired, restart
+            _windowStart = now;
+            _pulseCounter = 1;
+        }
+
+        // If we've detected enough motion pulses, declare moving
+        if (_pulseCounter >= f.pulseCount) {
+            _moving = true;
+        }
+        return _moving;
+    }
+
+    // Reset if the window expired without enough pulses
+    if (!_moving && _windowStart != 0 && (now - _windowStart > f.pulseWindowMs)) {
+        _windowStart = 0;
+        _pulseCounter = 0;
+    }
+
+    // If already moving, wait for stop delay
+    if (_moving && (now - _lastMotionTime > f.stopDelayMs)) {
+        _moving = false;
+        _windowStart = 0;
+        _pulseCounter = 0;
+    }
+    return _moving;
+}
+
+bool WindowStrategy::update(const MotionFeatures& f) {
+    // A single spike barely moves a windowed metric: no pulse counting needed
+    return hold(windowAbove(f.accWindow, f.accThresholdSq, _variance) ||
+                windowAbove(f.gyroWindow, f.gyroThresholdSq, _variance), f);
+}
+
+bool SpectralStrategy::update(const MotionFeatures& f) {
+    return hold(f.spectrumValid ? f.locomotionAbove : varianceAbove(f), f);
+}
+
+bool HybridStrategy::update(const MotionFeatures& f) {
+    bool bladeOnly = f.spectrumValid && f.bladeRunning && !f.locomotionAbove;
+    return hold(varianceAbove(f) && !bladeOnly, f);
+}
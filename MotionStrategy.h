@@ -0,0 +1,118 @@
+#ifndef MOTION_STRATEGY_H
+#define MOTION_STRATEGY_H
+
+#include <Arduino.h>
+#include "MotionWindow.h"
+
+/**
+ * @brief Everything a strategy may look at for one sample
+ *
+ * Built once per sample by MotionDetector, so running a second (shadow)
+ * strategy costs only its own decision logic.
+ */
+struct MotionFeatures {
+    unsigned long now;                 // Sensor time (ms)
+    bool sampleAbove;                  // Instantaneous deviation above a threshold
+    const MotionWindow* accWindow;
+    const MotionWindow* gyroWindow;    // Empty while the gyroscope is off
+    uint32_t accThresholdSq;           // Counts^2
+    uint32_t gyroThresholdSq;
+
+    // Last completed Goertzel block (valid only at full rate)
+    bool spectrumValid;
+    bool locomotionAbove;              // Locomotion band above its threshold
+    bool bladeRunning;
+
+    // Timing parameters shared by all strategies
+    unsigned long pulseWindowMs;
+    int pulseCount;
+    unsigned long stopDelayMs;
+};
+
+/**
+ * @brief Moving/stationary decision from per-sample features
+ *
+ * Implementations keep their own state, so two of them can run side by
+ * side on the same samples. All of them stay "moving" until stopDelayMs
+ * passes without evidence.
+ */
+class MotionStrategy {
+public:
+    virtual ~MotionStrategy() {}
+
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Process one sample
+     * @return true while moving
+     */
+    virtual bool update(const MotionFeatures& f) = 0;
+
+    /**
+     * @brief Drop accumulated evidence and start from a known state
+     */
+    virtual void reset(bool moving, unsigned long now) {
+        _moving = moving;
+        _lastMotionTime = now;
+    }
+
+    bool isMoving() const { return _moving; }
+
+protected:
+    bool _moving = false;
+    unsigned long _lastMotionTime = 0;
+
+    // Moving while there is evidence, stationary stopDelayMs after the last of it
+    bool hold(bool evidence, const MotionFeatures& f);
+};
+
+/**
+ * @brief Instantaneous deviation + pulse counting within a time window
+ */
+class PulseStrategy : public MotionStrategy {
+public:
+    const char* name() const override { return "pulse"; }
+    bool update(const MotionFeatures& f) override;
+    void reset(bool moving, unsigned long now) override;
+    int getPulseCount() const { return _pulseCounter; }
+
+private:
+    unsigned long _windowStart = 0;
+    int _pulseCounter = 0;
+    unsigned long _lastPulseTime = 0;
+};
+
+/**
+ * @brief RMS deviation or standard deviation over the sliding window
+ */
+class WindowStrategy : public MotionStrategy {
+public:
+    explicit WindowStrategy(bool variance) : _variance(variance) {}
+    const char* name() const override { return _variance ? "variance" : "rms"; }
+    bool update(const MotionFeatures& f) override;
+
+private:
+    bool _variance;
+};
+
+/**
+ * @brief Locomotion band energy from the Goertzel bank (windowed variance
+ * when no spectrum is available, e.g. at the idle rate)
+ */
+class SpectralStrategy : public MotionStrategy {
+public:
+    const char* name() const override { return "spectral"; }
+    bool update(const MotionFeatures& f) override;
+};
+
+/**
+ * @brief Windowed variance, except vibration that is only the blade motor
+ * (blade running, no locomotion energy) does not count
+ */
+class HybridStrategy : public MotionStrategy {
+public:
+    const char* name() const override { return "hybrid"; }
+    bool update(const MotionFeatures& f) override;
+};
+
+#endif // MOTION_STRATEGY_H
@@ -0,0 +1,99 @@
+#include "MotionWindow.h"
+#include <math.h>
+
+MotionWindow::MotionWindow()
+    : _length(MOTION_WINDOW_MAX_SAMPLES)
+{
+    for (int axis = 0; axis < 3; axis++) {
+        _weightQ16[axis] = 1UL << MOTION_WINDOW_WEIGHT_SHIFT;
+    }
+    reset();
+}
+
+void MotionWindow::setAxisWeights(const uint32_t* weightsQ16) {
+    memcpy(_weightQ16, weightsQ16, sizeof(_weightQ16));
+}
+
+void MotionWindow::setLength(uint8_t length) {
+    if (length < MOTION_WINDOW_MIN_SAMPLES) length = MOTION_WINDOW_MIN_SAMPLES;
+    if (length > MOTION_WINDOW_MAX_SAMPLES) length = MOTION_WINDOW_MAX_SAMPLES;
+    _length = length;
+    reset();
+}
+
+void MotionWindow::reset() {
+    _head = 0;
+    _count = 0;
+    _sumDevSq = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        _sum[axis] = 0;
+        _sumSq[axis] = 0;
+    }
+}
+
+void MotionWindow::push(const int16_t* xyz, uint64_t devSq) {
+    // Saturate: thresholds never exceed 32 bits, so comparisons are unaffected
+    uint32_t dev = (devSq > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)devSq;
+
+    if (_count == _length) {
+        // Evict the oldest sample (the slot about to be overwritten)
+        for (int axis = 0; axis < 3; axis++) {
+            int32_t old = _xyz[_head][axis];
+            _sum[axis] -= old;
+            _sumSq[axis] -= old * old;
+        }
+        _sumDevSq -= _devSq[_head];
+    } else {
+        _count++;
+    }
+
+    for (int axis = 0; axis < 3; axis++) {
+        int32_t v = xyz[axis];
+        _xyz[_head][axis] = xyz[axis];
+        _sum[axis] += v;
+        _sumSq[axis] += v * v;
+    }
+    _devSq[_head] = dev;
+    _sumDevSq += dev;
+
+    _head = (_head + 1 == _length) ? 0 : _head + 1;
+}
+
+bool MotionWindow::rmsAbove(uint32_t thresholdSq) const {
+    // mean(devSq) > T^2  <=>  sum(devSq) > T^2 * N
+    return _count && _sumDevSq > (uint64_t)thresholdSq * _count;
+}
+
+bool MotionWindow::varianceAbove(uint32_t thresholdSq) const {
+    // sum_axis(var) > T^2  <=>  sum_axis(N*sumSq - sum^2) > T^2 * N^2
+    return _count && scaledVariance() > (int64_t)((uint64_t)thresholdSq * _count * _count);
+}
+
+int64_t MotionWindow::scaledVariance() const {
+    int64_t total = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        int64_t scaled = (int64_t)_count * _sumSq[axis] - (int64_t)_sum[axis] * _sum[axis];
+        total += (scaled * _weightQ16[axis]) >> MOTION_WINDOW_WEIGHT_SHIFT;
+    }
+    return total;
+}
+
+uint64_t MotionWindow::getAxisVarianceSq(uint8_t axis) const {
+    if (!_count || axis > 2) return 0;
+    int64_t scaled = (int64_t)_count * _sumSq[axis] - (int64_t)_sum[axis] * _sum[axis];
+    return (scaled > 0) ? (uint64_t)scaled / ((uint64_t)_count * _count) : 0;
+}
+
+uint64_t MotionWindow::getVarianceSq() const {
+    if (!_count) return 0;
+    int64_t scaled = scaledVariance();
+    return (scaled > 0) ? (uint64_t)scaled / ((uint64_t)_count * _count) : 0;
+}
+
+float MotionWindow::getRms() const {
+    return _count ? sqrtf((float)_sumDevSq / _count) : 0;
+}
+
+float MotionWindow::getStdDev() const {
+    return _count ? sqrtf((float)scaledVariance()) / _count : 0;
+}
@@ -0,0 +1,96 @@
+#ifndef MOTION_WINDOW_H
+#define MOTION_WINDOW_H
+
+#include <Arduino.h>
+
+// Longest window in samples (e.g. 256 ms at 250 Hz)
+#define MOTION_WINDOW_MAX_SAMPLES 64
+
+// Shortest window: fewer samples are not enough to judge (or to outvote a spike)
+#define MOTION_WINDOW_MIN_SAMPLES 4
+
+// Per-axis weights are Q16 (1 << 16 = unit weight)
+#define MOTION_WINDOW_WEIGHT_SHIFT 16
+
+/**
+ * @brief Sliding window over 3-axis samples in sensor counts
+ *
+ * Keeps running sums so that, per window, both metrics update in O(1)
+ * per sample and are compared without division, float or sqrt:
+ * - RMS of the deviation from the calibrated baseline (mean of the squared deviation)
+ * - Total variance (sum of the per-axis variances around the window mean),
+ *   which ignores any constant offset such as gravity on a slope
+ *
+ * The variance is a weighted sum over the axes (see setAxisWeights()); the
+ * squared deviations are pushed already weighted by the caller.
+ */
+class MotionWindow {
+public:
+    MotionWindow();
+
+    /**
+     * @brief Set the window length (clamped to MOTION_WINDOW_MIN/MAX_SAMPLES) and clear it
+     */
+    void setLength(uint8_t length);
+    uint8_t getLength() const { return _length; }
+    
+    /**
+     * @brief Per-axis weights of the total variance (Q16)
+     */
+    void setAxisWeights(const uint32_t* weightsQ16);
+
+    /**
+     * @brief Drop all samples
+     */
+    void reset();
+
+    /**
+     * @brief Add a sample, evicting the oldest once the window is full
+     * @param xyz Sample in counts
+     * @param devSq Squared deviation of the sample from the baseline (counts^2)
+     */
+    void push(const int16_t* xyz, uint64_t devSq);
+
+    uint8_t getCount() const { return _count; }
+
+    /**
+     * @brief True once the window is full: a partly filled window would let a
+     * single spike dominate the metrics
+     */
+    bool isReady() const { return _length && _count >= _length; }
+
+    /**
+     * @brief Windowed RMS deviation above a threshold given in counts^2
+     */
+    bool rmsAbove(uint32_t thresholdSq) const;
+
+    /**
+     * @brief Windowed total variance above a threshold given in counts^2
+     */
+    bool varianceAbove(uint32_t thresholdSq) const;
+
+    // Current values in counts^2 (what rmsAbove() / varianceAbove() compare)
+    uint64_t getMeanDevSq() const { return _count ? _sumDevSq / _count : 0; }
+    uint64_t getVarianceSq() const;
+    uint64_t getAxisVarianceSq(uint8_t axis) const;  // Unweighted
+    
+    // Current values in counts (reporting only)
+    float getRms() const;
+    float getStdDev() const;
+
+private:
+    int16_t _xyz[MOTION_WINDOW_MAX_SAMPLES][3];
+    uint32_t _devSq[MOTION_WINDOW_MAX_SAMPLES];
+    uint8_t _length;
+    uint8_t _head;
+    uint8_t _count;
+
+    int32_t _sum[3];
+    int64_t _sumSq[3];
+    uint64_t _sumDevSq;
+    uint32_t _weightQ16[3];
+
+    int64_t scaledVariance() const;
+};
+
+#endif // MOTION_WINDOW_H
@@ -0,0 +1,185 @@
+#include "OrientationEstimator.h"
+#include <math.h>
+
+OrientationEstimator::OrientationEstimator()
+    : _upAxis(2)
+    , _upSign(1)
+    , _gyroRadPerCount(0)
+    , _gravityGain(1)
+    , _liftGain(1)
+    , _rateGain(1)
+    , _rateClearSq(0)
+    , _liftOnSq(0)
+    , _levelLowSq(0)
+    , _levelHighSq(0)
+    , _primed(false)
+    , _upProjection(0)
+    , _state(Orientation::UPRIGHT)
+    , _candidate(Orientation::UPRIGHT)
+    , _candidateSince(0)
+    , _lifted(false)
+    , _liftRising(false)
+    , _liftSince(0)
+    , _settling(false)
+    , _settledSince(0)
+{
+    memset(_gravity, 0, sizeof(_gravity));
+    memset(_rate, 0, sizeof(_rate));
+
+    // Thresholds only depend on constants. x -> x * |x| is monotonic, so
+    // cos(tilt) >= c  <=>  up * |up| >= c * |c| * |gravity|^2
+    _cosTipped = signedSquare(cosf(ORIENT_TIPPED_DEG * DEG_TO_RAD));
+    _cosTippedClear = signedSquare(cosf((ORIENT_TIPPED_DEG - ORIENT_TILT_HYSTERESIS_DEG) * DEG_TO_RAD));
+    _cosUpsideDown = signedSquare(cosf(ORIENT_UPSIDE_DOWN_DEG * DEG_TO_RAD));
+    _cosUpsideDownClear = signedSquare(cosf((ORIENT_UPSIDE_DOWN_DEG - ORIENT_TILT_HYSTERESIS_DEG) * DEG_TO_RAD));
+}
+
+void OrientationEstimator::setUpAxis(uint8_t axis, int8_t sign) {
+    _upAxis = (axis < 3) ? axis : 2;
+    _upSign = (sign < 0) ? -1 : 1;
+}
+
+void OrientationEstimator::configure(uint32_t samplePeriodUs, uint16_t accSensitivity, uint16_t gyroSensitivity) {
+    float dt = samplePeriodUs * 1e-6f;
+
+    _gyroRadPerCount = gyroSensitivity ? dt / gyroSensitivity * DEG_TO_RAD : 0;
+    _gravityGain = dt / (ORIENT_GRAVITY_TAU_MS * 1e-3f + dt);
+    _liftGain = dt / (ORIENT_LIFT_TAU_MS * 1e-3f + dt);
+    _rateGain = dt / (ORIENT_RATE_TAU_MS * 1e-3f + dt);
+    _rateClearSq = ORIENT_LIFT_CLEAR_DPS * gyroSensitivity * ORIENT_LIFT_CLEAR_DPS * gyroSensitivity;
+
+    float lsbPerG = accSensitivity ? accSensitivity : 1;
+    _liftOnSq = (1.0f + ORIENT_LIFT_G) * lsbPerG * (1.0f + ORIENT_LIFT_G) * lsbPerG;
+    _levelLowSq = (1.0f - ORIENT_LIFT_CLEAR_G) * lsbPerG * (1.0f - ORIENT_LIFT_CLEAR_G) * lsbPerG;
+    _levelHighSq = (1.0f + ORIENT_LIFT_CLEAR_G) * lsbPerG * (1.0f + ORIENT_LIFT_CLEAR_G) * lsbPerG;
+    _primed = false;
+}
+
+float OrientationEstimator::cosTilt() const {
+    float norm = sqrtf(_gravity[0] * _gravity[0] + _gravity[1] * _gravity[1] + _gravity[2] * _gravity[2]);
+    return (norm > 0) ? _upSign * _gravity[_upAxis] / norm : 1.0f;
+}
+
+void OrientationEstimator::update(const int16_t* acc, const int16_t* gyro, bool gyroValid, bool quiet, unsigned long now) {
+    bool priming = !_primed;
+    if (priming) {
+        for (int axis = 0; axis < 3; axis++) _gravity[axis] = acc[axis];
+        _primed = true;
+    }
+
+    // Propagate: a world-fixed vector seen from the rotating body, dg/dt = g x w
+    if (gyroValid) {
+        float wx = gyro[0] * _gyroRadPerCount;
+        float wy = gyro[1] * _gyroRadPerCount;
+        float wz = gyro[2] * _gyroRadPerCount;
+        float gx = _gravity[0], gy = _gravity[1], gz = _gravity[2];
+        _gravity[0] += gy * wz - gz * wy;
+        _gravity[1] += gz * wx - gx * wz;
+        _gravity[2] += gx * wy - gy * wx;
+    }
+
+    // Correct towards the accelerometer
+    for (int axis = 0; axis < 3; axis++) {
+        _gravity[axis] += _gravityGain * (acc[axis] - _gravity[axis]);
+    }
+
+    // Everything below compares against the squared norm: no sqrt, no divide
+    float normSq = _gravity[0] * _gravity[0] + _gravity[1] * _gravity[1] + _gravity[2] * _gravity[2];
+    float upSq = signedSquare(_upSign * _gravity[_upAxis]);
+
+    // Specific force along the gravity direction times |gravity|: 1 g at rest, more
+    // while being lifted. |gravity| moves much slower than the lift low-pass.
+    float projection = acc[0] * _gravity[0] + acc[1] * _gravity[1] + acc[2] * _gravity[2];
+    if (priming) {
+        _upProjection = projection;
+    }
+    _upProjection += _liftGain * (projection - _upProjection);
+    float projectionSq = (_upProjection > 0) ? _upProjection * _upProjection : 0;
+
+    if (projectionSq > _liftOnSq * normSq) {
+        if (!_liftRising) {
+            _liftRising = true;
+            _liftSince = now;
+        } else if (now - _liftSince >= ORIENT_LIFT_MIN_MS) {
+            _lifted = true;
+        }
+    } else {
+        _liftRising = false;
+    }
+
+    // Rotation rate low-pass: the vector average cancels blade vibration, not carrying sway
+    bool slow = false;
+    if (gyroValid) {
+        for (int axis = 0; axis < 3; axis++) {
+            _rate[axis] += priming ? gyro[axis] - _rate[axis] : _rateGain * (gyro[axis] - _rate[axis]);
+        }
+        slow = _rate[0] * _rate[0] + _rate[1] * _rate[1] + _rate[2] * _rate[2] <= _rateClearSq;
+    }
+
+    // A lift ends once the robot is set down level and either stays still or, with the
+    // blade running, no longer pushes the up-force away from 1 g and no longer turns.
+    // Without the gyroscope only stillness counts.
+    if (_lifted) {
+        bool level = upSq >= _cosTippedClear * normSq;
+        bool oneG = projectionSq >= _levelLowSq * normSq && projectionSq <= _levelHighSq * normSq;
+        if (level && (quiet || (oneG && slow))) {
+            if (!_settling) {
+                _settling = true;
+                _settledSince = now;
+            } else if (now - _settledSince >= ORIENT_LIFT_CLEAR_MS) {
+                _lifted = false;
+            }
+        } else {
+            _settling = false;
+        }
+    }
+
+    // Worst condition wins; hysteresis while already in a tilt state
+    Orientation target = Orientation::UPRIGHT;
+    float upsideLimit = (_state == Orientation::UPSIDE_DOWN) ? _cosUpsideDownClear : _cosUpsideDown;
+    float tippedLimit = (_state >= Orientation::TIPPED) ? _cosTippedClear : _cosTipped;
+    if (upSq < upsideLimit * normSq) {
+        target = Orientation::UPSIDE_DOWN;
+    } else if (upSq < tippedLimit * normSq) {
+        target = Orientation::TIPPED;
+    } else if (_lifted) {
+        target = Orientation::LIFTED;
+    }
+
+    if (target == _state) {
+        _candidate = target;
+        return;
+    }
+
+    // Lift is already time-qualified; tilt changes must persist
+    if (target == Orientation::LIFTED || (_state == Orientation::LIFTED && target == Orientation::UPRIGHT)) {
+        _state = target;
+        _candidate = target;
+    } else if (target != _candidate) {
+        _candidate = target;
+        _candidateSince = now;
+    } else if (now - _candidateSince >= ORIENT_HOLD_MS) {
+        _state = target;
+    }
+}
+
+const char* OrientationEstimator::toString(Orientation orientation) {
+    switch (orientation) {
+        case Orientation::LIFTED:      return "lifted";
+        case Orientation::TIPPED:      return "tipped";
+        case Orientation::UPSIDE_DOWN: return "flipped";
+        default:                       return "upright";
+    }
+}
+
+float OrientationEstimator::getPitch() const {
+    return atan2f(-_gravity[0], sqrtf(_gravity[1] * _gravity[1] + _gravity[2] * _gravity[2])) * RAD_TO_DEG;
+}
+
+float OrientationEstimator::getRoll() const {
+    return atan2f(_gravity[1], _gravity[2]) * RAD_TO_DEG;
+}
+
+float OrientationEstimator::getTilt() const {
+    return acosf(constrain(cosTilt(), -1.0f, 1.0f)) * RAD_TO_DEG;
+}
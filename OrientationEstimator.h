@@ -0,0 +1,121 @@
+#ifndef ORIENTATION_ESTIMATOR_H
+#define ORIENTATION_ESTIMATOR_H
+
+#include <Arduino.h>
+
+// Complementary filter time constant: the accelerometer corrects the gyro-propagated
+// gravity vector over this time (ms)
+#define ORIENT_GRAVITY_TAU_MS 500
+
+// Tilt from the mount "up" axis (degrees); clearing needs ORIENT_TILT_HYSTERESIS_DEG less
+#define ORIENT_TIPPED_DEG 35.0f
+#define ORIENT_UPSIDE_DOWN_DEG 120.0f
+#define ORIENT_TILT_HYSTERESIS_DEG 5.0f
+#define ORIENT_HOLD_MS 500               // A tilt state must persist this long
+
+// Lift: upward specific force above 1 g + ORIENT_LIFT_G for ORIENT_LIFT_MIN_MS
+// (low-passed over ORIENT_LIFT_TAU_MS). Cleared once level for ORIENT_LIFT_CLEAR_MS while
+// either still, or with the up-force within ORIENT_LIFT_CLEAR_G of 1 g and the rotation
+// rate (low-passed over ORIENT_RATE_TAU_MS, which averages blade vibration out) below
+// ORIENT_LIFT_CLEAR_DPS. Blade vibration keeps the stationarity test from ever passing;
+// the rate test keeps a robot carried level from counting as set down.
+#define ORIENT_LIFT_G 0.15f
+#define ORIENT_LIFT_TAU_MS 30
+#define ORIENT_LIFT_MIN_MS 80
+#define ORIENT_LIFT_CLEAR_MS 2000
+#define ORIENT_LIFT_CLEAR_G 0.05f
+#define ORIENT_LIFT_CLEAR_DPS 10.0f
+#define ORIENT_RATE_TAU_MS 100
+
+/**
+ * @brief Gravity-vector orientation estimate from samples already read for motion detection
+ *
+ * A complementary filter propagates the gravity vector (sensor frame, counts)
+ * with the gyroscope and pulls it towards the accelerometer; with the
+ * gyroscope off it degrades to a low-pass of the accelerometer. Tilt is the
+ * angle from the configured "up" axis; it is compared through precomputed
+ * signed squared cosines against the squared norm, so update() needs no
+ * trigonometry, square root or division.
+ */
+class OrientationEstimator {
+public:
+    enum class Orientation : uint8_t {
+        UPRIGHT = 0,
+        LIFTED,
+        TIPPED,
+        UPSIDE_DOWN
+    };
+
+    OrientationEstimator();
+
+    /**
+     * @brief Axis of the sensor that points up when the robot is level
+     * @param axis 0 = X, 1 = Y, 2 = Z
+     * @param sign +1 or -1
+     */
+    void setUpAxis(uint8_t axis, int8_t sign);
+
+    /**
+     * @brief Precompute the per-sample constants for a rate and scale
+     */
+    void configure(uint32_t samplePeriodUs, uint16_t accSensitivity, uint16_t gyroSensitivity);
+
+    /**
+     * @brief Re-initialise the gravity vector from the next sample
+     */
+    void reset() { _primed = false; }
+
+    /**
+     * @brief Feed one sample
+     * @param acc Accelerometer counts
+     * @param gyro Gyroscope counts, bias removed (ignored unless gyroValid)
+     * @param quiet Caller's stationarity test (used to clear a lift)
+     * @param now Sensor time (ms)
+     */
+    void update(const int16_t* acc, const int16_t* gyro, bool gyroValid, bool quiet, unsigned long now);
+
+    Orientation getOrientation() const { return _state; }
+    static const char* toString(Orientation orientation);
+
+    // Reporting only (degrees, sensor frame with Z up)
+    float getPitch() const;
+    float getRoll() const;
+    float getTilt() const;
+
+private:
+    uint8_t _upAxis;
+    int8_t _upSign;
+
+    // Per-sample constants (configure())
+    float _gyroRadPerCount;      // Rotation per sample per gyro count
+    float _gravityGain;          // Accelerometer correction per sample
+    float _liftGain;             // Lift force low-pass per sample
+    float _rateGain;             // Rotation rate low-pass per sample
+    float _rateClearSq;          // (ORIENT_LIFT_CLEAR_DPS in counts)^2
+    float _liftOnSq;             // ((1 + ORIENT_LIFT_G) g in counts)^2
+    float _levelLowSq;           // ((1 - ORIENT_LIFT_CLEAR_G) g in counts)^2
+    float _levelHighSq;          // ((1 + ORIENT_LIFT_CLEAR_G) g in counts)^2
+    float _cosTipped, _cosTippedClear;              // Signed squares: c * |c|
+    float _cosUpsideDown, _cosUpsideDownClear;
+
+    // Filter state
+    bool _primed;
+    float _gravity[3];           // Counts
+    float _upProjection;         // acc . gravity, low-passed (counts^2): up-force * 1 g * |gravity|
+    float _rate[3];              // Gyro counts, low-passed
+
+    // Classification
+    Orientation _state;
+    Orientation _candidate;
+    unsigned long _candidateSince;
+    bool _lifted;
+    bool _liftRising;
+    unsigned long _liftSince;
+    bool _settling;
+    unsigned long _settledSince;
+
+    float cosTilt() const;
+    static float signedSquare(float x) { return x * fabsf(x); }
+};
+
+#endif // ORIENTATION_ESTIMATOR_H
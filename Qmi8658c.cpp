@@ -22,19 +22,8 @@
  */
 
 #include <stdlib.h>
-#include <Wire.h>
 #include <Arduino.h>
-#include "qmi8658c.h"
-
-/* Structure for QMI context */
-typedef struct {
-    uint16_t acc_sensitivity;   // Sensitivity value for the accelerometer.
-    uint8_t acc_scale;          // Scale setting for the accelerometer.
-    uint16_t gyro_sensitivity;  // Sensitivity value for the gyroscope.
-    uint8_t gyro_scale;         // Scale setting for the gyroscope.
-} qmi_ctx_t;
-
-qmi_ctx_t qmi_ctx;  // QMI context instance.
+#include "Qmi8658c.h"
 
 /* Accelerometer sensitivity table */
 uint16_t acc_scale_sensitivity_table[4] = {
@@ -56,109 +45,179 @@ uint16_t gyro_scale_sensitivity_table[8] = {
     GYRO_SCALE_SENSITIVITY_2048DPS    // Sensitivity for ±2048 degrees per second range.
 };
 
+/* FIFO drain chunk: multiple of both frame sizes (6 and 12 bytes) that fits the Wire buffer */
+#define QMI8658_FIFO_CHUNK_LEN      120
+
+/* CTRL9 handshake timeout */
+#define QMI8658_CTRL9_TIMEOUT_MS    10
+
 /*##################################### Functions for i2c communication #################################*/
 
 // Write a byte of data to a register in the QMI8658 device.
 
 void Qmi8658c::qmi8658_write(uint8_t reg, uint8_t value) {
 
-    // Send register address and data to write
-    Wire.beginTransmission(this->deviceAdress);
-    Wire.write(reg);        // Specify the register you want to write to
-    Wire.write(value);      // Write the value to the register
-    Wire.endTransmission(); // End transmission
+    // Send register address and data to write (bounded by the bus layer)
+    this->device.writeReg(reg, value);
 }
 
 // Read a byte of data from a register in the QMI8658 device.
+// Return 0xFF if the transaction failed or timed out.
 
 uint8_t Qmi8658c::qmi8658_read(uint8_t reg) {
 
     uint8_t value;
-    unsigned long startTime;
 
-    // Request data from a specific register
-    Wire.beginTransmission(this->deviceAdress);
-    Wire.write(reg);             // Specify the register you want to read from
-    Wire.endTransmission(false); // Do not release the I2C bus
-    // Request data from the sensor
-    Wire.requestFrom(this->deviceAdress, 1); // Request 1 byte of data
-
-
-    startTime = millis(); // Record the start time
-    // Wait for data to become available
-    while(Wire.available() < 1) {
-        // Wait
-        // timout for breaking the loop
-        if (millis() - startTime > 1000) 
-         return 0xFF;
+    if (!this->device.readRegs(reg, &value, 1)) {
+        return 0xFF;
     }
 
-    // Read data from the register
-    value = Wire.read();
-    Wire.endTransmission();
-  
-  return value;
+    return value;
+}
+
+// Read len consecutive registers starting at reg in a single I2C transaction.
+// Relies on the address auto-increment bit set in CTRL1 by open().
+// Return false if the device did not acknowledge or returned fewer bytes than requested.
+
+bool Qmi8658c::qmi8658_read_burst(uint8_t reg, uint8_t* buf, uint8_t len) {
+
+    return this->device.readRegs(reg, buf, len);
+}
+
+/*##################################### CTRL register shadow ##############################################*/
+
+// Shadowed value of a CTRL register (no bus access).
+
+uint8_t Qmi8658c::ctrl_get(uint8_t reg) const {
+    return this->ctrlShadow[reg - QMI8658_CTRL_SHADOW_FIRST];
+}
+
+// Stage a CTRL register value. Nothing is sent until ctrl_flush(); unchanged values are not re-sent.
+
+void Qmi8658c::ctrl_set(uint8_t reg, uint8_t value) {
+
+    uint8_t idx = reg - QMI8658_CTRL_SHADOW_FIRST;
+
+    if (this->ctrlShadow[idx] == value) {
+        return;
+    }
+
+    this->ctrlShadow[idx] = value;
+    if (this->ctrlDirtyFirst == 0xFF) {
+        this->ctrlDirtyFirst = idx;
+        this->ctrlDirtyLast = idx;
+    } else {
+        if (idx < this->ctrlDirtyFirst) this->ctrlDirtyFirst = idx;
+        if (idx > this->ctrlDirtyLast) this->ctrlDirtyLast = idx;
+    }
+}
+
+// Write the staged span of CTRL registers as one auto-increment burst, so a
+// reconfiguration touching several registers is applied in a single transaction.
+
+bool Qmi8658c::ctrl_flush() {
+
+    uint8_t buf[1 + QMI8658_CTRL_SHADOW_LEN];
+    uint8_t len;
+    bool ok;
+
+    if (this->ctrlDirtyFirst == 0xFF) {
+        return true;
+    }
+
+    len = this->ctrlDirtyLast - this->ctrlDirtyFirst + 1;
+    buf[0] = QMI8658_CTRL_SHADOW_FIRST + this->ctrlDirtyFirst;
+    memcpy(&buf[1], &this->ctrlShadow[this->ctrlDirtyFirst], len);
+
+    ok = this->device.write(buf, 1 + len);
+    this->ctrlDirtyFirst = 0xFF;
+    this->ctrlDirtyLast = 0;
+
+    return ok;
+}
+
+// Reload the whole shadow with one burst read (used after a reset).
+
+bool Qmi8658c::ctrl_sync() {
+
+    this->ctrlDirtyFirst = 0xFF;
+    this->ctrlDirtyLast = 0;
+    return this->qmi8658_read_burst(QMI8658_CTRL_SHADOW_FIRST, this->ctrlShadow, QMI8658_CTRL_SHADOW_LEN);
 }
 
 /* ####################### comman function for accelerometer, gyroscope and magnetometer #################### */
 
-// Set the mode of operation for the QMI8658 device.
+// Set the mode of operation for the QMI8658 device (staged, see ctrl_flush()).
 
 void Qmi8658c::select_mode(qmi8658_mode_t qmi8658_mode ) {
   
-    uint8_t qmi8658_ctrl7_reg = this->qmi8658_read(QMI8658_CTRL7);
-    
-    qmi8658_ctrl7_reg = (0xFC & qmi8658_ctrl7_reg) | qmi8658_mode;
-    this->qmi8658_write(QMI8658_CTRL7,qmi8658_ctrl7_reg);   
+    this->ctrl_set(QMI8658_CTRL7, (0xFC & this->ctrl_get(QMI8658_CTRL7)) | qmi8658_mode);
+    this->ctx.mode = qmi8658_mode;
+}
+
+// Issue a CTRL9 host command and complete the handshake:
+// write command -> wait CmdDone -> write ACK -> wait CmdDone cleared.
+
+bool Qmi8658c::ctrl9_command(uint8_t cmd) {
+
+    unsigned long startTime;
+
+    this->qmi8658_write(QMI8658_CTRL9, cmd);
+
+    startTime = millis();
+    while (!(this->qmi8658_read(QMI8658_STATUSINT) & QMI8658_STATUSINT_CMD_DONE)) {
+        if (millis() - startTime > QMI8658_CTRL9_TIMEOUT_MS)
+            return false;
+    }
+
+    this->qmi8658_write(QMI8658_CTRL9, QMI8658_CTRL_CMD_ACK);
+
+    startTime = millis();
+    while (this->qmi8658_read(QMI8658_STATUSINT) & QMI8658_STATUSINT_CMD_DONE) {
+        if (millis() - startTime > QMI8658_CTRL9_TIMEOUT_MS)
+            return false;
+    }
+
+    return true;
 }
 
 
 /*####################################### Functions for accelerometr #########################################*/
 
-// function to set output data rate of the accelerometer
+// function to set output data rate of the accelerometer (staged, see ctrl_flush())
 
 void Qmi8658c::acc_set_odr(acc_odr_t odr) {
 
-    uint8_t qmi8658_ctrl2_reg = this->qmi8658_read(QMI8658_CTRL2);
-    
-    qmi8658_ctrl2_reg = (0xF0 & qmi8658_ctrl2_reg) | odr;
-    this->qmi8658_write(QMI8658_CTRL2,qmi8658_ctrl2_reg); 
+    this->ctrl_set(QMI8658_CTRL2, (0xF0 & this->ctrl_get(QMI8658_CTRL2)) | odr);
 }
 
-// function to set the scale of the accelerometer
+// function to set the scale of the accelerometer (staged, see ctrl_flush())
 
 void Qmi8658c::acc_set_scale(acc_scale_t acc_scale) {
 
-    uint8_t qmi8658_ctrl2_reg = this->qmi8658_read(QMI8658_CTRL2);
-    qmi_ctx.acc_scale = acc_scale;
-    qmi_ctx.acc_sensitivity = acc_scale_sensitivity_table[acc_scale];
+    this->ctx.acc_scale = acc_scale;
+    this->ctx.acc_sensitivity = acc_scale_sensitivity_table[acc_scale];
     
-    qmi8658_ctrl2_reg = (0x8F & qmi8658_ctrl2_reg) | (acc_scale << 4);
-    this->qmi8658_write(QMI8658_CTRL2,qmi8658_ctrl2_reg);
+    this->ctrl_set(QMI8658_CTRL2, (0x8F & this->ctrl_get(QMI8658_CTRL2)) | (acc_scale << 4));
 }
 
 /*######################################## Functions for gyroscope ##########################################*/
 
-// Set Gyroscope Output Data Rate (ODR)
+// Set Gyroscope Output Data Rate (ODR) (staged, see ctrl_flush())
 
 void Qmi8658c::gyro_set_odr(gyro_odr_t odr){
 
-    uint8_t qmi8658_ctrl3_reg = this->qmi8658_read(QMI8658_CTRL3);
-    
-    qmi8658_ctrl3_reg = (0xF0 & qmi8658_ctrl3_reg) | odr;
-    this->qmi8658_write(QMI8658_CTRL3,qmi8658_ctrl3_reg); 
+    this->ctrl_set(QMI8658_CTRL3, (0xF0 & this->ctrl_get(QMI8658_CTRL3)) | odr);
 }
 
-// Set Gyroscope Full-scale
+// Set Gyroscope Full-scale (staged, see ctrl_flush())
 
 void Qmi8658c::gyro_set_scale(gyro_scale_t gyro_scale) {
 
-    uint8_t qmi8658_ctrl3_reg = this->qmi8658_read(QMI8658_CTRL3);
-    qmi_ctx.gyro_scale = gyro_scale;
-    qmi_ctx.gyro_sensitivity = gyro_scale_sensitivity_table[gyro_scale];
+    this->ctx.gyro_scale = gyro_scale;
+    this->ctx.gyro_sensitivity = gyro_scale_sensitivity_table[gyro_scale];
     
-    qmi8658_ctrl3_reg = (0x8F & qmi8658_ctrl3_reg) | (gyro_scale << 4);
-    this->qmi8658_write(QMI8658_CTRL3,qmi8658_ctrl3_reg);
+    this->ctrl_set(QMI8658_CTRL3, (0x8F & this->ctrl_get(QMI8658_CTRL3)) | (gyro_scale << 4));
 }
 
 
@@ -174,22 +233,35 @@ void Qmi8658c:: qmi_reset(){
 
 /*######################################### constructor function ############################################*/
 
-//Initializes a new instance of the Qmi8658c class with the specified device address and frequency.
+//Initializes a new instance of the Qmi8658c class on the given shared bus with the specified device address.
 
-Qmi8658c::Qmi8658c(uint8_t deviceAdress, uint32_t deviceFrequency) {
-    this->deviceFrequency = deviceFrequency;
+Qmi8658c::Qmi8658c(I2CBus& bus, uint8_t deviceAdress)
+    : device(bus, deviceAdress, "qmi8658") {
     this->deviceAdress = deviceAdress;
 
     // clear context
-    memset(&qmi_ctx, 0, sizeof(qmi_ctx_t));
-    qmi_ctx.acc_scale = acc_scale_2g;
-    qmi_ctx.acc_sensitivity = ACC_SCALE_SENSITIVITY_2G;
-    qmi_ctx.gyro_scale = gyro_scale_16dps;
-    qmi_ctx.gyro_sensitivity = GYRO_SCALE_SENSITIVITY_16DPS;
-
-    // initiate IIC bus
-    Wire.begin(); // start IIC bus
-    Wire.setClock(deviceFrequency);
+    memset(&this->ctx, 0, sizeof(qmi_ctx_t));
+    this->ctx.acc_scale = acc_scale_2g;
+    this->ctx.acc_sensitivity = ACC_SCALE_SENSITIVITY_2G;
+    this->ctx.gyro_scale = gyro_scale_16dps;
+    this->ctx.gyro_sensitivity = GYRO_SCALE_SENSITIVITY_16DPS;
+    this->ctx.mode = qmi8658_mode_dual;
+
+    // shadow is loaded from the device in open()
+    memset(this->ctrlShadow, 0, sizeof(this->ctrlShadow));
+    this->ctrlDirtyFirst = 0xFF;
+    this->ctrlDirtyLast = 0;
+
+    this->fifoCtrl = 0;
+    this->fifoOverflow = false;
+    this->tempRaw = 0;
+    this->tempLastMs = 0;
+    this->tempIntervalMs = QMI8658_TEMP_INTERVAL_MS;
+    this->tempValid = false;
+    this->timestampExt = 0;
+    this->womActive = false;
+    this->womSavedCtrl2 = 0;
+    this->womSavedCtrl7 = 0;
 }
 
 /*######################################### class functions #################################################*/
@@ -206,7 +278,11 @@ qmi8658_result_t Qmi8658c::open(qmi8658_cfg_t* qmi8658_cfg) {
     delay(10); // Wait for reset to complete
     
     // CTRL1: Disable SPI, enable address auto-increment, clear disable-sensor bit
+    // (written directly: the burst accesses below depend on auto-increment)
     this->qmi8658_write(QMI8658_CTRL1, 0x40); // bit 6 = address auto-increment
+
+    // seed the register shadow from the post-reset state
+    this->ctrl_sync();
     
     // set accelerometer and gyroscope scale and ODR   
     this->acc_set_odr(qmi8658_cfg->acc_odr);
@@ -216,7 +292,11 @@ qmi8658_result_t Qmi8658c::open(qmi8658_cfg_t* qmi8658_cfg) {
     
     // Enable sensors in CTRL7 (bit 7 must be set, plus mode bits)
     qmi8658_ctrl7 = 0x80 | qmi8658_cfg->qmi8658_mode; // 0x80 enables the sensor
-    this->qmi8658_write(QMI8658_CTRL7, qmi8658_ctrl7);
+    this->ctrl_set(QMI8658_CTRL7, qmi8658_ctrl7);
+    this->ctx.mode = qmi8658_cfg->qmi8658_mode;
+
+    // CTRL2..CTRL7 in one write
+    this->ctrl_flush();
 
     delay(50); // Allow sensors to start up and stabilize
 
@@ -230,29 +310,371 @@ qmi8658_result_t Qmi8658c::open(qmi8658_cfg_t* qmi8658_cfg) {
     return ret;
 }
 
+// Change mode, ODR and scales at runtime. Only the registers that differ from the
+// shadow are sent, as one burst write. Queued FIFO samples are discarded because
+// their layout or scale may no longer match.
+
+bool Qmi8658c::set_config(qmi8658_cfg_t* qmi8658_cfg) {
+
+    bool ok;
+
+    this->acc_set_odr(qmi8658_cfg->acc_odr);
+    this->acc_set_scale(qmi8658_cfg->acc_scale);
+    this->gyro_set_odr(qmi8658_cfg->gyro_odr);
+    this->gyro_set_scale(qmi8658_cfg->gyro_scale);
+    this->select_mode(qmi8658_cfg->qmi8658_mode);
+
+    ok = this->ctrl_flush();
+
+    if ((this->fifoCtrl & 0x03) != qmi8658_fifo_bypass) {
+        this->fifo_reset();
+    }
+
+    return ok;
+}
+
+// Decode the little-endian 16-bit value whose low byte is register reg from a burst-read output block.
+
+static inline int16_t qmi_raw16(const uint8_t* raw, uint8_t reg) {
+    uint8_t offset = reg - QMI8658_OUTPUT_BLOCK_START;
+    return (int16_t)(((uint16_t)raw[offset + 1] << 8) | raw[offset]);
+}
+
+// Decode three consecutive little-endian axes starting at raw[0] into counts.
+
+static inline void qmi_decode_axes(const uint8_t* raw, int16_t* xyz) {
+    xyz[0] = (int16_t)(((uint16_t)raw[1] << 8) | raw[0]);
+    xyz[1] = (int16_t)(((uint16_t)raw[3] << 8) | raw[2]);
+    xyz[2] = (int16_t)(((uint16_t)raw[5] << 8) | raw[4]);
+}
+
+// True when the cached temperature is older than the refresh period.
+
+bool Qmi8658c::temp_due() const {
+    return !this->tempValid || (millis() - this->tempLastMs) >= this->tempIntervalMs;
+}
+
+// Read TEMP_L/H into the cache (kept unchanged on bus error).
+
+void Qmi8658c::temp_refresh() {
+
+    uint8_t temp_raw[2];
+
+    if (this->qmi8658_read_burst(QMI8658_TEMP_L, temp_raw, sizeof(temp_raw))) {
+        this->tempRaw = (int16_t)(((uint16_t)temp_raw[1] << 8) | temp_raw[0]);
+        this->tempLastMs = millis();
+        this->tempValid = true;
+    }
+}
+
+// Decode TIMESTAMP_L/M/H and extend the 24-bit counter to 32 bits
+// (valid as long as it is read at least once per 2^23 samples).
+
+uint32_t Qmi8658c::timestamp_extend(const uint8_t* raw) {
+
+    uint32_t ts24 = ((uint32_t)raw[2] << 16) | ((uint32_t)raw[1] << 8) | raw[0];
+
+    this->timestampExt += (ts24 - this->timestampExt) & 0x00FFFFFF;
+    return this->timestampExt;
+}
+
+// Read the output registers (time stamp, temperature, accelerometer, gyroscope) in sensor
+// counts and refresh the temperature cache. One burst, so every field belongs to the same
+// sample even when the next one lands mid-read. Return false (raw untouched) on bus error.
+
+bool Qmi8658c::read_raw(qmi_raw_data_t* raw) {
+
+    uint8_t block[QMI8658_OUTPUT_BLOCK_LEN];
+
+    // read TIMESTAMP_L..GYR_Z_H in one transfer instead of 17 single-register reads
+    if (!this->qmi8658_read_burst(QMI8658_OUTPUT_BLOCK_START, block, sizeof(block))) {
+        return false;
+    }
+
+    raw->timestamp = this->timestamp_extend(block);
+    qmi_decode_axes(&block[QMI8658_ACC_X_L - QMI8658_OUTPUT_BLOCK_START], raw->acc);
+    qmi_decode_axes(&block[QMI8658_GYR_X_L - QMI8658_OUTPUT_BLOCK_START], raw->gyro);
+    raw->temperature = qmi_raw16(block, QMI8658_TEMP_L);
+
+    this->tempRaw = raw->temperature;
+    this->tempLastMs = millis();
+    this->tempValid = true;
+
+    return true;
+}
+
+// Read only the accelerometer and gyroscope (12 bytes). Temperature and time stamp are
+// the cached values from the last full read. Return false (raw untouched) on bus error.
+
+bool Qmi8658c::read_raw_motion(qmi_raw_data_t* raw) {
+
+    uint8_t block[QMI8658_MOTION_BLOCK_LEN];
+
+    if (!this->qmi8658_read_burst(QMI8658_MOTION_BLOCK_START, block, sizeof(block))) {
+        return false;
+    }
+
+    qmi_decode_axes(&block[QMI8658_ACC_X_L - QMI8658_MOTION_BLOCK_START], raw->acc);
+    qmi_decode_axes(&block[QMI8658_GYR_X_L - QMI8658_MOTION_BLOCK_START], raw->gyro);
+    raw->temperature = this->tempRaw;
+    raw->timestamp = this->timestampExt;
+
+    return true;
+}
+
+// Convert a sample in counts to g, dps and degrees C using the current scales.
+
+void Qmi8658c::raw_to_data(const qmi_raw_data_t* raw, qmi_data_t* data) const {
+
+    // accelerometer data
+    data->acc_xyz.x = (float)raw->acc[0]/this->ctx.acc_sensitivity;
+    data->acc_xyz.y = (float)raw->acc[1]/this->ctx.acc_sensitivity;
+    data->acc_xyz.z = (float)raw->acc[2]/this->ctx.acc_sensitivity;
+
+    // gyroscope data
+    data->gyro_xyz.x = (float)raw->gyro[0]/this->ctx.gyro_sensitivity;
+    data->gyro_xyz.y = (float)raw->gyro[1]/this->ctx.gyro_sensitivity;
+    data->gyro_xyz.z = (float)raw->gyro[2]/this->ctx.gyro_sensitivity;
+
+    // temperature data
+    data->temperature = (float)raw->temperature/TEMPERATURE_SENSOR_RESOLUTION;
+    data->timestamp = raw->timestamp;
+}
+
 // Read data from the QMI8658 sensor and stores it in the provided data structure.
 
 void Qmi8658c::read(qmi_data_t* data) {
 
-    // read accelerometer data
-    int16_t acc_x = (((int16_t)this->qmi8658_read(QMI8658_ACC_X_H) << 8) | this->qmi8658_read(QMI8658_ACC_X_L));
-    int16_t acc_y = (((int16_t)this->qmi8658_read(QMI8658_ACC_Y_H) << 8) | this->qmi8658_read(QMI8658_ACC_Y_L));
-    int16_t acc_z = (((int16_t)this->qmi8658_read(QMI8658_ACC_Z_H) << 8) | this->qmi8658_read(QMI8658_ACC_Z_L));
-    data->acc_xyz.x = (float)acc_x/qmi_ctx.acc_sensitivity;
-    data->acc_xyz.y = (float)acc_y/qmi_ctx.acc_sensitivity;
-    data->acc_xyz.z = (float)acc_z/qmi_ctx.acc_sensitivity;
+    qmi_raw_data_t raw;
+
+    if (!this->read_raw(&raw)) {
+        return; // keep previous sample on bus error
+    }
+
+    this->raw_to_data(&raw, data);
+}
+
+/*######################################### FIFO functions ##################################################*/
+
+// Nominal sample period of an accelerometer ODR setting, in microseconds (0 for reserved values).
 
-    // read gyroscope data
-    int16_t rot_x = (((int16_t)this->qmi8658_read(QMI8658_GYR_X_H) << 8) | this->qmi8658_read(QMI8658_GYR_X_L));
-    int16_t rot_y = (((int16_t)this->qmi8658_read(QMI8658_GYR_Y_H) << 8) | this->qmi8658_read(QMI8658_GYR_Y_L));
-    int16_t rot_z = (((int16_t)this->qmi8658_read(QMI8658_GYR_Z_H) << 8) | this->qmi8658_read(QMI8658_GYR_Z_L));
-    data->gyro_xyz.x = (float)rot_x/qmi_ctx.gyro_sensitivity;
-    data->gyro_xyz.y = (float)rot_y/qmi_ctx.gyro_sensitivity;
-    data->gyro_xyz.z = (float)rot_z/qmi_ctx.gyro_sensitivity;
+uint32_t Qmi8658c::acc_odr_period_us(acc_odr_t odr) {
+    return ((uint8_t)odr < QMI8658_ACC_ODR_COUNT) ? QMI8658_ACC_ODR_PERIOD_US[odr] : 0;
+}
+
+// Bytes per FIFO sample: 6 per enabled sensor, accelerometer first.
 
-    // read temperature data
-    int16_t temp = (((int16_t)this->qmi8658_read(QMI8658_TEMP_H) << 8) | this->qmi8658_read(QMI8658_TEMP_L));
-    data->temperature = (float)temp/TEMPERATURE_SENSOR_RESOLUTION;
+uint8_t Qmi8658c::fifo_frame_len() const {
+    return (this->ctx.mode == qmi8658_mode_dual) ? 12 : 6;
+}
+
+// Configure FIFO mode, depth and watermark. Sensors are paused while the FIFO is reconfigured.
+
+void Qmi8658c::fifo_config(qmi8658_fifo_mode_t mode, qmi8658_fifo_size_t size, uint8_t watermark) {
+
+    uint8_t qmi8658_ctrl7_reg = this->ctrl_get(QMI8658_CTRL7);
+    this->ctrl_set(QMI8658_CTRL7, qmi8658_ctrl7_reg & 0xFC);
+    this->ctrl_flush();
+
+    this->fifoCtrl = ((uint8_t)size << 2) | (uint8_t)mode;
+    this->qmi8658_write(QMI8658_FIFO_WTM_TH, watermark);
+    this->qmi8658_write(QMI8658_FIFO_CTRL, this->fifoCtrl);
+
+    this->ctrl_set(QMI8658_CTRL7, qmi8658_ctrl7_reg);
+    this->ctrl_flush();
+    this->fifo_reset();
+}
+
+// Discard all queued FIFO samples.
+
+void Qmi8658c::fifo_reset() {
+    this->ctrl9_command(QMI8658_CTRL_CMD_RST_FIFO);
+    this->fifoOverflow = false;
+}
+
+// Number of complete samples queued in the FIFO. Also latches the overflow flag.
+
+uint16_t Qmi8658c::fifo_count() {
+
+    uint8_t cnt[2];
+
+    if ((this->fifoCtrl & 0x03) == qmi8658_fifo_bypass) {
+        return 0;
+    }
+
+    // FIFO_SMPL_CNT and FIFO_STATUS are adjacent: read both in one transfer
+    if (!this->qmi8658_read_burst(QMI8658_FIFO_SMPL_CNT, cnt, sizeof(cnt))) {
+        return 0;
+    }
+
+    if (cnt[1] & QMI8658_FIFO_STATUS_OVFLOW) {
+        this->fifoOverflow = true;
+    }
+
+    // count is expressed in 2-byte words
+    uint16_t bytes = (((uint16_t)(cnt[1] & 0x03) << 8) | cnt[0]) * 2;
+    return bytes / this->fifo_frame_len();
+}
+
+// Drain up to max_samples queued samples into samples[], oldest first.
+// The FIFO does not store temperature: the cached value is used, refreshed when due.
+// Nor does it store time stamps: they are reconstructed backwards from TIMESTAMP,
+// which belongs to the newest queued sample.
+// Return the number of samples decoded.
+
+uint16_t Qmi8658c::fifo_read(qmi_raw_data_t* samples, uint16_t max_samples) {
+
+    uint8_t chunk[QMI8658_FIFO_CHUNK_LEN];
+    uint8_t frame_len = this->fifo_frame_len();
+    uint16_t available, queued, done = 0;
+    uint8_t ts_raw[3];
+    uint32_t first_ts;
+
+    this->fifoOverflow = false;
+    available = this->fifo_count();
+    if (available == 0) {
+        return 0;
+    }
+    queued = (available > max_samples) ? max_samples : available;
+
+    if (!this->qmi8658_read_burst(QMI8658_TIMESTAMP_L, ts_raw, sizeof(ts_raw))) {
+        return 0;
+    }
+    first_ts = this->timestamp_extend(ts_raw) - (available - 1);
+
+    if (this->temp_due()) {
+        this->temp_refresh();
+    }
+
+    if (!this->ctrl9_command(QMI8658_CTRL_CMD_REQ_FIFO)) {
+        return 0;
+    }
+
+    while (done < queued) {
+        uint16_t frames = queued - done;
+        if (frames > QMI8658_FIFO_CHUNK_LEN / frame_len) {
+            frames = QMI8658_FIFO_CHUNK_LEN / frame_len;
+        }
+
+        if (!this->qmi8658_read_burst(QMI8658_FIFO_DATA, chunk, frames * frame_len)) {
+            break;
+        }
+
+        for (uint16_t i = 0; i < frames; i++) {
+            const uint8_t* frame = &chunk[i * frame_len];
+            qmi_raw_data_t* data = &samples[done + i];
+
+            memset(data, 0, sizeof(qmi_raw_data_t));
+            if (this->ctx.mode != qmi8658_mode_gyro_only) {
+                qmi_decode_axes(frame, data->acc);
+                frame += 6;
+            }
+            if (this->ctx.mode != qmi8658_mode_acc_only) {
+                qmi_decode_axes(frame, data->gyro);
+            }
+            data->temperature = this->tempRaw;
+            data->timestamp = first_ts + done + i;
+        }
+        done += frames;
+    }
+
+    // leave FIFO read mode (clears FIFO_CTRL bit 7)
+    this->qmi8658_write(QMI8658_FIFO_CTRL, this->fifoCtrl);
+
+    return done;
+}
+
+/*######################################### Interrupt functions #############################################*/
+
+// Enable interrupt output on int_line (1 or 2).
+// With the FIFO enabled the watermark interrupt is routed to that line;
+// in bypass mode the data-ready signal is only available on INT2.
+
+void Qmi8658c::int_enable(uint8_t int_line) {
+
+    uint8_t qmi8658_ctrl1_reg = this->ctrl_get(QMI8658_CTRL1);
+
+    qmi8658_ctrl1_reg &= ~(QMI8658_CTRL1_INT1_EN | QMI8658_CTRL1_INT2_EN | QMI8658_CTRL1_FIFO_INT_SEL);
+    if (int_line == 1) {
+        qmi8658_ctrl1_reg |= QMI8658_CTRL1_INT1_EN | QMI8658_CTRL1_FIFO_INT_SEL;
+    } else {
+        qmi8658_ctrl1_reg |= QMI8658_CTRL1_INT2_EN;
+    }
+    this->ctrl_set(QMI8658_CTRL1, qmi8658_ctrl1_reg);
+    this->ctrl_flush();
+}
+
+// Disable both interrupt pins.
+
+void Qmi8658c::int_disable() {
+
+    this->ctrl_set(QMI8658_CTRL1, this->ctrl_get(QMI8658_CTRL1) & ~(QMI8658_CTRL1_INT1_EN | QMI8658_CTRL1_INT2_EN));
+    this->ctrl_flush();
+}
+
+/*######################################### Wake-on-Motion functions ########################################*/
+
+// Arm the Wake-on-Motion engine: gyroscope off, accelerometer at a low-power odr,
+// interrupt on int_line (initial level low) when any axis exceeds threshold_mg.
+// blanking_samples accelerometer samples are ignored after arming to avoid a spurious wake.
+
+bool Qmi8658c::wom_enable(uint8_t threshold_mg, uint8_t int_line, uint8_t blanking_samples, acc_odr_t odr) {
+
+    if (this->womActive) {
+        return true;
+    }
+
+    this->womSavedCtrl2 = this->ctrl_get(QMI8658_CTRL2);
+    this->womSavedCtrl7 = this->ctrl_get(QMI8658_CTRL7);
+
+    // sensors must be disabled while WoM is configured
+    this->ctrl_set(QMI8658_CTRL2, (this->womSavedCtrl2 & 0xF0) | odr);
+    this->ctrl_set(QMI8658_CTRL7, this->womSavedCtrl7 & 0xFC);
+    this->ctrl_flush();
+
+    // CAL1_L: threshold (1 mg/LSB), CAL1_H: [7:6] pin select + initial level, [5:0] blanking
+    this->qmi8658_write(QMI8658_CAL1_L, threshold_mg);
+    this->qmi8658_write(QMI8658_CAL1_H, ((int_line == 1) ? 0x80 : 0x00) | (blanking_samples & 0x3F));
+    if (!this->ctrl9_command(QMI8658_CTRL_CMD_WRITE_WOM_SETTING)) {
+        this->ctrl_set(QMI8658_CTRL2, this->womSavedCtrl2);
+        this->ctrl_set(QMI8658_CTRL7, this->womSavedCtrl7);
+        this->ctrl_flush();
+        return false;
+    }
+
+    // CTRL1 (interrupt pin) and CTRL7 (accelerometer on) in one write
+    this->ctrl_set(QMI8658_CTRL1, this->ctrl_get(QMI8658_CTRL1) | ((int_line == 1) ? QMI8658_CTRL1_INT1_EN : QMI8658_CTRL1_INT2_EN));
+    this->ctrl_set(QMI8658_CTRL7, (this->womSavedCtrl7 & 0xFC) | qmi8658_mode_acc_only);
+    this->ctrl_flush();
+    this->ctx.mode = qmi8658_mode_acc_only;
+    this->womActive = true;
+
+    return true;
+}
+
+// Disarm Wake-on-Motion (zero threshold) and restore CTRL2/CTRL7 as they were before wom_enable().
+
+bool Qmi8658c::wom_disable() {
+
+    bool ok;
+
+    if (!this->womActive) {
+        return true;
+    }
+
+    this->ctrl_set(QMI8658_CTRL7, this->womSavedCtrl7 & 0xFC);
+    this->ctrl_flush();
+    this->qmi8658_write(QMI8658_CAL1_L, 0);
+    this->qmi8658_write(QMI8658_CAL1_H, 0);
+    ok = this->ctrl9_command(QMI8658_CTRL_CMD_WRITE_WOM_SETTING);
+
+    this->ctrl_set(QMI8658_CTRL2, this->womSavedCtrl2);
+    this->ctrl_set(QMI8658_CTRL7, this->womSavedCtrl7);
+    this->ctrl_flush();
+    this->ctx.mode = this->womSavedCtrl7 & 0x03;
+    this->womActive = false;
+
+    return ok;
 }
 
 // Close communication with the QMI8658 sensor.
@@ -262,16 +684,14 @@ qmi8658_result_t Qmi8658c::close() {
     uint8_t qmi8658_ctrl7_reg, qmi8658_ctrl1_reg;
     qmi8658_result_t ret;
   
-    qmi8658_ctrl7_reg = this->qmi8658_read(QMI8658_CTRL7);
-  
     // disable accelerometer, gyroscope, magnetometer and attitude engine
-    qmi8658_ctrl7_reg &= 0xF0; 
-    this->qmi8658_write(QMI8658_CTRL7,qmi8658_ctrl7_reg);
+    this->ctrl_set(QMI8658_CTRL7, this->ctrl_get(QMI8658_CTRL7) & 0xF0);
   
     // disable sensor by turning off the internal 2 MHz oscillator 
-    qmi8658_ctrl1_reg = this->qmi8658_read(QMI8658_CTRL1);
-    qmi8658_ctrl1_reg |= (1 << 0); 
-    this->qmi8658_write(QMI8658_CTRL1,qmi8658_ctrl1_reg);
+    this->ctrl_set(QMI8658_CTRL1, this->ctrl_get(QMI8658_CTRL1) | (1 << 0));
+
+    // CTRL1..CTRL7 in one write
+    this->ctrl_flush();
 
     // read these two registers
     qmi8658_ctrl7_reg = this->qmi8658_read(QMI8658_CTRL7);
@@ -16,6 +16,7 @@
 #define QMI8658C_H
 
 #include <Arduino.h>
+#include "I2CBus.h"
 
 /* General purpose registers */
 #define QMI8658_WHO_AM_I    0x00  // WHO_AM_I register address.
@@ -29,10 +30,48 @@
 #define QMI8658_CTRL5       0x06  // Control register 5 address.
 #define QMI8658_CTRL6       0x07  // Control register 6 address.
 #define QMI8658_CTRL7       0x08  // Control register 7 address.
+#define QMI8658_CTRL8       0x09  // Control register 8 address.
 #define QMI8658_CTRL9       0x0A  // Control register 9 address.
 
+/* Host calibration registers (CTRL9 command arguments) */
+#define QMI8658_CAL1_L      0x0B  // Calibration register 1 low byte.
+#define QMI8658_CAL1_H      0x0C  // Calibration register 1 high byte.
+
+/* FIFO registers */
+#define QMI8658_FIFO_WTM_TH     0x13  // FIFO watermark level, in ODR samples.
+#define QMI8658_FIFO_CTRL       0x14  // FIFO mode, size and read-mode control.
+#define QMI8658_FIFO_SMPL_CNT   0x15  // FIFO sample count LSB (count is in 2-byte words).
+#define QMI8658_FIFO_STATUS     0x16  // FIFO status flags and sample count MSB (bits 1:0).
+#define QMI8658_FIFO_DATA       0x17  // FIFO data output (address does not auto-increment).
+
+/* Status registers */
+#define QMI8658_STATUSINT       0x2D  // Sensor data / CTRL9 command status.
+#define QMI8658_STATUS0         0x2E  // Output data overrun and availability.
+#define QMI8658_STATUS1         0x2F  // Miscellaneous status (motion engines).
+
+/* CTRL9 host commands */
+#define QMI8658_CTRL_CMD_ACK        0x00  // Acknowledge a completed CTRL9 command.
+#define QMI8658_CTRL_CMD_RST_FIFO   0x04  // Reset the FIFO.
+#define QMI8658_CTRL_CMD_REQ_FIFO   0x05  // Enter FIFO read mode.
+#define QMI8658_CTRL_CMD_WRITE_WOM_SETTING 0x08  // Apply Wake-on-Motion settings from CAL1.
+
+#define QMI8658_STATUSINT_CMD_DONE  0x80  // STATUSINT bit 7: CTRL9 command done.
+#define QMI8658_FIFO_CTRL_RD_MODE   0x80  // FIFO_CTRL bit 7: FIFO read mode active.
+#define QMI8658_FIFO_STATUS_OVFLOW  0x20  // FIFO_STATUS bit 5: FIFO overflowed.
+#define QMI8658_STATUS1_WOM         0x04  // STATUS1 bit 2: Wake-on-Motion event.
+
+/* CTRL1 interrupt bits */
+#define QMI8658_CTRL1_INT2_EN       0x10  // CTRL1 bit 4: enable INT2 pin output.
+#define QMI8658_CTRL1_INT1_EN       0x08  // CTRL1 bit 3: enable INT1 pin output.
+#define QMI8658_CTRL1_FIFO_INT_SEL  0x04  // CTRL1 bit 2: FIFO interrupt on INT1 (set) or INT2 (clear).
+
 /* Data output registers */
 
+// Sample time stamp (24-bit sample counter, increments once per output sample)
+#define QMI8658_TIMESTAMP_L 0x30  // Sample time stamp low byte.
+#define QMI8658_TIMESTAMP_M 0x31  // Sample time stamp middle byte.
+#define QMI8658_TIMESTAMP_H 0x32  // Sample time stamp high byte.
+
 // Accelerometer
 #define QMI8658_ACC_X_L     0x35  // Accelerometer X-axis low byte.
 #define QMI8658_ACC_X_H     0x36  // Accelerometer X-axis high byte.
@@ -53,6 +92,17 @@
 #define QMI8658_TEMP_L      0x33  // Temperature sensor low byte.
 #define QMI8658_TEMP_H      0x34  // Temperature sensor high byte.
 
+/* Output block: TIMESTAMP_L..GYR_Z_H are contiguous and can be burst-read with CTRL1 auto-increment.
+   TEMP_L/H sit between the time stamp and the accelerometer, so a sample with its time stamp
+   always carries a fresh temperature at no extra transaction. */
+#define QMI8658_OUTPUT_BLOCK_START  QMI8658_TIMESTAMP_L                         // First register of the output block.
+#define QMI8658_OUTPUT_BLOCK_LEN    (QMI8658_GYR_Z_H - QMI8658_TIMESTAMP_L + 1) // 17 bytes: time stamp, temp, acc xyz, gyro xyz.
+#define QMI8658_MOTION_BLOCK_START  QMI8658_ACC_X_L                             // Motion-only block skips time stamp and temperature.
+#define QMI8658_MOTION_BLOCK_LEN    (QMI8658_GYR_Z_H - QMI8658_ACC_X_L + 1)     // 12 bytes: acc xyz, gyro xyz.
+
+/* Temperature changes slowly: in FIFO mode it is refreshed at most this often and cached in between */
+#define QMI8658_TEMP_INTERVAL_MS    5000
+
 /* Soft reset register */
 #define QMI8658_RESET       0x60  // Soft reset register address.
 
@@ -93,6 +143,14 @@ typedef enum {
     acc_odr_3,         // Accelerometer ODR set to 3 Hz.
 } acc_odr_t;
 
+/* Accelerometer ODR period table (us), indexed by acc_odr_t (constexpr: also used to design filters at compile time) */
+#define QMI8658_ACC_ODR_COUNT 16
+static constexpr uint32_t QMI8658_ACC_ODR_PERIOD_US[QMI8658_ACC_ODR_COUNT] = {
+    125, 250, 500, 1000, 2000, 4000, 8000, 16000, 32000,   // acc_odr_8000 .. acc_odr_31_25
+    0, 0, 0,                                               // reserved
+    7813, 47619, 90909, 333333                             // acc_odr_128 .. acc_odr_3 (low power)
+};
+
 /* Enum representing the output data rate (ODR) settings for the gyroscope */
 typedef enum {
     gyro_odr_8000,     // Gyroscope ODR set to 8000 Hz.
@@ -145,8 +203,17 @@ typedef struct {
     acc_axes_t  acc_xyz;       // Accelerometer data in three axes (x, y, z).
     gyro_axes_t gyro_xyz;      // Gyroscope data in three axes (x, y, z).
     float temperature;         // Temperature reading from Qmi8658c.
+    uint32_t timestamp;        // Sensor sample counter (one count per output sample).
 } qmi_data_t;
 
+/* Struct representing one sample in raw sensor counts (LSB), as stored by the device */
+typedef struct {
+    int16_t acc[3];            // Accelerometer x, y, z (acc_sensitivity() LSB per g).
+    int16_t gyro[3];           // Gyroscope x, y, z (gyro_sensitivity() LSB per dps).
+    int16_t temperature;       // Temperature (TEMPERATURE_SENSOR_RESOLUTION LSB per degree C).
+    uint32_t timestamp;        // Sensor sample counter (24-bit register extended to 32 bits).
+} qmi_raw_data_t;
+
 /* Enum representing the mode of operation for Qmi8658c */
 typedef enum {
     qmi8658_mode_acc_only = 1,   // Mode for accelerometer-only operation.
@@ -154,6 +221,21 @@ typedef enum {
     qmi8658_mode_dual,           // Mode for dual accelerometer and gyroscope operation.
 } qmi8658_mode_t;
 
+/* Enum representing the FIFO operating mode */
+typedef enum {
+    qmi8658_fifo_bypass = 0,     // FIFO disabled, output registers only.
+    qmi8658_fifo_fifo,           // FIFO stops collecting when full.
+    qmi8658_fifo_stream,         // FIFO discards the oldest sample when full.
+} qmi8658_fifo_mode_t;
+
+/* Enum representing the FIFO depth, in samples */
+typedef enum {
+    qmi8658_fifo_size_16 = 0,    // 16 samples.
+    qmi8658_fifo_size_32,        // 32 samples.
+    qmi8658_fifo_size_64,        // 64 samples.
+    qmi8658_fifo_size_128,       // 128 samples.
+} qmi8658_fifo_size_t;
+
 /* Qmi8658 config */
 
 /* Struct representing the configuration settings for Qmi8658c */
@@ -165,6 +247,20 @@ typedef struct {
     gyro_odr_t gyro_odr;            // Output data rate (ODR) setting for the gyroscope.
 } qmi8658_cfg_t;
 
+/* Struct representing the per-instance conversion context */
+typedef struct {
+    uint16_t acc_sensitivity;   // Sensitivity value for the accelerometer.
+    uint8_t acc_scale;          // Scale setting for the accelerometer.
+    uint16_t gyro_sensitivity;  // Sensitivity value for the gyroscope.
+    uint8_t gyro_scale;         // Scale setting for the gyroscope.
+    uint8_t mode;               // Enabled sensors (qmi8658_mode_t).
+} qmi_ctx_t;
+
+/* Shadowed configuration registers: CTRL1..CTRL8 (CTRL9 is a command register and is never cached) */
+#define QMI8658_CTRL_SHADOW_FIRST   QMI8658_CTRL1
+#define QMI8658_CTRL_SHADOW_LAST    QMI8658_CTRL8
+#define QMI8658_CTRL_SHADOW_LEN     (QMI8658_CTRL_SHADOW_LAST - QMI8658_CTRL_SHADOW_FIRST + 1)
+
 /* Enum representing the result of an operation with Qmi8658c */
 typedef enum {
     qmi8658_result_open_success,   // Operation to open communication with Qmi8658c was successful.
@@ -182,19 +278,67 @@ public:
     
 private:
     uint8_t deviceAdress;                                     // Device address of the Qmi8658c.
-    uint16_t deviceFrequency;                                 // Frequency of the Qmi8658c.
+    I2CDevice device;                                         // Bounded transactions and statistics on the shared bus.
+    qmi_ctx_t ctx;                                            // Scale, sensitivity and mode of this instance.
+    uint8_t ctrlShadow[QMI8658_CTRL_SHADOW_LEN];              // Last values written to CTRL1..CTRL8.
+    uint8_t ctrlDirtyFirst;                                   // First shadow register awaiting write (0xFF = clean).
+    uint8_t ctrlDirtyLast;                                    // Last shadow register awaiting write.
+    uint8_t fifoCtrl;                                         // Last FIFO_CTRL value written (mode and size).
+    bool fifoOverflow;                                        // FIFO overflow seen on the last drain.
+    int16_t tempRaw;                                          // Cached temperature (counts).
+    uint32_t tempLastMs;                                      // millis() of the last temperature read.
+    uint32_t tempIntervalMs;                                  // Temperature refresh period.
+    bool tempValid;                                           // tempRaw has been read at least once.
+    uint32_t timestampExt;                                    // Last sample counter, extended past 24 bits.
+    bool womActive;                                           // Wake-on-Motion armed.
+    uint8_t womSavedCtrl2;                                    // CTRL2 before Wake-on-Motion was armed.
+    uint8_t womSavedCtrl7;                                    // CTRL7 before Wake-on-Motion was armed.
     
 public:
-    Qmi8658c(uint8_t deviceAdress, uint32_t deviceFrequency); // Constructor for Qmi8658c class.
+    Qmi8658c(I2CBus& bus, uint8_t deviceAdress);              // Constructor for Qmi8658c class (bus must be begun before open()).
     qmi8658_result_t open(qmi8658_cfg_t* qmi8658_cfg);        // Open communication with the Qmi8658c and configures it.
     void read(qmi_data_t* data);                              // Read data from the Qmi8658c.
+    bool read_raw(qmi_raw_data_t* raw);                       // Read time stamp, temperature and motion data in counts.
+    bool read_raw_motion(qmi_raw_data_t* raw);                // Read motion data only; temperature and time stamp are cached.
+    float temperature(void) const { return (float)tempRaw/TEMPERATURE_SENSOR_RESOLUTION; } // Cached temperature (degrees C).
+    void temp_set_interval(uint32_t interval_ms) { tempIntervalMs = interval_ms; } // Temperature refresh period.
+    void raw_to_data(const qmi_raw_data_t* raw, qmi_data_t* data) const; // Convert counts to g, dps and degrees C.
+    uint16_t acc_sensitivity(void) const { return ctx.acc_sensitivity; }   // Accelerometer LSB per g at the current scale.
+    uint16_t gyro_sensitivity(void) const { return ctx.gyro_sensitivity; } // Gyroscope LSB per dps at the current scale.
+    bool set_config(qmi8658_cfg_t* qmi8658_cfg);              // Change mode/ODR/scale at runtime in a single write.
     qmi8658_result_t close(void);                             // Close communication with the Qmi8658c.
     char* resultToString(qmi8658_result_t result);            // Convert a qmi8658_result_t enum value into a corresponding string representation.
+    const I2CDevice& getI2CDevice(void) const { return device; } // Bus statistics for this device.
+
+    static uint32_t acc_odr_period_us(acc_odr_t odr);         // Nominal sample period for an accelerometer ODR setting.
+
+    void fifo_config(qmi8658_fifo_mode_t mode, qmi8658_fifo_size_t size, uint8_t watermark); // Configure the FIFO (bypass disables it).
+    void fifo_reset(void);                                    // Discard all samples queued in the FIFO.
+    uint16_t fifo_count(void);                                // Number of complete samples queued in the FIFO.
+    uint16_t fifo_read(qmi_raw_data_t* samples, uint16_t max_samples); // Drain up to max_samples queued samples (counts), oldest first.
+    bool fifo_overflowed(void) const { return fifoOverflow; } // True if samples were lost since the last drain.
+
+    void int_enable(uint8_t int_line);                        // Route FIFO watermark / data-ready to INT1 or INT2.
+    void int_disable(void);                                   // Disable both interrupt pins.
+
+    bool wom_enable(uint8_t threshold_mg, uint8_t int_line, uint8_t blanking_samples, acc_odr_t odr); // Arm Wake-on-Motion (accelerometer only).
+    bool wom_disable(void);                                   // Disarm Wake-on-Motion and restore the previous configuration.
+    bool wom_active(void) const { return womActive; }         // True while Wake-on-Motion is armed.
 
 private:
     void qmi8658_write(uint8_t reg,uint8_t value);            // Write a value to a register of the Qmi8658c.    
     uint8_t qmi8658_read(uint8_t reg);                        // Read a value from a register of the Qmi8658c.   
+    bool qmi8658_read_burst(uint8_t reg, uint8_t* buf, uint8_t len); // Read consecutive registers in one I2C transaction.
+    bool ctrl9_command(uint8_t cmd);                          // Run a CTRL9 host command and wait for its handshake.
+    uint8_t fifo_frame_len(void) const;                       // Bytes per FIFO sample for the active mode.
     void qmi_reset(void);                                     // Reset the Qmi8658c.
+    bool temp_due(void) const;                                // True when the cached temperature is stale.
+    void temp_refresh(void);                                  // Read TEMP_L/H into the cache.
+    uint32_t timestamp_extend(const uint8_t* raw);            // Decode TIMESTAMP_L/M/H and extend it to 32 bits.
+    uint8_t ctrl_get(uint8_t reg) const;                      // Shadowed value of a CTRL register.
+    void ctrl_set(uint8_t reg, uint8_t value);                // Stage a CTRL register write in the shadow.
+    bool ctrl_flush(void);                                    // Write all staged CTRL registers in one transaction.
+    bool ctrl_sync(void);                                     // Reload the shadow from the device (after reset).
     void select_mode(qmi8658_mode_t qmi8658_mode);            // Select the mode of the Qmi8658c.
     void acc_set_odr(acc_odr_t odr);                          // Set the output data rate (ODR) for the accelerometer.
     void acc_set_scale(acc_scale_t acc_scale);                // Set the scale for the accelerometer.
@@ -1,5 +1,7 @@
 #include "SmartLightController.h"
 #include "config.h"
+#include <esp_sleep.h>
+#include <driver/gpio.h>
 
 SmartLightController::SmartLightController(
     MotionDetector& motionDetector,
@@ -20,10 +22,34 @@ SmartLightController::SmartLightController(
     , _manualOverride(false)
     , _lightSensorBypass(false)
     , _movementBypass(false)
+    , _bladeGate(DEFAULT_BLADE_GATE)
     , _timeWindowEnabled(false)
     , _timeWindowInverted(false)
     , _timeWindowStart(DEFAULT_TIME_WINDOW_START)
     , _timeWindowEnd(DEFAULT_TIME_WINDOW_END)
+    , _lowPowerEnabled(DEFAULT_LOW_POWER_ENABLED)
+    , _lastActivityTime(0)
+    , _lastWakeTime(0)
+    , _totalSleepMs(0)
+    , _sleepCount(0)
+    , _wakeFromMotion(false)
+    , _wakeTimeUs(0)
+    , _wakeToMotionUs(0)
+    , _wakeToLedOnUs(0)
+    , _solarValid(false)
+    , _solarPhase(SolarCalculator::Phase::DAY)
+    , _solarSensing(false)
+    , _lastSolarCheck(0)
+    , _probeState(ProbeState::IDLE)
+    , _probeBrightness(0)
+    , _probeRestore(0)
+    , _probeStepTime(0)
+    , _probeMeasurements(0)
+    , _probeLuxOn(0.0f)
+    , _selfLightProbed(false)
+    , _orientation(MotionDetector::Orientation::UPRIGHT)
+    , _warningBlinkOn(false)
+    , _warningBlinkTime(0)
 {
 }
 
@@ -47,9 +73,26 @@ void SmartLightController::begin(unsigned long shutoffDelayMs) {
     
     // Force LED off at startup
     _ledController.turnOff();
+    
+    _solar.setLocation(SOLAR_LATITUDE, SOLAR_LONGITUDE);
+    _lastSolarCheck = 0;
+    updateSolarSchedule();
 }
 
 void SmartLightController::update() {
+    updateSolarSchedule();
+    
+    // The probe owns the strip until it finishes (bounded by its timeout)
+    if (_probeState != ProbeState::IDLE) {
+        updateSelfLightProbe();
+        return;
+    }
+    
+    // Lifted / tipped / upside down: logged always, overrides the automatic logic
+    if (handleOrientation()) {
+        return;
+    }
+    
     // If manual override is active, don't update automatically
     if (_manualOverride || !_autoModeEnabled) {
         return;
@@ -67,19 +110,235 @@ void SmartLightController::update() {
             handleStateCountdown();
             break;
     }
+    
+    handleLowPower();
+}
+
+bool SmartLightController::handleOrientation() {
+    MotionDetector::Orientation orientation = _motionDetector.getOrientation();
+    bool automatic = !_manualOverride && _autoModeEnabled;
+    
+    if (orientation != _orientation) {
+        MotionDetector::Orientation previous = _orientation;
+        _orientation = orientation;
+        
+        if (automatic) {
+            // Strip off first (logs the LED OFF event if it was on)
+            transitionTo(State::OFF);
+            if (previous != MotionDetector::Orientation::UPRIGHT) {
+                _ledController.turnOff();  // End of a warning blink
+            }
+        }
+        
+        if (_eventLogger) {
+            _eventLogger->logOrientation(OrientationEstimator::toString(orientation), _lastLEDState,
+                                        _lightSensor.getLastLux(), _motionDetector.isMoving(),
+                                        automatic ? "auto" : "manual");
+        }
+        _warningBlinkOn = false;
+        _warningBlinkTime = millis();
+    }
+    
+    if (orientation == MotionDetector::Orientation::UPRIGHT || !automatic) {
+        return false;
+    }
+    
+    if (ORIENTATION_WARNING_BLINK) {
+        unsigned long now = millis();
+        if (now - _warningBlinkTime >= ORIENTATION_WARNING_PERIOD_MS) {
+            _warningBlinkTime = now;
+            _warningBlinkOn = !_warningBlinkOn;
+            _ledController.setBrightness(_warningBlinkOn ? ORIENTATION_WARNING_BRIGHTNESS : 0);
+        }
+    }
+    return true;
+}
+
+void SmartLightController::updateSolarSchedule() {
+    unsigned long now = millis();
+    
+    // The phase changes slowly: re-evaluate it periodically, not every loop
+    if (SOLAR_MODE != 0 && (_lastSolarCheck == 0 || now - _lastSolarCheck >= SOLAR_CHECK_INTERVAL_MS)) {
+        _lastSolarCheck = now ? now : 1;
+        time_t t = time(nullptr);
+        _solarValid = _solar.update(t);
+        if (_solarValid) {
+            _solarPhase = _solar.getPhase(t);
+            _solarSensing = _solar.minutesFromTwilight(t) <= SOLAR_SENSING_MARGIN_MIN;
+        }
+    }
+    
+    // Gate mode: lux only near twilight (the self-illumination probe needs readings too)
+    bool gated = (SOLAR_MODE == 1) && _solarValid && !_solarSensing && _probeState == ProbeState::IDLE;
+    _lightSensor.setSamplingEnabled(!gated);
+}
+
+bool SmartLightController::isNightCondition() const {
+    if (_lightSensorBypass) {
+        return true;
+    }
+    
+    bool solarNight = _solarValid && _solarPhase != SolarCalculator::Phase::DAY;
+    if (!_lightSensor.isReady()) {
+        // Sensor failed: the schedule alone, or lights allowed without a clock (fail-safe)
+        return _solarValid ? solarNight : true;
+    }
+    if (!_solarValid || SOLAR_MODE == 0 || _solarSensing) {
+        return _lightSensor.isNight();
+    }
+    
+    // Away from twilight: the schedule decides (gate), or must agree with the sensor (confirm)
+    return (SOLAR_MODE == 1) ? solarNight : (solarNight && _lightSensor.isNight());
+}
+
+bool SmartLightController::startSelfLightProbe() {
+    if (_probeState != ProbeState::IDLE || !_lightSensor.isReady()) {
+        return false;
+    }
+    
+    // Probe at the current level if the strip is on, so it only blinks off once
+    _probeRestore = _ledController.getBrightness();
+    _probeBrightness = _probeRestore ? _probeRestore : SELF_LIGHT_PROBE_BRIGHTNESS;
+    _ledController.setBrightness(_probeBrightness);
+    startProbeStep(ProbeState::LED_ON);
+    return true;
+}
+
+void SmartLightController::startProbeStep(ProbeState state) {
+    _probeState = state;
+    _probeStepTime = millis();
+    _probeMeasurements = _lightSensor.getMeasurementCount();
+    _lightSensor.requestReading();
+}
+
+void SmartLightController::updateSelfLightProbe() {
+    if (millis() - _probeStepTime > SELF_LIGHT_PROBE_TIMEOUT_MS) {
+        _ledController.setBrightness(_probeRestore);
+        _probeState = ProbeState::IDLE;
+        Serial.println("[Light] Self-illumination probe timed out");
+        return;
+    }
+    
+    // Wait for a reading taken entirely at the current strip level
+    if (_lightSensor.getMeasurementCount() == _probeMeasurements ||
+        _lightSensor.getReadingBrightness() != _ledController.getBrightness()) {
+        return;
+    }
+    
+    if (_probeState == ProbeState::LED_ON) {
+        _probeLuxOn = _lightSensor.getRawLux();
+        _ledController.turnOff();
+        startProbeStep(ProbeState::LED_OFF);
+        return;
+    }
+    
+    float luxOff = _lightSensor.getRawLux();
+    float coupling = _lightSensor.learnSelfCoupling(_probeLuxOn, luxOff, _probeBrightness);
+    _ledController.setBrightness(_probeRestore);
+    _probeState = ProbeState::IDLE;
+    saveConfiguration();
+    
+    Serial.print("[Light] Self-illumination: ");
+    Serial.print(_probeLuxOn - luxOff, 2);
+    Serial.print(" lux at brightness ");
+    Serial.print(_probeBrightness);
+    Serial.print(", factor ");
+    Serial.println(coupling, 5);
+}
+
+void SmartLightController::handleLowPower() {
+    unsigned long now = millis();
+    bool moving = _motionDetector.isMoving();
+    
+    // Record how long the first motion took to be confirmed after an IMU wake
+    if (_wakeFromMotion && moving && _wakeToMotionUs == 0) {
+        _wakeToMotionUs = micros() - _wakeTimeUs;
+    }
+    
+    if (moving || _currentState != State::OFF || !_lowPowerEnabled) {
+        _lastActivityTime = now;
+        return;
+    }
+    
+    if (canEnterLowPower(now)) {
+        enterLowPower();
+    }
+}
+
+bool SmartLightController::canEnterLowPower(unsigned long now) const {
+    // Only sleep on a confirmed daytime (sensor reading or solar schedule)
+    if (IMU_INT_PIN < 0 || _lightSensorBypass || _movementBypass) return false;
+    if ((!_lightSensor.isReady() && !_solarValid) || isNightCondition()) return false;
+    
+    return (now - _lastActivityTime >= LOW_POWER_IDLE_MS) &&
+           (now - _lastWakeTime >= LOW_POWER_MIN_AWAKE_MS);
+}
+
+void SmartLightController::enterLowPower() {
+    // The level wakeup below would retrigger the sampling ISR for as long as INT is high
+    _motionDetector.pauseSamplingTask();
+    
+    if (!_motionDetector.armWakeOnMotion(LOW_POWER_WOM_THRESHOLD_MG)) {
+        _motionDetector.resumeSamplingTask();
+        _lastWakeTime = millis();  // Retry after the minimum awake time
+        return;
+    }
+    
+    // WoM drives the INT line high on motion; a timer wake re-checks the light level
+    gpio_wakeup_enable((gpio_num_t)IMU_INT_PIN, GPIO_INTR_HIGH_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    esp_sleep_enable_timer_wakeup((uint64_t)LOW_POWER_MAX_SLEEP_MS * 1000ULL);
+    Serial.flush();
+    
+    unsigned long sleepStart = millis();
+    esp_light_sleep_start();
+    uint32_t wakeUs = micros();
+    
+    _totalSleepMs += millis() - sleepStart;
+    _sleepCount++;
+    bool motionWake = (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO);
+    
+    // Restore the edge interrupt used by the sampling task
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+    gpio_wakeup_disable((gpio_num_t)IMU_INT_PIN);
+    gpio_set_intr_type((gpio_num_t)IMU_INT_PIN, GPIO_INTR_POSEDGE);
+    
+    _motionDetector.disarmWakeOnMotion();
+    _motionDetector.resumeSamplingTask();
+    _lastWakeTime = millis();
+    
+    if (motionWake) {
+        _wakeFromMotion = true;
+        _wakeTimeUs = wakeUs;
+        _wakeToMotionUs = 0;
+        _wakeToLedOnUs = 0;
+        _lastActivityTime = _lastWakeTime;
+    } else {
+        _wakeFromMotion = false;
+    }
+}
+
+float SmartLightController::getSleepRatio() const {
+    unsigned long uptime = millis();
+    if (uptime == 0) return 0.0f;
+    return (float)_totalSleepMs / (float)uptime;
 }
 
 bool SmartLightController::shouldLEDBeOn() const {
     // Core logic: LED should be ON if:
-    // 1. It's night (or light sensor bypassed)
+    // 1. It's night (sensor and/or solar schedule, or light sensor bypassed)
     // 2. There's movement (or movement sensor bypassed)
     // 3. Current time is within allowed window (if time window enabled)
     
-    bool isNightCondition = _lightSensorBypass ? true : _lightSensor.isNight();
+    bool isNight = isNightCondition();
     bool isMovingCondition = _movementBypass ? true : _motionDetector.isMoving();
+    if (_bladeGate && !_movementBypass) {
+        isMovingCondition = isMovingCondition && _motionDetector.isBladeRunning();
+    }
     bool isTimeWindowOk = isWithinTimeWindow();
     
-    return isNightCondition && isMovingCondition && isTimeWindowOk;
+    return isNight && isMovingCondition && isTimeWindowOk;
 }
 
 void SmartLightController::handleStateOff() {
@@ -146,6 +405,17 @@ void SmartLightController::transitionTo(State newState) {
                 _ledController.turnOn(brightness);
                 _countdownActive = false;
                 
+                // First automatic turn-on since boot: measure the strip's own light
+                if (SELF_LIGHT_PROBE_AUTO && !_selfLightProbed) {
+                    _selfLightProbed = startSelfLightProbe();
+                }
+                
+                // Wake-to-light latency after an IMU wake
+                if (_wakeFromMotion) {
+                    _wakeToLedOnUs = micros() - _wakeTimeUs;
+                    _wakeFromMotion = false;
+                }
+                
                 // Log ON event if LED was off
                 if (!_lastLEDState && _eventLogger) {
                     const char* mode = _manualOverride ? (_autoModeEnabled ? "auto" : "manual") : "auto";
@@ -166,6 +436,7 @@ void SmartLightController::transitionTo(State newState) {
 
 void SmartLightController::forceOn(uint8_t brightness) {
     _manualOverride = true;
+    _probeState = ProbeState::IDLE;  // Manual control wins over a running probe
     _ledController.turnOn(brightness);
     
     // Log event if state changed
@@ -178,6 +449,7 @@ void SmartLightController::forceOn(uint8_t brightness) {
 
 void SmartLightController::forceOff() {
     _manualOverride = true;
+    _probeState = ProbeState::IDLE;
     _ledController.turnOff();
     
     // Log event if state changed
@@ -190,6 +462,7 @@ void SmartLightController::forceOff() {
 
 void SmartLightController::returnToAuto() {
     _manualOverride = false;
+    _probeState = ProbeState::IDLE;
     // Reset to OFF state and let automatic control take over
     _currentState = State::OFF;
     _countdownActive = false;
@@ -236,6 +509,10 @@ void SmartLightController::loadConfiguration() {
     float luxThresh = prefs.getFloat(CONFIG_LUX_THRESHOLD_KEY, DEFAULT_LUX_THRESHOLD);
     float accelThresh = prefs.getFloat(CONFIG_ACCEL_THRESHOLD_KEY, DEFAULT_ACCEL_THRESHOLD);
     float gyroThresh = prefs.getFloat(CONFIG_GYRO_THRESHOLD_KEY, DEFAULT_GYRO_THRESHOLD);
+    uint8_t detectionMode = prefs.getUChar(CONFIG_DETECTION_MODE_KEY, DEFAULT_DETECTION_MODE);
+    int8_t shadowMode = prefs.getChar(CONFIG_SHADOW_MODE_KEY, DEFAULT_SHADOW_MODE);
+    _bladeGate = prefs.getBool(CONFIG_BLADE_GATE_KEY, DEFAULT_BLADE_GATE);
+    float selfLight = prefs.getFloat(CONFIG_SELF_LIGHT_KEY, 0.0f);
     
     // Load time window configuration
     _timeWindowEnabled = prefs.getBool(CONFIG_TIME_WINDOW_ENABLED_KEY, DEFAULT_TIME_WINDOW_ENABLED);
@@ -246,12 +523,21 @@ void SmartLightController::loadConfiguration() {
     // Load bypass states
     _movementBypass = prefs.getBool(CONFIG_MOVEMENT_BYPASS_KEY, false);
     
+    // Load low-power mode
+    _lowPowerEnabled = prefs.getBool(CONFIG_LOW_POWER_KEY, DEFAULT_LOW_POWER_ENABLED);
+    
     prefs.end();
     
     // Apply loaded values
     _lightSensor.setNightThreshold(luxThresh);
+    _lightSensor.setSelfCoupling(selfLight);
     _motionDetector.setAccThreshold(accelThresh);
     _motionDetector.setGyroThreshold(gyroThresh);
+    _motionDetector.setWindowMs(DEFAULT_MOTION_WINDOW_MS);
+    _motionDetector.setDetectionMode(static_cast<MotionDetector::DetectionMode>(detectionMode));
+    if (shadowMode >= 0) {
+        _motionDetector.setShadowMode(static_cast<MotionDetector::DetectionMode>(shadowMode));
+    }
     
     Serial.println("Configuration loaded from Preferences:");
     Serial.print("  Lux threshold: ");
@@ -260,6 +546,15 @@ void SmartLightController::loadConfiguration() {
     Serial.println(accelThresh);
     Serial.print("  Gyro threshold: ");
     Serial.println(gyroThresh);
+    Serial.print("  Detection mode: ");
+    Serial.println(detectionMode);
+    Serial.print("  Shadow mode: ");
+    Serial.println(shadowMode);
+    Serial.print("  Self-illumination: ");
+    Serial.print(selfLight, 5);
+    Serial.println(" lux per brightness step");
+    Serial.print("  Blade gate: ");
+    Serial.println(_bladeGate ? "YES" : "NO");
     Serial.print("  Shutoff delay: ");
     Serial.print(_shutoffDelayMs / 1000);
     Serial.println(" seconds");
@@ -276,6 +571,8 @@ void SmartLightController::loadConfiguration() {
     }
     Serial.print("  Movement bypass: ");
     Serial.println(_movementBypass ? "YES" : "NO");
+    Serial.print("  Low-power mode: ");
+    Serial.println(_lowPowerEnabled ? "YES" : "NO");
 }
 
 void SmartLightController::saveConfiguration() {
@@ -289,6 +586,11 @@ void SmartLightController::saveConfiguration() {
     prefs.putFloat(CONFIG_LUX_THRESHOLD_KEY, _lightSensor.getNightThreshold());
     prefs.putFloat(CONFIG_ACCEL_THRESHOLD_KEY, _motionDetector.getAccThreshold());
     prefs.putFloat(CONFIG_GYRO_THRESHOLD_KEY, _motionDetector.getGyroThreshold());
+    prefs.putUChar(CONFIG_DETECTION_MODE_KEY, static_cast<uint8_t>(_motionDetector.getDetectionMode()));
+    prefs.putChar(CONFIG_SHADOW_MODE_KEY, _motionDetector.isShadowEnabled()
+                  ? static_cast<int8_t>(_motionDetector.getShadowMode()) : -1);
+    prefs.putBool(CONFIG_BLADE_GATE_KEY, _bladeGate);
+    prefs.putFloat(CONFIG_SELF_LIGHT_KEY, _lightSensor.getSelfCoupling());
     
     // Save time window configuration
     prefs.putBool(CONFIG_TIME_WINDOW_ENABLED_KEY, _timeWindowEnabled);
@@ -299,6 +601,9 @@ void SmartLightController::saveConfiguration() {
     // Save bypass states
     prefs.putBool(CONFIG_MOVEMENT_BYPASS_KEY, _movementBypass);
     
+    // Save low-power mode
+    prefs.putBool(CONFIG_LOW_POWER_KEY, _lowPowerEnabled);
+    
     prefs.end();
     
     Serial.println("Configuration saved to Preferences");
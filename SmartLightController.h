@@ -7,6 +7,7 @@
 #include "LightSensor.h"
 #include "LEDController.h"
 #include "EventLogger.h"
+#include "SolarCalculator.h"
 
 /**
  * @brief Smart Light Controller - Main logic controller
@@ -104,6 +105,20 @@ public:
      */
     bool isMovementBypassed() const { return _movementBypass; }
     
+    /**
+     * @brief Enable/disable the blade gate
+     * When enabled, movement only counts while the blade motor vibration is
+     * detected (mowing), not when the mower is pushed or carried
+     * @param enabled true to require blade vibration
+     */
+    void setBladeGateEnabled(bool enabled) { _bladeGate = enabled; }
+    
+    /**
+     * @brief Check if the blade gate is enabled
+     * @return true if enabled
+     */
+    bool isBladeGateEnabled() const { return _bladeGate; }
+    
     /**
      * @brief Enable/disable time window restriction
      * @param enabled true to enable time window, false to disable
@@ -178,6 +193,38 @@ public:
      */
     bool shouldLEDBeOn() const;
     
+    /**
+     * @brief Night condition from the light sensor and the solar schedule (SOLAR_MODE)
+     * Falls back to the solar schedule when the sensor has failed, and to
+     * "night" (fail-safe) when there is neither a sensor nor a clock
+     * @return true if it is night
+     */
+    bool isNightCondition() const;
+    
+    /**
+     * @brief Solar schedule (events cached for the current UTC day)
+     * @return Solar calculator
+     */
+    const SolarCalculator& getSolar() const { return _solar; }
+    
+    /**
+     * @brief Check if the solar phase is known (clock set and SOLAR_MODE on)
+     * @return true if valid
+     */
+    bool isSolarValid() const { return _solarValid; }
+    
+    /**
+     * @brief Last evaluated solar phase
+     * @return Phase (meaningful only if isSolarValid())
+     */
+    SolarCalculator::Phase getSolarPhase() const { return _solarPhase; }
+    
+    /**
+     * @brief Check if the current time is close enough to twilight to sample lux
+     * @return true near dawn/dusk
+     */
+    bool isSolarSensingWindow() const { return _solarSensing; }
+    
     /**
      * @brief Get countdown time remaining before shutoff
      * @return Milliseconds remaining, or 0 if not in countdown
@@ -196,6 +243,75 @@ public:
      */
     const char* getStateString() const;
     
+    /**
+     * @brief Enable/disable low-power mode
+     * When enabled, during the day and after LOW_POWER_IDLE_MS without motion,
+     * the IMU Wake-on-Motion engine is armed and the MCU enters light sleep
+     * until the IMU interrupt fires (or LOW_POWER_MAX_SLEEP_MS elapses).
+     * Wi-Fi and the web UI do not run during light sleep, so a sleeping
+     * device answers no requests; see holdOffLowPower().
+     * @param enabled true to enable low-power mode
+     */
+    void setLowPowerEnabled(bool enabled) { _lowPowerEnabled = enabled; }
+    
+    /**
+     * @brief Restart the low-power idle timer
+     * Called while a web client is active, so the device only sleeps
+     * LOW_POWER_IDLE_MS after the web UI was last used.
+     */
+    void holdOffLowPower() { _lastActivityTime = millis(); }
+    
+    /**
+     * @brief Check if low-power mode is enabled
+     * @return true if enabled
+     */
+    bool isLowPowerEnabled() const { return _lowPowerEnabled; }
+    
+    /**
+     * @brief Get number of light-sleep periods since boot
+     * @return Sleep count
+     */
+    uint32_t getSleepCount() const { return _sleepCount; }
+    
+    /**
+     * @brief Get fraction of uptime spent in light sleep
+     * @return Ratio 0.0-1.0
+     */
+    float getSleepRatio() const;
+    
+    /**
+     * @brief Get latency from the last Wake-on-Motion wake to motion confirmed
+     * @return Microseconds, or 0 if not measured yet
+     */
+    uint32_t getWakeToMotionUs() const { return _wakeToMotionUs; }
+    
+    /**
+     * @brief Get latency from the last Wake-on-Motion wake to LED on
+     * @return Microseconds, or 0 if not measured yet
+     */
+    uint32_t getWakeToLedOnUs() const { return _wakeToLedOnUs; }
+    
+    /**
+     * @brief Get the last orientation seen by the controller
+     * Anything but UPRIGHT overrides the automatic logic (strip off or warning blink)
+     * @return Orientation
+     */
+    MotionDetector::Orientation getOrientation() const { return _orientation; }
+    
+    /**
+     * @brief Measure how much of the strip's light reaches the light sensor
+     * Non-blocking: the strip is held on for one reading and off for another,
+     * then restored; the automatic logic pauses meanwhile (about 1-2 s)
+     * @return false if a probe is already running or the sensor is not ready
+     */
+    bool startSelfLightProbe();
+    
+    /**
+     * @brief Check if a self-illumination probe is running
+     * @return true while probing
+     */
+    bool isSelfLightProbeRunning() const { return _probeState != ProbeState::IDLE; }
+    
     /**
      * @brief Load configuration from Preferences
      * Loads thresholds and delays from non-volatile memory
@@ -237,17 +353,64 @@ private:
     bool _lightSensorBypass;
     bool _movementBypass;
     
+    // Movement counts only while mowing
+    bool _bladeGate;
+    
     // Time window configuration
     bool _timeWindowEnabled;
     bool _timeWindowInverted;  // If true, operate OUTSIDE window
     uint8_t _timeWindowStart;  // 0-23 hour
     uint8_t _timeWindowEnd;    // 0-23 hour
     
+    // Low-power mode
+    bool _lowPowerEnabled;
+    unsigned long _lastActivityTime;  // Last time moving or LED not OFF
+    unsigned long _lastWakeTime;      // Last return from light sleep
+    unsigned long _totalSleepMs;
+    uint32_t _sleepCount;
+    bool _wakeFromMotion;             // Woken by IMU, latencies not yet recorded
+    uint32_t _wakeTimeUs;
+    uint32_t _wakeToMotionUs;
+    uint32_t _wakeToLedOnUs;
+    
+    // Solar schedule
+    SolarCalculator _solar;
+    bool _solarValid;
+    SolarCalculator::Phase _solarPhase;
+    bool _solarSensing;               // Near a twilight band
+    unsigned long _lastSolarCheck;
+    
+    // Self-illumination probe
+    enum class ProbeState {
+        IDLE,
+        LED_ON,           // Waiting for a reading with the strip at _probeBrightness
+        LED_OFF           // Waiting for a reading with the strip off
+    };
+    ProbeState _probeState;
+    uint8_t _probeBrightness;
+    uint8_t _probeRestore;            // Brightness before the probe
+    unsigned long _probeStepTime;
+    uint32_t _probeMeasurements;      // Sensor measurement count at the step start
+    float _probeLuxOn;
+    bool _selfLightProbed;            // Automatic probe done since boot
+    
+    // Orientation safety
+    MotionDetector::Orientation _orientation;
+    bool _warningBlinkOn;
+    unsigned long _warningBlinkTime;
+    
     // Helper methods
     void transitionTo(State newState);
     void handleStateOff();
     void handleStateOn();
     void handleStateCountdown();
+    void handleLowPower();
+    bool handleOrientation();
+    void updateSelfLightProbe();
+    void updateSolarSchedule();
+    void startProbeStep(ProbeState state);
+    bool canEnterLowPower(unsigned long now) const;
+    void enterLowPower();
 };
 
 #endif // SMART_LIGHT_CONTROLLER_H
@@ -0,0 +1,142 @@
+#include "SolarCalculator.h"
+#include <math.h>
+
+// Clocks before this are not synchronised yet (2023-11-14)
+#define SOLAR_MIN_VALID_TIME 1700000000L
+
+static const double DEG = M_PI / 180.0;
+
+SolarCalculator::SolarCalculator()
+    : _latitude(0.0f)
+    , _longitude(0.0f)
+    , _day(-1)
+    , _noonMin(720.0)
+    , _sunHalfMin(360.0)
+    , _civilHalfMin(360.0)
+{
+}
+
+void SolarCalculator::setLocation(float latitude, float longitude) {
+    _latitude = latitude;
+    _longitude = longitude;
+    _day = -1;  // Force a recomputation
+}
+
+bool SolarCalculator::update(time_t unixTime) {
+    if ((long)unixTime < SOLAR_MIN_VALID_TIME) {
+        return false;
+    }
+
+    long day = (long)(unixTime / 86400);
+    if (day == _day) {
+        return true;
+    }
+
+    time_t midnight = (time_t)day * 86400;
+    struct tm utc;
+    gmtime_r(&midnight, &utc);
+
+    static const double ALTITUDES[] = { SOLAR_SUNRISE_ALTITUDE, SOLAR_CIVIL_ALTITUDE };
+    double halfWidths[2];
+    compute(utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday, _latitude, _longitude,
+            ALTITUDES, 2, _noonMin, halfWidths);
+    _sunHalfMin = halfWidths[0];
+    _civilHalfMin = halfWidths[1];
+    _day = day;
+    return true;
+}
+
+void SolarCalculator::compute(int year, int month, int day, double latitude, double longitude,
+                              const double* altitudes, uint8_t count, double& noonMin, double* halfWidths) {
+    // Julian day at the approximate local noon
+    int y = year, m = month;
+    if (m <= 2) {
+        y--;
+        m += 12;
+    }
+    int a = y / 100;
+    int b = 2 - a + a / 4;
+    double jd = floor(365.25 * (y + 4716)) + floor(30.6001 * (m + 1)) + day + b - 1524.5;
+    jd += 0.5 - longitude / 360.0;
+    double t = (jd - 2451545.0) / 36525.0;  // Julian centuries since J2000
+
+    // Sun position
+    double l0 = fmod(280.46646 + t * (36000.76983 + t * 0.0003032), 360.0);
+    double anomaly = 357.52911 + t * (35999.05029 - 0.0001537 * t);
+    double ecc = 0.016708634 - t * (0.000042037 + 0.0000001267 * t);
+    double center = sin(anomaly * DEG) * (1.914602 - t * (0.004817 + 0.000014 * t)) +
+                    sin(2 * anomaly * DEG) * (0.019993 - 0.000101 * t) +
+                    sin(3 * anomaly * DEG) * 0.000289;
+    double omega = 125.04 - 1934.136 * t;
+    double lambda = l0 + center - 0.00569 - 0.00478 * sin(omega * DEG);
+    double obliquity = 23.0 + (26.0 + (21.448 - t * (46.815 + t * (0.00059 - t * 0.001813))) / 60.0) / 60.0 +
+                       0.00256 * cos(omega * DEG);
+    double declination = asin(sin(obliquity * DEG) * sin(lambda * DEG));
+
+    // Equation of time (minutes)
+    double yy = tan(obliquity * DEG / 2);
+    yy *= yy;
+    double eqTime = 4.0 / DEG * (yy * sin(2 * l0 * DEG) - 2 * ecc * sin(anomaly * DEG) +
+                                 4 * ecc * yy * sin(anomaly * DEG) * cos(2 * l0 * DEG) -
+                                 0.5 * yy * yy * sin(4 * l0 * DEG) - 1.25 * ecc * ecc * sin(2 * anomaly * DEG));
+    noonMin = 720.0 - 4.0 * longitude - eqTime;
+
+    // Hour angle of each altitude
+    double phi = latitude * DEG;
+    for (uint8_t i = 0; i < count; i++) {
+        double c = (sin(altitudes[i] * DEG) - sin(phi) * sin(declination)) / (cos(phi) * cos(declination));
+        if (c >= 1.0) {
+            halfWidths[i] = 0.0;      // Never that high
+        } else if (c <= -1.0) {
+            halfWidths[i] = 720.0;    // Never that low
+        } else {
+            halfWidths[i] = 4.0 / DEG * acos(c);
+        }
+    }
+}
+
+double SolarCalculator::wrap(double minutes) {
+    minutes = fmod(minutes, 1440.0);
+    return (minutes < 0) ? minutes + 1440.0 : minutes;
+}
+
+double SolarCalculator::offsetFromNoon(time_t unixTime) const {
+    double now = (double)(unixTime % 86400) / 60.0;
+    double offset = wrap(now - _noonMin + 720.0) - 720.0;
+    return offset;
+}
+
+int16_t SolarCalculator::eventTime(double offset, double halfWidth) const {
+    if (_day < 0 || halfWidth <= 0.0 || halfWidth >= 720.0) {
+        return -1;
+    }
+    return (int16_t)wrap(_noonMin + offset + 0.5);
+}
+
+SolarCalculator::Phase SolarCalculator::getPhase(time_t unixTime) const {
+    double offset = fabs(offsetFromNoon(unixTime));
+
+    if (offset < _sunHalfMin) return Phase::DAY;
+    if (offset < _civilHalfMin) return Phase::TWILIGHT;
+    return Phase::NIGHT;
+}
+
+uint16_t SolarCalculator::minutesFromTwilight(time_t unixTime) const {
+    double offset = fabs(offsetFromNoon(unixTime));
+
+    // No band at all (polar day or night): never close to one
+    if (_civilHalfMin <= _sunHalfMin) {
+        return 720;
+    }
+    if (offset < _sunHalfMin) return (uint16_t)(_sunHalfMin - offset);
+    if (offset > _civilHalfMin) return (uint16_t)(offset - _civilHalfMin);
+    return 0;
+}
+
+const char* SolarCalculator::toString(Phase phase) {
+    switch (phase) {
+        case Phase::DAY:      return "day";
+        case Phase::TWILIGHT: return "twilight";
+        default:              return "night";
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef SOLAR_CALCULATOR_H
+#define SOLAR_CALCULATOR_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Sun centre altitudes (degrees) defining the events
+#define SOLAR_SUNRISE_ALTITUDE -0.833    // Upper limb on the horizon, with refraction
+#define SOLAR_CIVIL_ALTITUDE -6.0        // Civil twilight
+
+/**
+ * @brief Sunrise/sunset and civil twilight for a fixed location
+ *
+ * NOAA solar equations (about 1 minute accuracy between +/-72 degrees of
+ * latitude), evaluated once per UTC day and cached. All times are minutes
+ * after 00:00 UTC. Events are described as half-widths around solar noon,
+ * which also covers polar day and night (half-width 720 or 0).
+ * No Arduino dependencies, so it also builds on the host.
+ */
+class SolarCalculator {
+public:
+    enum class Phase : uint8_t {
+        DAY,            // Sun above the horizon
+        TWILIGHT,       // Between sunset and civil dusk, or civil dawn and sunrise
+        NIGHT           // Sun below -6 degrees
+    };
+
+    SolarCalculator();
+
+    void setLocation(float latitude, float longitude);
+    float getLatitude() const { return _latitude; }
+    float getLongitude() const { return _longitude; }
+
+    /**
+     * @brief Recompute the events if unixTime is on a new UTC day
+     * @return false if the clock is not set yet
+     */
+    bool update(time_t unixTime);
+    bool isValid() const { return _day >= 0; }
+
+    /**
+     * @brief Phase at unixTime (call update() first)
+     */
+    Phase getPhase(time_t unixTime) const;
+
+    /**
+     * @brief Minutes from unixTime to the nearest sunrise/sunset-to-civil-twilight
+     * band (0 inside it); large values mean deep day or deep night
+     */
+    uint16_t minutesFromTwilight(time_t unixTime) const;
+
+    // Events of the cached day (minutes after 00:00 UTC, 0-1439; -1 if it does not occur)
+    int16_t getSolarNoon() const { return (int16_t)wrap(_noonMin); }
+    int16_t getSunrise() const { return eventTime(-_sunHalfMin, _sunHalfMin); }
+    int16_t getSunset() const { return eventTime(_sunHalfMin, _sunHalfMin); }
+    int16_t getCivilDawn() const { return eventTime(-_civilHalfMin, _civilHalfMin); }
+    int16_t getCivilDusk() const { return eventTime(_civilHalfMin, _civilHalfMin); }
+
+    static const char* toString(Phase phase);
+
+    /**
+     * @brief Solar noon and event half-widths for a date (minutes)
+     * @param halfWidths Output for each altitude: minutes from noon to the event,
+     *                   0 if the sun never gets that high, 720 if it never gets that low
+     */
+    static void compute(int year, int month, int day, double latitude, double longitude,
+                        const double* altitudes, uint8_t count, double& noonMin, double* halfWidths);
+
+private:
+    float _latitude;
+    float _longitude;
+    long _day;                  // Cached UTC day number, -1 = none
+    double _noonMin;
+    double _sunHalfMin;
+    double _civilHalfMin;
+
+    // Minutes from solar noon, in [-720, 720)
+    double offsetFromNoon(time_t unixTime) const;
+    int16_t eventTime(double offset, double halfWidth) const;
+    static double wrap(double minutes);
+};
+
+#endif // SOLAR_CALCULATOR_H
@@ -6,6 +6,7 @@
 #include "LEDController.h"
 #include "MotionDetector.h"
 #include "EventLogger.h"
+#include "I2CBus.h"
 
 WiFiManager::WiFiManager()
     : _webServer(nullptr)
@@ -18,12 +19,16 @@ WiFiManager::WiFiManager()
     , _resetButtonPressStart(0)
     , _apModeActive(false)
     , _resetButtonPressed(false)
+    , _traceStart(0)
+    , _traceDurationMs(0)
+    , _traceStreaming(false)
     , _smartLightController(nullptr)
     , _lightSensor(nullptr)
     , _motionDetector(nullptr)
     , _ledController(nullptr)
     , _eventLogger(nullptr)
     , _rgbBrightness(nullptr)
+    , _i2cBus(nullptr)
 {
 }
 
@@ -98,12 +103,28 @@ void WiFiManager::update() {
             if (_dnsServer) {
                 _dnsServer->processNextRequest();
             }
+            // A joined station may be setting up Wi-Fi: don't sleep under it
+            if (WiFi.softAPgetStationNum() > 0) {
+                holdOffLowPower();
+            }
             break;
             
         case ConnectionState::RECONNECTING:
             checkConnection();
             break;
     }
+    
+    serviceTrace();
+}
+
+// Light sleep stops Wi-Fi, so every request (and AP station) restarts the
+// controller's low-power idle timer: the device never sleeps under an active client
+
+void WiFiManager::holdOffLowPower() {
+    auto* controller = static_cast<SmartLightController*>(_smartLightController);
+    if (controller) {
+        controller->holdOffLowPower();
+    }
 }
 
 bool WiFiManager::loadCredentials() {
@@ -320,31 +341,37 @@ void WiFiManager::setupWebServer() {
     _webServer = new WebServer(WIFI_WEB_SERVER_PORT);
     
     // Register handlers
-    _webServer->on("/", [this]() { handleRoot(); });
-    _webServer->on("/dashboard", [this]() { handleDashboard(); });
-    _webServer->on("/logs", [this]() { handleLogs(); });
-    _webServer->on("/scan", [this]() { handleScan(); });
-    _webServer->on("/save", [this]() { handleSave(); });
-    _webServer->on("/status", [this]() { handleStatus(); });
+    _webServer->on("/", [this]() { holdOffLowPower(); handleRoot(); });
+    _webServer->on("/dashboard", [this]() { holdOffLowPower(); handleDashboard(); });
+    _webServer->on("/logs", [this]() { holdOffLowPower(); handleLogs(); });
+    _webServer->on("/scan", [this]() { holdOffLowPower(); handleScan(); });
+    _webServer->on("/save", [this]() { holdOffLowPower(); handleSave(); });
+    _webServer->on("/status", [this]() { holdOffLowPower(); handleStatus(); });
     
     // API endpoints
-    _webServer->on("/api/status", HTTP_GET, [this]() { handleApiStatus(); });
-    _webServer->on("/api/config", HTTP_GET, [this]() { handleApiConfig(); });
-    _webServer->on("/api/config", HTTP_POST, [this]() { handleApiConfigPost(); });
-    _webServer->on("/api/led/override", HTTP_POST, [this]() { handleApiLedOverride(); });
-    _webServer->on("/api/brightness", HTTP_GET, [this]() { handleApiBrightnessGet(); });
-    _webServer->on("/api/brightness", HTTP_POST, [this]() { handleApiBrightness(); });
-    _webServer->on("/api/logs", HTTP_GET, [this]() { handleApiLogs(); });
-    _webServer->on("/api/logs", HTTP_DELETE, [this]() { handleApiLogsDelete(); });
-    _webServer->on("/api/bypass", HTTP_GET, [this]() { handleApiBypassGet(); });
-    _webServer->on("/api/bypass/light", HTTP_POST, [this]() { handleApiBypassLight(); });
-    _webServer->on("/api/bypass/movement", HTTP_POST, [this]() { handleApiBypassMovement(); });
-    _webServer->on("/api/timewindow", HTTP_GET, [this]() { handleApiTimeWindowGet(); });
-    _webServer->on("/api/timewindow", HTTP_POST, [this]() { handleApiTimeWindowPost(); });
-    _webServer->on("/api/timewindow/enable", HTTP_POST, [this]() { handleApiTimeWindowEnable(); });
-    _webServer->on("/api/timewindow/invert", HTTP_POST, [this]() { handleApiTimeWindowInvert(); });
-    
-    _webServer->onNotFound([this]() { handleNotFound(); });
+    _webServer->on("/api/status", HTTP_GET, [this]() { holdOffLowPower(); handleApiStatus(); });
+    _webServer->on("/api/config", HTTP_GET, [this]() { holdOffLowPower(); handleApiConfig(); });
+    _webServer->on("/api/config", HTTP_POST, [this]() { holdOffLowPower(); handleApiConfigPost(); });
+    _webServer->on("/api/led/override", HTTP_POST, [this]() { holdOffLowPower(); handleApiLedOverride(); });
+    _webServer->on("/api/brightness", HTTP_GET, [this]() { holdOffLowPower(); handleApiBrightnessGet(); });
+    _webServer->on("/api/brightness", HTTP_POST, [this]() { holdOffLowPower(); handleApiBrightness(); });
+    _webServer->on("/api/logs", HTTP_GET, [this]() { holdOffLowPower(); handleApiLogs(); });
+    _webServer->on("/api/logs", HTTP_DELETE, [this]() { holdOffLowPower(); handleApiLogsDelete(); });
+    _webServer->on("/api/bypass", HTTP_GET, [this]() { holdOffLowPower(); handleApiBypassGet(); });
+    _webServer->on("/api/bypass/light", HTTP_POST, [this]() { holdOffLowPower(); handleApiBypassLight(); });
+    _webServer->on("/api/bypass/movement", HTTP_POST, [this]() { holdOffLowPower(); handleApiBypassMovement(); });
+    _webServer->on("/api/timewindow", HTTP_GET, [this]() { holdOffLowPower(); handleApiTimeWindowGet(); });
+    _webServer->on("/api/timewindow", HTTP_POST, [this]() { holdOffLowPower(); handleApiTimeWindowPost(); });
+    _webServer->on("/api/timewindow/enable", HTTP_POST, [this]() { holdOffLowPower(); handleApiTimeWindowEnable(); });
+    _webServer->on("/api/timewindow/invert", HTTP_POST, [this]() { holdOffLowPower(); handleApiTimeWindowInvert(); });
+    _webServer->on("/api/i2c", HTTP_GET, [this]() { holdOffLowPower(); handleApiI2C(); });
+    _webServer->on("/api/imu/trace", HTTP_GET, [this]() { holdOffLowPower(); handleApiImuTrace(); });
+    _webServer->on("/api/imu/tune", HTTP_GET, [this]() { holdOffLowPower(); handleApiImuTuneGet(); });
+    _webServer->on("/api/imu/tune", HTTP_POST, [this]() { holdOffLowPower(); handleApiImuTunePost(); });
+    _webServer->on("/api/imu/shadow", HTTP_GET, [this]() { holdOffLowPower(); handleApiImuShadow(); });
+    _webServer->on("/api/light/probe", HTTP_POST, [this]() { holdOffLowPower(); handleApiLightProbe(); });
+    
+    _webServer->onNotFound([this]() { holdOffLowPower(); handleNotFound(); });
     
     _webServer->begin();
     Serial.println("Web server started on port 80");
@@ -581,7 +608,65 @@ void WiFiManager::handleApiStatus() {
     json += "\"led_on\":" + String(ledIsOn ? "true" : "false") + ",";
     json += "\"led_mode\":\"" + ledMode + "\",";
     json += "\"lux\":" + String(lightSensor->getLastLux(), 1) + ",";
+    json += "\"light\":{";
+    json += "\"night\":" + String(lightSensor->isNight() ? "true" : "false") + ",";
+    json += "\"night_threshold\":" + String(lightSensor->getNightThreshold(), 1) + ",";
+    json += "\"day_threshold\":" + String(lightSensor->getDayThreshold(), 1) + ",";
+    json += "\"interval_ms\":" + String(lightSensor->getSampleIntervalMs()) + ",";
+    json += "\"reads\":" + String(lightSensor->getReadCount()) + ",";
+    json += "\"mtreg\":" + String(lightSensor->getMTreg()) + ",";
+    json += "\"resolution\":" + String(lightSensor->getResolution(), 3) + ",";
+    json += "\"raw_lux\":" + String(lightSensor->getRawLux(), 1) + ",";
+    json += "\"instant_lux\":" + String(lightSensor->getInstantLux(), 1) + ",";
+    json += "\"self_coupling\":" + String(lightSensor->getSelfCoupling(), 5) + ",";
+    json += "\"probing\":" + String(controller->isSelfLightProbeRunning() ? "true" : "false") + ",";
+    json += "\"sampling\":" + String(lightSensor->isSamplingEnabled() ? "true" : "false") + ",";
+    json += "\"ready\":" + String(lightSensor->isReady() ? "true" : "false");
+    json += "},";
+    
+    // Solar schedule (event times in minutes after 00:00 UTC, -1 = does not occur)
+    const SolarCalculator& solar = controller->getSolar();
+    json += "\"solar\":{";
+    json += "\"valid\":" + String(controller->isSolarValid() ? "true" : "false") + ",";
+    json += "\"phase\":\"" + String(SolarCalculator::toString(controller->getSolarPhase())) + "\",";
+    json += "\"sensing\":" + String(controller->isSolarSensingWindow() ? "true" : "false") + ",";
+    json += "\"night\":" + String(controller->isNightCondition() ? "true" : "false") + ",";
+    json += "\"dawn\":" + String(solar.getCivilDawn()) + ",";
+    json += "\"sunrise\":" + String(solar.getSunrise()) + ",";
+    json += "\"sunset\":" + String(solar.getSunset()) + ",";
+    json += "\"dusk\":" + String(solar.getCivilDusk());
+    json += "},";
     json += "\"motion\":" + String(motionDetector->isMoving() ? "true" : "false") + ",";
+    json += "\"imu\":{";
+    json += "\"adaptive_odr\":" + String(motionDetector->isAdaptiveOdrEnabled() ? "true" : "false") + ",";
+    json += "\"high_rate\":" + String(motionDetector->isHighRate() ? "true" : "false") + ",";
+    json += "\"duty_cycle\":" + String(motionDetector->getHighRateDutyCycle(), 3) + ",";
+    json += "\"odr_switches\":" + String(motionDetector->getOdrSwitchCount()) + ",";
+    json += "\"window_acc_std\":" + String(motionDetector->getWindowAccStdDev(), 4) + ",";
+    json += "\"window_gyro_std\":" + String(motionDetector->getWindowGyroStdDev(), 2) + ",";
+    json += "\"dropped_samples\":" + String(motionDetector->getDroppedSamples()) + ",";
+    json += "\"duplicate_samples\":" + String(motionDetector->getDuplicateSamples()) + ",";
+    json += "\"blade_running\":" + String(motionDetector->isBladeRunning() ? "true" : "false") + ",";
+    json += "\"blade_level\":" + String(motionDetector->getBladeBandLevel(), 4) + ",";
+    json += "\"locomotion_level\":" + String(motionDetector->getLocomotionBandLevel(), 4) + ",";
+    float nx, ny, nz;
+    motionDetector->getAccNoiseFloor(nx, ny, nz);
+    json += "\"acc_noise\":[" + String(nx, 4) + "," + String(ny, 4) + "," + String(nz, 4) + "],";
+    json += "\"acc_weight\":[" + String(motionDetector->getAccAxisWeight(0), 3) + ","
+          + String(motionDetector->getAccAxisWeight(1), 3) + ","
+          + String(motionDetector->getAccAxisWeight(2), 3) + "],";
+    json += "\"orientation\":\"" + String(OrientationEstimator::toString(motionDetector->getOrientation())) + "\",";
+    json += "\"pitch\":" + String(motionDetector->getPitch(), 1) + ",";
+    json += "\"roll\":" + String(motionDetector->getRoll(), 1) + ",";
+    json += "\"gyro_bias_bins\":" + String(motionDetector->getGyroBiasBins());
+    json += "},";
+    json += "\"low_power\":{";
+    json += "\"enabled\":" + String(controller->isLowPowerEnabled() ? "true" : "false") + ",";
+    json += "\"sleep_count\":" + String(controller->getSleepCount()) + ",";
+    json += "\"sleep_ratio\":" + String(controller->getSleepRatio(), 3) + ",";
+    json += "\"wake_to_motion_us\":" + String(controller->getWakeToMotionUs()) + ",";
+    json += "\"wake_to_led_on_us\":" + String(controller->getWakeToLedOnUs());
+    json += "},";
     json += "\"rssi\":" + String(getRSSI());
     json += "}";
     
@@ -612,7 +697,12 @@ void WiFiManager::handleApiConfig() {
     json += "\"lux_threshold\":" + String(luxThresh, 1) + ",";
     json += "\"accel_threshold\":" + String(accelThresh, 4) + ",";
     json += "\"gyro_threshold\":" + String(gyroThresh, 2) + ",";
-    json += "\"shutoff_delay\":" + String(shutoff);
+    json += "\"detection_mode\":" + String(static_cast<int>(motionDetector->getDetectionMode())) + ",";
+    json += "\"shadow_mode\":" + String(motionDetector->isShadowEnabled()
+                                         ? static_cast<int>(motionDetector->getShadowMode()) : -1) + ",";
+    json += "\"shutoff_delay\":" + String(shutoff) + ",";
+    json += "\"low_power\":" + String(controller->isLowPowerEnabled() ? "true" : "false") + ",";
+    json += "\"blade_gate\":" + String(controller->isBladeGateEnabled() ? "true" : "false");
     json += "}";
     
     _webServer->send(200, "application/json", json);
@@ -667,6 +757,24 @@ void WiFiManager::handleApiConfigPost() {
     if ((val = extractNumeric("shutoff_delay")) != "") {
         shutoff = val.toInt();
     }
+    int lowPower = -1;  // -1 = not provided
+    if ((val = extractNumeric("low_power")) != "") {
+        lowPower = val.startsWith("true") ? 1 : 0;
+    }
+    int detectionMode = -1;  // -1 = not provided
+    if ((val = extractNumeric("detection_mode")) != "") {
+        detectionMode = val.toInt();
+        if (detectionMode > static_cast<int>(MotionDetector::DetectionMode::HYBRID)) detectionMode = -1;
+    }
+    int shadowMode = -2;  // -2 = not provided, -1 = off
+    if ((val = extractNumeric("shadow_mode")) != "") {
+        shadowMode = val.toInt();
+        if (shadowMode < -1 || shadowMode > static_cast<int>(MotionDetector::DetectionMode::HYBRID)) shadowMode = -2;
+    }
+    int bladeGate = -1;  // -1 = not provided
+    if ((val = extractNumeric("blade_gate")) != "") {
+        bladeGate = val.startsWith("true") ? 1 : 0;
+    }
     
     // Save to preferences
     Preferences prefs;
@@ -702,6 +810,25 @@ void WiFiManager::handleApiConfigPost() {
         controller->setShutoffDelay(shutoff);
         anyChanged = true;
     }
+    if (controller && lowPower >= 0) {
+        controller->setLowPowerEnabled(lowPower == 1);
+        anyChanged = true;
+    }
+    if (motionDetector && detectionMode >= 0) {
+        motionDetector->setDetectionMode(static_cast<MotionDetector::DetectionMode>(detectionMode));
+        anyChanged = true;
+    }
+    if (motionDetector && shadowMode == -1) {
+        motionDetector->disableShadow();
+        anyChanged = true;
+    } else if (motionDetector && shadowMode >= 0) {
+        motionDetector->setShadowMode(static_cast<MotionDetector::DetectionMode>(shadowMode));
+        anyChanged = true;
+    }
+    if (controller && bladeGate >= 0) {
+        controller->setBladeGateEnabled(bladeGate == 1);
+        anyChanged = true;
+    }
     
     // Save configuration to persistent storage
     if (anyChanged && controller) {
@@ -1204,3 +1331,250 @@ void WiFiManager::handleApiTimeWindowInvert() {
         "{\"success\":true,\"message\":\"Time window inversion updated\"}");
 }
 
+void WiFiManager::handleApiI2C() {
+    if (!_i2cBus) {
+        _webServer->send(500, "application/json", 
+            "{\"error\":\"I2C bus not initialized\"}");
+        return;
+    }
+    
+    String json = "{";
+    json += "\"frequency\":" + String(_i2cBus->getFrequency()) + ",";
+    json += "\"recoveries\":" + String(_i2cBus->getRecoveryCount()) + ",";
+    
+    // Histogram bucket upper limits (us), last bucket is open-ended
+    json += "\"latency_buckets_us\":[";
+    for (uint8_t i = 0; i < I2C_LATENCY_BUCKETS - 1; i++) {
+        if (i > 0) json += ",";
+        json += String(I2CBus::getLatencyBucketLimitUs(i));
+    }
+    json += "],";
+    
+    json += "\"devices\":[";
+    for (uint8_t d = 0; d < _i2cBus->getDeviceCount(); d++) {
+        const I2CDevice* device = _i2cBus->getDevice(d);
+        const I2CDevice::Stats& stats = device->getStats();
+        
+        if (d > 0) json += ",";
+        json += "{";
+        json += "\"name\":\"" + String(device->getName()) + "\",";
+        json += "\"address\":" + String(device->getAddress()) + ",";
+        json += "\"transactions\":" + String(stats.transactions) + ",";
+        json += "\"nack_addr\":" + String(stats.nackAddr) + ",";
+        json += "\"nack_data\":" + String(stats.nackData) + ",";
+        json += "\"timeouts\":" + String(stats.timeouts) + ",";
+        json += "\"errors\":" + String(stats.errors) + ",";
+        json += "\"probes\":" + String(stats.probes) + ",";
+        json += "\"max_latency_us\":" + String(stats.maxLatencyUs) + ",";
+        json += "\"latency_hist\":[";
+        for (uint8_t i = 0; i < I2C_LATENCY_BUCKETS; i++) {
+            if (i > 0) json += ",";
+            json += String(stats.latencyHist[i]);
+        }
+        json += "]}";
+    }
+    json += "]}";
+    
+    _webServer->send(200, "application/json", json);
+}
+
+void WiFiManager::handleApiImuTrace() {
+    auto* motionDetector = static_cast<MotionDetector*>(_motionDetector);
+    if (!motionDetector) {
+        _webServer->send(500, "application/json", 
+            "{\"error\":\"Motion detector not initialized\"}");
+        return;
+    }
+    if (motionDetector->isTracing()) {
+        _webServer->send(409, "application/json", 
+            "{\"error\":\"Trace already in progress\"}");
+        return;
+    }
+    
+    unsigned long seconds = IMU_TRACE_DEFAULT_SECONDS;
+    if (_webServer->hasArg("seconds")) {
+        seconds = _webServer->arg("seconds").toInt();
+        if (seconds < 1) seconds = 1;
+        if (seconds > IMU_TRACE_MAX_SECONDS) seconds = IMU_TRACE_MAX_SECONDS;
+    }
+    
+    // Binary stream: header now, then records as they are captured, a chunk per
+    // update() so loop() keeps running. The client is kept past this handler, so
+    // the response is written raw and ends when the connection closes.
+    motionDetector->startTrace();
+    _traceClient = _webServer->client();
+    _traceClient.print("HTTP/1.1 200 OK\r\n"
+                       "Content-Type: application/octet-stream\r\n"
+                       "Content-Disposition: attachment; filename=\"imu.trace\"\r\n"
+                       "Connection: close\r\n\r\n");
+    _traceClient.write((const uint8_t*)&motionDetector->getTraceHeader(), sizeof(ImuTraceHeader));
+    _traceStart = millis();
+    _traceDurationMs = seconds * 1000UL;
+    _traceStreaming = true;
+}
+
+void WiFiManager::serviceTrace() {
+    if (!_traceStreaming) return;
+    auto* motionDetector = static_cast<MotionDetector*>(_motionDetector);
+    
+    // A sleeping device would cut the capture short
+    holdOffLowPower();
+    
+    bool connected = _traceClient.connected();
+    bool done = !connected || millis() - _traceStart >= _traceDurationMs;
+    if (done) {
+        motionDetector->stopTrace();
+    }
+    
+    // One bounded chunk per pass; at the end drain what is left (at most one buffer)
+    ImuTraceRecord records[IMU_TRACE_CHUNK_RECORDS];
+    uint16_t n;
+    do {
+        n = motionDetector->readTrace(records, IMU_TRACE_CHUNK_RECORDS);
+        if (n > 0 && connected) {
+            _traceClient.write((const uint8_t*)records, n * sizeof(ImuTraceRecord));
+        }
+    } while (done && n > 0);
+    
+    if (done) {
+        _traceClient.stop();
+        _traceStreaming = false;
+        Serial.print("[IMU] Trace captured, dropped records: ");
+        Serial.println(motionDetector->getTraceDropped());
+    }
+}
+
+void WiFiManager::handleApiImuTuneGet() {
+    auto* motionDetector = static_cast<MotionDetector*>(_motionDetector);
+    if (!motionDetector) {
+        _webServer->send(500, "application/json", 
+            "{\"error\":\"Motion detector not initialized\"}");
+        return;
+    }
+    
+    static const float QUANTILES[] = { 0.5f, 0.9f, 0.99f };
+    static const char* const QUANTILE_NAMES[] = { "p50", "p90", "p99" };
+    
+    String json = "{";
+    json += "\"idle_samples\":" + String(motionDetector->getTuneSampleCount(false)) + ",";
+    json += "\"moving_samples\":" + String(motionDetector->getTuneSampleCount(true)) + ",";
+    
+    // Quantiles per sensor and state: acc in g, gyro in dps
+    for (int gyro = 0; gyro < 2; gyro++) {
+        for (int moving = 0; moving < 2; moving++) {
+            json += "\"" + String(gyro ? "gyro_" : "acc_") + String(moving ? "moving" : "idle") + "\":{";
+            for (int i = 0; i < 3; i++) {
+                if (i > 0) json += ",";
+                json += "\"" + String(QUANTILE_NAMES[i]) + "\":";
+                json += String(motionDetector->getDeviationQuantile(gyro, moving, QUANTILES[i]), gyro ? 2 : 4);
+            }
+            json += "},";
+        }
+    }
+    
+    float acc, gyro;
+    bool ready = motionDetector->getProposedThresholds(acc, gyro);
+    json += "\"ready\":" + String(ready ? "true" : "false");
+    if (ready) {
+        json += ",\"proposed_accel_threshold\":" + String(acc, 4);
+        json += ",\"proposed_gyro_threshold\":" + String(gyro, 2);
+    }
+    json += "}";
+    
+    _webServer->send(200, "application/json", json);
+}
+
+void WiFiManager::handleApiImuTunePost() {
+    if (!_webServer->hasArg("plain")) {
+        _webServer->send(400, "application/json", 
+            "{\"success\":false,\"message\":\"No body provided\"}");
+        return;
+    }
+    
+    auto* motionDetector = static_cast<MotionDetector*>(_motionDetector);
+    auto* controller = static_cast<SmartLightController*>(_smartLightController);
+    if (!motionDetector || !controller) {
+        _webServer->send(500, "application/json", 
+            "{\"success\":false,\"message\":\"System components not initialized\"}");
+        return;
+    }
+    
+    // {"action":"start"} clears the statistics, {"action":"apply"} uses the proposal
+    String body = _webServer->arg("plain");
+    if (body.indexOf("start") >= 0) {
+        motionDetector->startAutoTune();
+        _webServer->send(200, "application/json", 
+            "{\"success\":true,\"message\":\"Auto-tune started\"}");
+    } else if (body.indexOf("apply") >= 0) {
+        if (!motionDetector->applyProposedThresholds()) {
+            _webServer->send(409, "application/json", 
+                "{\"success\":false,\"message\":\"Not enough idle samples yet\"}");
+            return;
+        }
+        controller->saveConfiguration();
+        _webServer->send(200, "application/json", 
+            "{\"success\":true,\"message\":\"Thresholds applied\"}");
+    } else {
+        _webServer->send(400, "application/json", 
+            "{\"success\":false,\"message\":\"Unknown action\"}");
+    }
+}
+
+void WiFiManager::handleApiImuShadow() {
+    auto* motionDetector = static_cast<MotionDetector*>(_motionDetector);
+    if (!motionDetector) {
+        _webServer->send(500, "application/json", 
+            "{\"error\":\"Motion detector not initialized\"}");
+        return;
+    }
+    
+    MotionDetector::ShadowEpisode episodes[MOTION_SHADOW_LOG_SIZE];
+    uint8_t count = motionDetector->getShadowLog(episodes, MOTION_SHADOW_LOG_SIZE);
+    bool enabled = motionDetector->isShadowEnabled();
+    
+    String json = "{";
+    json += "\"enabled\":" + String(enabled ? "true" : "false") + ",";
+    json += "\"primary\":{\"mode\":\"" + String(MotionDetector::modeName(motionDetector->getDetectionMode())) + "\",";
+    json += "\"moving\":" + String(motionDetector->isMoving() ? "true" : "false") + ",";
+    json += "\"cycles_avg\":" + String(motionDetector->getStrategyCycles(false)) + ",";
+    json += "\"cycles_max\":" + String(motionDetector->getStrategyMaxCycles(false)) + "}";
+    if (enabled) {
+        json += ",\"shadow\":{\"mode\":\"" + String(MotionDetector::modeName(motionDetector->getShadowMode())) + "\",";
+        json += "\"moving\":" + String(motionDetector->isShadowMoving() ? "true" : "false") + ",";
+        json += "\"cycles_avg\":" + String(motionDetector->getStrategyCycles(true)) + ",";
+        json += "\"cycles_max\":" + String(motionDetector->getStrategyMaxCycles(true)) + "}";
+    }
+    json += ",\"samples\":" + String(motionDetector->getShadowSamples());
+    json += ",\"disagree_samples\":" + String(motionDetector->getShadowDisagreeSamples());
+    json += ",\"episodes\":" + String(motionDetector->getShadowEpisodes());
+    
+    // Most recent episodes, oldest first; duration_ms 0 = still disagreeing
+    json += ",\"log\":[";
+    for (uint8_t i = 0; i < count; i++) {
+        if (i > 0) json += ",";
+        json += "{\"start_ms\":" + String(episodes[i].startMs);
+        json += ",\"duration_ms\":" + String(episodes[i].durationMs);
+        json += ",\"primary_moving\":" + String(episodes[i].primaryMoving ? "true" : "false") + "}";
+    }
+    json += "]}";
+    
+    _webServer->send(200, "application/json", json);
+}
+
+void WiFiManager::handleApiLightProbe() {
+    auto* controller = static_cast<SmartLightController*>(_smartLightController);
+    if (!controller) {
+        _webServer->send(500, "application/json", 
+            "{\"success\":false,\"message\":\"System components not initialized\"}");
+        return;
+    }
+    
+    // Non-blocking: the result appears in /api/status (light.self_coupling)
+    if (!controller->startSelfLightProbe()) {
+        _webServer->send(409, "application/json", 
+            "{\"success\":false,\"message\":\"Probe already running or light sensor not ready\"}");
+        return;
+    }
+    _webServer->send(200, "application/json", 
+        "{\"success\":true,\"message\":\"Self-illumination probe started\"}");
+}
@@ -8,6 +8,8 @@
 #include <Preferences.h>
 #include <vector>
 
+class I2CBus;
+
 /**
  * @brief WiFi Manager - Gestione connessione Wi-Fi con captive portal
  * 
@@ -190,7 +192,15 @@ public:
      */
     void setSystemComponents(void* controller, void* lightSensor, 
                               void* motionDetector, void* ledController,
-                              void* eventLogger, uint8_t* rgbBrightness = nullptr);    /**
+                              void* eventLogger, uint8_t* rgbBrightness = nullptr);
+    
+    /**
+     * @brief Imposta il bus I2C condiviso per l'API delle statistiche (/api/i2c)
+     * @param bus Puntatore all'I2CBus
+     */
+    void setI2CBus(I2CBus* bus) { _i2cBus = bus; }
+    
+    /**
      * @brief Ottieni il riferimento al WebServer interno
      * @return Puntatore al WebServer (può essere nullptr se non inizializzato)
      */
@@ -221,6 +231,12 @@ private:
     bool _apModeActive;
     bool _resetButtonPressed;
     
+    // IMU trace stream (/api/imu/trace), fed a chunk per update()
+    WiFiClient _traceClient;
+    unsigned long _traceStart;
+    unsigned long _traceDurationMs;
+    bool _traceStreaming;
+    
     // System component references (for API)
     void* _smartLightController;
     void* _lightSensor;
@@ -228,6 +244,7 @@ private:
     void* _ledController;
     void* _eventLogger;
     uint8_t* _rgbBrightness;  // Pointer to RGB brightness variable
+    I2CBus* _i2cBus;          // Shared I2C bus (statistics)
     
     // Helper methods
     bool loadCredentials();
@@ -237,6 +254,8 @@ private:
     void checkConnection();
     void handleReconnection();
     void checkResetButton();
+    void holdOffLowPower();
+    void serviceTrace();
     
     // Web server handlers
     void setupWebServer();
@@ -262,6 +281,12 @@ private:
     void handleApiTimeWindowPost();
     void handleApiTimeWindowEnable();
     void handleApiTimeWindowInvert();
+    void handleApiI2C();
+    void handleApiImuTrace();
+    void handleApiImuTuneGet();
+    void handleApiImuTunePost();
+    void handleApiImuShadow();
+    void handleApiLightProbe();
     
     // HTML pages (stored in PROGMEM to save RAM)
     static const char* getConfigPageHTML();
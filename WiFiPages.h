@@ -1673,7 +1673,8 @@ const char WIFI_LOGS_PAGE[] PROGMEM = R"rawliteral(
                 const dateStr = date.toLocaleDateString('it-IT');
                 const timeStr = date.toLocaleTimeString('it-IT');
                 
-                const eventText = log.event === 'on' ? '💡 LED ACCESO' : '🌙 LED SPENTO';
+                const eventText = log.event === 'orientation' ? `🤖 ORIENTAMENTO: ${log.orientation}`
+                                : log.event === 'on' ? '💡 LED ACCESO' : '🌙 LED SPENTO';
                 const eventClass = log.event;
                 
                 return `
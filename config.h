@@ -1,6 +1,23 @@
 // IMU
 #define QMI_ADRESS 0x6b  // SA0 pin connected to VCC (use 0x6a if connected to GND)
 #define QMI8658C_IIC_FREQUENCY 80*1000
+#define IMU_FIFO_ENABLED true       // Drain the IMU FIFO each loop instead of reading one sample
+#define IMU_FIFO_WATERMARK 16       // FIFO watermark (samples)
+// Interrupt-driven sampling and low-power mode need the QMI8658 INT1 or INT2 pad
+// wired to a free GPIO. That is a per-build wiring choice, so the default polls
+// from loop(). To enable: wire the pad, set IMU_INT_PIN to the GPIO and
+// IMU_INT_LINE to the pad. A miswired line only costs latency: the sampling task
+// still polls every MOTION_TASK_FALLBACK_MS when no interrupt arrives.
+#define IMU_INT_PIN -1              // GPIO wired to the QMI8658 interrupt pin (-1 = poll from loop)
+#define IMU_INT_LINE 1              // QMI8658 interrupt pin used (1 = INT1, 2 = INT2)
+#define IMU_ADAPTIVE_ODR_ENABLED true   // Accel-only low ODR while stationary, full rate on motion
+#define IMU_ADAPTIVE_ODR_QUIET_MS 10000 // Quiet time before dropping back to the low ODR
+#define IMU_FILTER_ENABLED true         // High-/low-pass filtered detection instead of baseline subtraction
+#define IMU_BASELINE_TRACKING true      // Learn the baseline while stationary (calibration at boot optional)
+#define IMU_AXIS_WEIGHTING true         // Per-axis noise floor: noisy axes (blade vibration) weigh less
+#define IMU_GYRO_BIAS_COMPENSATION true // Learn the gyro bias per temperature (needs baseline tracking)
+#define IMU_MOUNT_UP_AXIS 2             // Sensor axis pointing up with the robot level (0 = X, 1 = Y, 2 = Z)
+#define IMU_MOUNT_UP_SIGN 1             // +1 or -1 (sensor mounted upside down)
 
 // I2C Pins (shared bus for IMU and BH1750)
 #define I2C_SDA 12
@@ -66,6 +83,19 @@
 #define DEFAULT_LUX_THRESHOLD 10.0             // Default threshold for night detection (lux)
 #define CONFIG_LUX_THRESHOLD_KEY "lux_thresh"  // Preferences key
 
+// Lux spike filter (median window feeding an EMA, see LuxFilter.h): rising light is
+// smoothed slowly so headlights and torches cannot end the night
+#define LIGHT_FILTER_MEDIAN 5                  // Samples (odd, 1 = no median)
+#define LIGHT_FILTER_RISE_TAU_MS 20000         // Time constant for increasing light
+#define LIGHT_FILTER_FALL_TAU_MS 3000          // Time constant for decreasing light
+
+// Self-illumination: how much of the strip's light reaches the BH1750 is measured
+// with a short on/off probe (first automatic turn-on after boot, or /api/light/probe)
+#define SELF_LIGHT_PROBE_AUTO true             // Probe on the first automatic turn-on
+#define SELF_LIGHT_PROBE_BRIGHTNESS 255        // Probe level when the strip is off
+#define SELF_LIGHT_PROBE_TIMEOUT_MS 5000       // Give up if a step gets no reading
+#define CONFIG_SELF_LIGHT_KEY "self_light"     // Preferences key (lux per brightness step)
+
 // IMU Motion Detection Thresholds
 #define DEFAULT_ACCEL_THRESHOLD 0.15           // Default acceleration threshold (g) for motion detection
 #define DEFAULT_GYRO_THRESHOLD 15.0            // Default gyroscope threshold (deg/s) for motion detection
@@ -75,10 +105,31 @@
 #define CONFIG_GYRO_THRESHOLD_KEY "gyro_th"    // Preferences key
 #define CONFIG_MOTION_DEBOUNCE_KEY "motion_db" // Preferences key
 
+// Motion detection strategy: 0 = pulse counting, 1 = windowed RMS, 2 = windowed variance,
+// 3 = spectral (locomotion band), 4 = hybrid (windowed variance, blade-only vibration ignored)
+// (windowed modes compare the RMS / standard deviation over the window with the thresholds)
+#define DEFAULT_DETECTION_MODE 0
+#define DEFAULT_MOTION_WINDOW_MS 250           // Window length for the windowed modes (ms)
+#define CONFIG_DETECTION_MODE_KEY "detect_mode" // Preferences key
+#define DEFAULT_SHADOW_MODE -1                 // Strategy run in shadow for comparison (-1 = off)
+#define CONFIG_SHADOW_MODE_KEY "shadow_mode"   // Preferences key
+#define DEFAULT_BLADE_GATE false               // Require blade vibration (mowing) to turn the LED on
+#define CONFIG_BLADE_GATE_KEY "blade_gate"     // Preferences key
+
+// IMU trace capture (/api/imu/trace?seconds=N, binary stream, see ImuTrace.h)
+#define IMU_TRACE_DEFAULT_SECONDS 10           // Capture length if not given
+#define IMU_TRACE_MAX_SECONDS 120              // Longest capture per request
+#define IMU_TRACE_CHUNK_RECORDS 64             // Records sent per loop() pass while streaming
+
 // LED Control
 #define DEFAULT_LED_SHUTOFF_DELAY_MS 30000     // Default delay before LED off after motion stops (30 seconds)
 #define CONFIG_LED_SHUTOFF_KEY "led_shutoff"   // Preferences key
 
+// Robot lifted, tipped or upside down: strip forced off, or blinking as a warning
+#define ORIENTATION_WARNING_BLINK false        // true = blink, false = force off
+#define ORIENTATION_WARNING_BRIGHTNESS 64      // Blink brightness (0-255)
+#define ORIENTATION_WARNING_PERIOD_MS 500      // Blink half-period
+
 #define DEFAULT_LED_BRIGHTNESS 255             // Default LED strip brightness (0-255)
 #define CONFIG_LED_BRIGHTNESS_KEY "led_bright" // Preferences key for LED brightness
 
@@ -98,6 +149,18 @@
 #define LCD_WAKE_ON_MOTION true                // Wake display when motion is detected
 #define LCD_WAKE_ON_STATE_CHANGE true          // Wake display when LED/WiFi state changes
 
+// ========== Low Power (Wake-on-Motion) ==========
+// During the day, when the robot is stationary, the IMU watches for motion
+// and the MCU light-sleeps. Requires IMU_INT_PIN to be wired (see the IMU
+// section); with the default -1 the device never sleeps.
+
+#define DEFAULT_LOW_POWER_ENABLED false        // Default: low-power mode disabled
+#define CONFIG_LOW_POWER_KEY "low_power"       // Preferences key
+#define LOW_POWER_IDLE_MS 60000                // Stationary daytime before sleeping (1 minute)
+#define LOW_POWER_MAX_SLEEP_MS 60000           // Timer wake to re-check light level (1 minute)
+#define LOW_POWER_MIN_AWAKE_MS 2000            // Stay awake after each wake (lux read, Wi-Fi, web)
+#define LOW_POWER_WOM_THRESHOLD_MG 50          // Wake-on-Motion threshold (mg)
+
 // ========== Time Window Configuration ==========
 // LED accensione basata su orario (e.g. accendi solo tra le 7:00 e le 17:00)
 
@@ -116,5 +179,18 @@
 #define NTP_GMT_OFFSET_SEC 3600                // GMT offset in seconds (e.g. +1h = 3600)
 #define NTP_DAYLIGHT_OFFSET_SEC 3600           // Daylight saving offset (1h = 3600)
 
+// ========== Solar Schedule ==========
+// Civil twilight from the installation coordinates (needs NTP time). Modes:
+// 0 = off (light sensor only)
+// 1 = gate: lux is sampled only within SOLAR_SENSING_MARGIN_MIN of the twilight bands,
+//     otherwise the solar phase decides day/night
+// 2 = confirm: lux decides, but never turns night on in full daylight away from twilight
+// With the light sensor failed, the solar phase (night from sunset) is used either way.
+#define SOLAR_MODE 1
+#define SOLAR_LATITUDE 45.4642                 // Degrees, north positive
+#define SOLAR_LONGITUDE 9.1900                 // Degrees, east positive
+#define SOLAR_SENSING_MARGIN_MIN 45            // Sample lux this close to a twilight band
+#define SOLAR_CHECK_INTERVAL_MS 10000          // Phase re-evaluation period
+
 // Movement Bypass Configuration
 #define CONFIG_MOVEMENT_BYPASS_KEY "mov_bypass" // Preferences key for movement bypass
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <Wire.h>                // I2C library
 
 #include "bitmap.h"
+#include "I2CBus.h"
 #include "Qmi8658c.h"
 #include "MotionDetector.h"
 #include "LightSensor.h"
@@ -20,8 +21,11 @@
 // Create an instance of the display
 Adafruit_ST7735 tft = Adafruit_ST7735(TFT_CS, TFT_DC, TFT_RST);
 
+// Shared I2C bus (IMU + BH1750)
+I2CBus i2cBus(Wire, I2C_SDA, I2C_SCL);
+
 // IMU
-Qmi8658c qmi8658c(QMI_ADRESS, QMI8658C_IIC_FREQUENCY);
+Qmi8658c qmi8658c(i2cBus, QMI_ADRESS);
 
 // Configuration optimized for slow-moving grass cutting robot
 qmi8658_cfg_t qmi8658_cfg = {
@@ -39,7 +43,7 @@ qmi8658_cfg_t qmi8658_cfg = {
 MotionDetector motionDetector(&qmi8658c);
 
 // Light sensor instance (BH1750)
-LightSensor lightSensor(BH1750_ADDR);
+LightSensor lightSensor(i2cBus, BH1750_ADDR);
 
 // LED strip controller instance
 LEDController ledController(LED_MOSFET_PIN);
@@ -99,6 +103,9 @@ void setup() {
 	// Draw the bitmap at position (0, 0) - removed to use display manager instead
 	// tft.drawBitmap(0, 0, myBitmap, 128, 128, ST77XX_BLACK);
 
+	// Initialize shared I2C bus
+	i2cBus.begin(QMI8658C_IIC_FREQUENCY);
+	
 	// Initialize motion detector
 	if (!motionDetector.begin(&qmi8658_cfg)) {
 		Serial.println("Failed to initialize IMU!");
@@ -119,13 +126,47 @@ void setup() {
 	
 	Serial.println("IMU initialized and ready");
 	
-	// Perform baseline calibration
-	Serial.println("\n========== CALIBRATING IMU ==========");
-	Serial.println("Keep the device STILL for 3 seconds...");
-	delay(1000);
+	// Baseline: restored from NVS by begin(), learned in the background while
+	// stationary, or measured now (blocking) if tracking is disabled
+	motionDetector.setBaselineTracking(IMU_BASELINE_TRACKING);
+	motionDetector.setGyroBiasCompensation(IMU_GYRO_BIAS_COMPENSATION);
+	if (motionDetector.isCalibrated()) {
+		Serial.println("IMU baseline restored from NVS");
+	} else if (IMU_BASELINE_TRACKING) {
+		Serial.println("IMU baseline will be learned while stationary");
+	} else {
+		Serial.println("\n========== CALIBRATING IMU ==========");
+		Serial.println("Keep the device STILL for 3 seconds...");
+		delay(1000);
+		
+		motionDetector.calibrate();
+		Serial.println("Calibration complete!");
+	}
+	
+	// Batch every queued IMU sample per loop iteration
+	if (IMU_FIFO_ENABLED && motionDetector.enableFifo(IMU_FIFO_WATERMARK)) {
+		Serial.println("IMU FIFO batching enabled");
+	}
+	
+	// Sample on IMU interrupt instead of polling from loop()
+	if (motionDetector.startSamplingTask(IMU_INT_PIN, IMU_INT_LINE)) {
+		Serial.print("IMU interrupt sampling on GPIO"); Serial.println(IMU_INT_PIN);
+	}
+	
+	// Filtered detection: robust to parking on a different slope than at calibration
+	motionDetector.setFilterEnabled(IMU_FILTER_ENABLED);
+	
+	// Ellipsoidal thresholds from the per-axis noise floor
+	motionDetector.setAxisWeighting(IMU_AXIS_WEIGHTING);
 	
-	motionDetector.calibrate();
-	Serial.println("Calibration complete!");
+	// Lifted / tipped / upside-down classification relative to the mount
+	motionDetector.setUpAxis(IMU_MOUNT_UP_AXIS, IMU_MOUNT_UP_SIGN);
+	
+	// Drop to accel-only low ODR while stationary
+	if (IMU_ADAPTIVE_ODR_ENABLED) {
+		motionDetector.enableAdaptiveOdr(IMU_ADAPTIVE_ODR_QUIET_MS);
+		Serial.println("IMU adaptive ODR enabled");
+	}
 	Serial.println("====================================\n");
 	DebugHelper::printCalibrationValues(motionDetector);
 	
@@ -136,7 +177,8 @@ void setup() {
 	
 	// Initialize Light Sensor (BH1750)
 	Serial.println("\n========== INITIALIZING LIGHT SENSOR ==========");
-	if (!lightSensor.begin(I2C_SDA, I2C_SCL)) {
+	lightSensor.setFilter(LIGHT_FILTER_MEDIAN, LIGHT_FILTER_RISE_TAU_MS, LIGHT_FILTER_FALL_TAU_MS);
+	if (!lightSensor.begin()) {
 		Serial.println("ERROR: Failed to initialize BH1750!");
 		Serial.println("Check I2C connections and address");
 	} else {
@@ -145,8 +187,8 @@ void setup() {
 		Serial.print("I2C SCL: GPIO"); Serial.println(I2C_SCL);
 		Serial.print("BH1750 Address: 0x"); Serial.println(BH1750_ADDR, HEX);
 		
-		// Read initial lux value
-		float lux = lightSensor.readLux();
+		// Initial lux value (measured by begin())
+		float lux = lightSensor.getLastLux();
 		Serial.print("Initial Light Level: "); Serial.print(lux); Serial.println(" lux");
 		Serial.print("Night Threshold: "); Serial.print(lightSensor.getNightThreshold()); Serial.println(" lux");
 	}
@@ -210,6 +252,7 @@ void setup() {
 	
 	// Link system components to WiFi Manager for API
 	wifiManager.setSystemComponents(&smartLight, &lightSensor, &motionDetector, &ledController, &eventLogger, &currentRgbBrightness);
+	wifiManager.setI2CBus(&i2cBus);
 	Serial.println("System components linked to WiFi Manager API");
 	Serial.println("===============================================\n");
 	
@@ -272,15 +315,17 @@ void loop() {
     otaManager->update();
   }
   
-  // Read light level every 500ms
-  static unsigned long lastLightRead = 0;
-  if (millis() - lastLightRead > 500) {
-    float lux = lightSensor.readLux();
-    lastLightRead = millis();
-  }
+  // Read light level (adaptive interval: sub-second only near the thresholds);
+  // the strip level lets the sensor subtract the strip's own light
+  lightSensor.setSelfIllumination(ledController.getBrightness());
+  lightSensor.update();
   
-  // Detect motion
-  bool isMoving = motionDetector.detectMotion();
+  // Detect motion (sampling task handles it when the IMU interrupt is wired)
+  if (!motionDetector.isSamplingTaskRunning()) {
+    motionDetector.detectMotion();
+  }
+  bool isMoving = motionDetector.isMoving();
+  motionDetector.saveBaselineIfPending();
   
   // Update smart light controller (main automatic logic)
   smartLight.update();
@@ -302,12 +347,18 @@ void loop() {
       } else {
         // Display is on, execute action
         Serial.println("\n[RED BTN] Recalibrating IMU...");
-        displayManager.showMessage("Calibrating IMU...", 2000);
-        motionDetector.calibrate();
-        DebugHelper::printCalibrationValues(motionDetector);
+        if (motionDetector.isBaselineTracking()) {
+          // Non-blocking: the baseline converges over the next quiet samples
+          motionDetector.recalibrate();
+          displayManager.showMessage("Keep still...", 2000);
+        } else {
+          displayManager.showMessage("Calibrating IMU...", 2000);
+          motionDetector.calibrate();
+          DebugHelper::printCalibrationValues(motionDetector);
+          displayManager.showMessage("IMU Calibrated!", 2000);
+        }
         smartLight.saveConfiguration();
         Serial.println("Configuration saved after calibration");
-        displayManager.showMessage("IMU Calibrated!", 2000);
       }
       lastButtonPress = millis();
     } else if (digitalRead(BTN_L) == LOW) {
@@ -0,0 +1,51 @@
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+/*
+ * Minimal helpers for the host microbenchmarks. Each benchmark is a plain
+ * executable; timings are the best of several repeats (least disturbed by
+ * the OS) in nanoseconds per iteration. Host numbers only compare variants
+ * with each other: absolute costs on the ESP32 differ (no 64-bit multiplier,
+ * single-precision FPU). --quick runs a few iterations so ctest can smoke
+ * test the benchmarks without timing anything meaningful.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+
+// Results are accumulated here so the optimiser cannot drop the measured work
+static volatile uint64_t g_benchSink = 0;
+
+static bool benchQuick(int argc, char** argv) {
+    return argc > 1 && strcmp(argv[1], "--quick") == 0;
+}
+
+/**
+ * @brief Best time per iteration of body(i) for i in [0, iterations), in ns
+ */
+template <class Body>
+static double benchNs(uint32_t iterations, Body body, int repeats = 5) {
+    double best = 0;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            body(i);
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        double perIteration = elapsed.count() / iterations;
+        if (r == 0 || perIteration < best) best = perIteration;
+    }
+    return best;
+}
+
+static void benchReport(const char* name, double ns, double baselineNs = 0) {
+    if (baselineNs > 0) {
+        printf("  %-36s %8.2f ns  (%.2fx)\n", name, ns, ns / baselineNs);
+    } else {
+        printf("  %-36s %8.2f ns\n", name, ns);
+    }
+}
+
+#endif // HOST_BENCH_H
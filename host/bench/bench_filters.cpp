@@ -0,0 +1,214 @@
+/*
+ * Cost of the fixed-point signal processing run on every full-rate sample.
+ *
+ * 1. MotionFilterChain (0.5 Hz high-pass + 15 Hz biquad low-pass, Q28
+ *    coefficients, Q8 signal) on three axes, against the same chain in float.
+ *    The outputs must agree within a few counts and the response must match
+ *    the design: 5 Hz passes, 60 Hz (blade band) is strongly attenuated.
+ * 2. GoertzelBank with the detector's 8 bins, against a float Goertzel over
+ *    the same bins. A 50 Hz tone must land in the 50 Hz bin at the documented
+ *    power (A * N / 2)^2.
+ */
+
+#include "HostBench.h"
+#include "MotionDetector.h"
+#include <vector>
+
+#define BENCH_ODR acc_odr_250
+#define BENCH_SAMPLES 4000          // 16 s at 250 Hz
+
+static const float BINS_HZ[] = MOTION_SPECTRUM_BINS_HZ;
+
+// The chain's design equations, evaluated and run in float
+class FloatChain {
+public:
+    void configure(uint32_t periodUs) {
+        double dt = periodUs * 1e-6, fs = 1e6 / periodUs;
+        double rc = 1.0 / (2 * M_PI * MOTION_HP_CUTOFF_MHZ * 1e-3);
+        _a = (float)(rc / (rc + dt));
+        double w0 = 2 * M_PI * MOTION_LP_CUTOFF_MHZ * 1e-3 / fs;
+        double alpha = sin(w0) / (2 * 0.707), a0 = 1 + alpha;
+        _b0 = (float)((1 - cos(w0)) / 2 / a0);
+        _b1 = (float)((1 - cos(w0)) / a0);
+        _a1 = (float)(-2 * cos(w0) / a0);
+        _a2 = (float)((1 - alpha) / a0);
+        _primed = false;
+    }
+
+    void process(const int16_t* in, int16_t* out) {
+        for (int axis = 0; axis < 3; axis++) {
+            float x = in[axis];
+            State& s = _s[axis];
+            if (!_primed) {
+                s.hx = x;
+                s.hy = s.x1 = s.x2 = s.y1 = s.y2 = 0;
+            }
+            s.hy = _a * (s.hy + x - s.hx);
+            s.hx = x;
+            float y = _b0 * s.hy + _b1 * s.x1 + _b0 * s.x2 - _a1 * s.y1 - _a2 * s.y2;
+            s.x2 = s.x1; s.x1 = s.hy;
+            s.y2 = s.y1; s.y1 = y;
+            out[axis] = (int16_t)constrain(lrintf(y), -32768L, 32767L);
+        }
+        _primed = true;
+    }
+
+private:
+    struct State { float hx, hy, x1, x2, y1, y2; };
+    State _s[3];
+    float _a, _b0, _b1, _a1, _a2;
+    bool _primed;
+};
+
+// Goertzel over the same bins (rounded to multiples of fs/N), float state
+class FloatGoertzel {
+public:
+    void configure(uint32_t periodUs, uint16_t blockLength) {
+        double fs = 1e6 / periodUs;
+        _n = 0;
+        _blockLength = blockLength;
+        for (int b = 0; b < MOTION_SPECTRUM_BIN_COUNT; b++) {
+            double k = floor(BINS_HZ[b] * blockLength / fs + 0.5);
+            _coeff[b] = (float)(2 * cos(2 * M_PI * k / blockLength));
+        }
+        memset(_s1, 0, sizeof(_s1));
+        memset(_s2, 0, sizeof(_s2));
+    }
+
+    bool push(const int16_t* xyz) {
+        for (int axis = 0; axis < 3; axis++) {
+            float x = xyz[axis];
+            for (int b = 0; b < MOTION_SPECTRUM_BIN_COUNT; b++) {
+                float s = x + _coeff[b] * _s1[axis][b] - _s2[axis][b];
+                _s2[axis][b] = _s1[axis][b];
+                _s1[axis][b] = s;
+            }
+        }
+        if (++_n < _blockLength) return false;
+        for (int b = 0; b < MOTION_SPECTRUM_BIN_COUNT; b++) {
+            _power[b] = 0;
+            for (int axis = 0; axis < 3; axis++) {
+                float s1 = _s1[axis][b], s2 = _s2[axis][b];
+                _power[b] += s1 * s1 + s2 * s2 - _coeff[b] * s1 * s2;
+                _s1[axis][b] = _s2[axis][b] = 0;
+            }
+        }
+        _n = 0;
+        return true;
+    }
+
+    float getPower(int bin) const { return _power[bin]; }
+
+private:
+    uint16_t _n, _blockLength;
+    float _coeff[MOTION_SPECTRUM_BIN_COUNT];
+    float _s1[3][MOTION_SPECTRUM_BIN_COUNT];
+    float _s2[3][MOTION_SPECTRUM_BIN_COUNT];
+    float _power[MOTION_SPECTRUM_BIN_COUNT];
+};
+
+struct Xyz {
+    int16_t v[3];
+};
+
+static std::vector<Xyz> tone(float hz, float amplitude, uint32_t periodUs) {
+    std::vector<Xyz> samples(BENCH_SAMPLES);
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        float phase = 2.0f * (float)PI * hz * i * periodUs * 1e-6f;
+        samples[i].v[0] = (int16_t)lrintf(amplitude * sinf(phase));
+        samples[i].v[1] = (int16_t)lrintf(0.5f * amplitude * cosf(phase));
+        samples[i].v[2] = (int16_t)(16384 + lrintf(0.25f * amplitude * sinf(phase)));
+    }
+    return samples;
+}
+
+// Peak |x| output over the last half of the run (filter settled)
+static float settledPeak(const std::vector<Xyz>& in, int& maxDiff) {
+    IirFilter3<MotionFilterChain> fixed;
+    FloatChain reference;
+    uint32_t periodUs = QMI8658_ACC_ODR_PERIOD_US[BENCH_ODR];
+    fixed.configure(BENCH_ODR);
+    reference.configure(periodUs);
+
+    int peak = 0;
+    for (size_t i = 0; i < in.size(); i++) {
+        int16_t a[3], b[3];
+        fixed.process(in[i].v, a);
+        reference.process(in[i].v, b);
+        for (int axis = 0; axis < 3; axis++) maxDiff = std::max(maxDiff, abs(a[axis] - b[axis]));
+        if (i >= in.size() / 2) peak = std::max(peak, abs((int)a[0]));
+    }
+    return (float)peak;
+}
+
+int main(int argc, char** argv) {
+    bool quick = benchQuick(argc, argv);
+    uint32_t rounds = quick ? 1 : 100;
+    uint32_t periodUs = QMI8658_ACC_ODR_PERIOD_US[BENCH_ODR];
+    int failures = 0;
+
+    // Response and agreement with the float design
+    int maxDiff = 0;
+    float gain5 = settledPeak(tone(5.0f, 4000.0f, periodUs), maxDiff) / 4000.0f;
+    float gain60 = settledPeak(tone(60.0f, 4000.0f, periodUs), maxDiff) / 4000.0f;
+    printf("filter chain: gain %.3f at 5 Hz, %.4f at 60 Hz (1/%.0f); fixed vs float max diff %d counts\n",
+           gain5, gain60, 1.0f / gain60, maxDiff);
+    if (gain5 < 0.95f || gain5 > 1.05f || gain60 > 0.1f || maxDiff > 4) failures++;
+
+    // Goertzel: 50 Hz tone of amplitude 1000 on x only
+    GoertzelBank bank;
+    FloatGoertzel floatBank;
+    bank.configure(periodUs, MOTION_SPECTRUM_BLOCK, BINS_HZ, MOTION_SPECTRUM_BIN_COUNT);
+    floatBank.configure(periodUs, MOTION_SPECTRUM_BLOCK);
+    std::vector<Xyz> blade = tone(50.0f, 1000.0f, periodUs);
+    for (Xyz& s : blade) {
+        s.v[1] = 0;
+        s.v[2] = 16384;
+    }
+    for (int i = 0; i < 2 * MOTION_SPECTRUM_BLOCK; i++) {
+        bank.push(blade[i].v);
+        floatBank.push(blade[i].v);
+    }
+    double expected = (1000.0 * MOTION_SPECTRUM_BLOCK / 2) * (1000.0 * MOTION_SPECTRUM_BLOCK / 2);
+    int peakBin = 0;
+    for (int b = 0; b < MOTION_SPECTRUM_BIN_COUNT; b++) {
+        if (bank.getPower(b) > bank.getPower(peakBin)) peakBin = b;
+    }
+    double ratio = bank.getPower(peakBin) / expected;
+    printf("goertzel: 50 Hz tone in the %.0f Hz bin at %.3f of (A*N/2)^2 (float %.3f)\n",
+           BINS_HZ[peakBin], ratio, floatBank.getPower(peakBin) / expected);
+    if (BINS_HZ[peakBin] != 50.0f || ratio < 0.95 || ratio > 1.05) failures++;
+
+    // Cost per 3-axis sample
+    std::vector<Xyz> input = tone(5.0f, 4000.0f, periodUs);
+    const uint32_t iterations = rounds * BENCH_SAMPLES;
+
+    IirFilter3<MotionFilterChain> fixed;
+    FloatChain reference;
+    fixed.configure(BENCH_ODR);
+    reference.configure(periodUs);
+    int16_t out[3];
+    double floatChainNs = benchNs(iterations, [&](uint32_t i) {
+        reference.process(input[i % BENCH_SAMPLES].v, out);
+        g_benchSink += out[0];
+    });
+    double fixedChainNs = benchNs(iterations, [&](uint32_t i) {
+        fixed.process(input[i % BENCH_SAMPLES].v, out);
+        g_benchSink += out[0];
+    });
+    printf("HP + biquad LP, 3 axes, per sample\n");
+    benchReport("float", floatChainNs);
+    benchReport("fixed point Q28 (IirFilter3)", fixedChainNs, floatChainNs);
+
+    double floatGoertzelNs = benchNs(iterations, [&](uint32_t i) {
+        g_benchSink += floatBank.push(input[i % BENCH_SAMPLES].v);
+    });
+    double fixedGoertzelNs = benchNs(iterations, [&](uint32_t i) {
+        g_benchSink += bank.push(input[i % BENCH_SAMPLES].v);
+    });
+    printf("Goertzel, %d bins x 3 axes, per sample (block of %d)\n", MOTION_SPECTRUM_BIN_COUNT, MOTION_SPECTRUM_BLOCK);
+    benchReport("float", floatGoertzelNs);
+    benchReport("fixed point Q28 (GoertzelBank)", fixedGoertzelNs, floatGoertzelNs);
+
+    return failures ? 1 : 0;
+}
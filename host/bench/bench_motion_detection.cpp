@@ -0,0 +1,178 @@
+/*
+ * Cost of the fixed-point motion decision.
+ *
+ * 1. Per-sample deviation test: the float path the detector used before it
+ *    worked in counts (scale to g/dps, fabs, sqrt, compare) against the
+ *    integer path (int32 differences, 64-bit squared sum, squared threshold
+ *    precomputed in counts). Both decide the same samples; the benchmark
+ *    fails if they ever disagree.
+ * 2. Whole per-sample pipeline (MotionDetector::feedRecord) per detection mode.
+ */
+
+#include "HostBench.h"
+#include "TraceReplay.h"
+#include <memory>
+#include <vector>
+
+#define BENCH_SAMPLES 4096
+#define BENCH_ACC_1G 16384         // acc_scale_2g
+#define BENCH_GYRO_1DPS 1024       // gyro_scale_32dps
+
+static uint32_t g_seed = 1;
+
+static int16_t noise(int amplitude) {
+    g_seed = g_seed * 1103515245UL + 12345UL;
+    return (int16_t)((int)((g_seed >> 16) % (2 * amplitude + 1)) - amplitude);
+}
+
+struct Sample {
+    int16_t acc[3];
+    int16_t gyro[3];
+};
+
+// Stationary noise with bursts of motion: about a third of the samples are above threshold
+static std::vector<Sample> makeSamples() {
+    std::vector<Sample> samples(BENCH_SAMPLES);
+    g_seed = 1;
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        bool burst = (i / 256) % 3 == 2;
+        int accNoise = burst ? 4000 : 60;
+        int gyroNoise = burst ? 8000 : 20;
+        samples[i].acc[0] = noise(accNoise);
+        samples[i].acc[1] = noise(accNoise);
+        samples[i].acc[2] = BENCH_ACC_1G + noise(accNoise);
+        for (int axis = 0; axis < 3; axis++) samples[i].gyro[axis] = noise(gyroNoise);
+    }
+    return samples;
+}
+
+// Before: g/dps floats and a sqrt per sensor
+static bool floatDecision(const Sample& s, const float* accBase, const float* gyroBase,
+                          float accThreshold, float gyroThreshold) {
+    float acc[3], gyro[3];
+    for (int axis = 0; axis < 3; axis++) {
+        acc[axis] = (float)s.acc[axis] / BENCH_ACC_1G;
+        gyro[axis] = (float)s.gyro[axis] / BENCH_GYRO_1DPS;
+    }
+    float ax = fabsf(acc[0] - accBase[0]), ay = fabsf(acc[1] - accBase[1]), az = fabsf(acc[2] - accBase[2]);
+    float gx = fabsf(gyro[0] - gyroBase[0]), gy = fabsf(gyro[1] - gyroBase[1]), gz = fabsf(gyro[2] - gyroBase[2]);
+    float accDev = sqrtf(ax * ax + ay * ay + az * az);
+    float gyroDev = sqrtf(gx * gx + gy * gy + gz * gz);
+    return accDev > accThreshold || gyroDev > gyroThreshold;
+}
+
+// Now: counts, squared on both sides
+static bool integerDecision(const Sample& s, const int16_t* accBase, const int16_t* gyroBase,
+                            uint32_t accThresholdSq, uint32_t gyroThresholdSq) {
+    uint64_t accSq = 0, gyroSq = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        int32_t a = (int32_t)s.acc[axis] - accBase[axis];
+        int32_t g = (int32_t)s.gyro[axis] - gyroBase[axis];
+        accSq += (int64_t)a * a;
+        gyroSq += (int64_t)g * g;
+    }
+    return accSq > accThresholdSq || gyroSq > gyroThresholdSq;
+}
+
+static std::vector<ImuTraceRecord> makeRecords(const std::vector<Sample>& samples) {
+    std::vector<ImuTraceRecord> records(samples.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        memset(&records[i], 0, sizeof(records[i]));
+        records[i].timestamp = 1000 + i;
+        records[i].flags = IMU_TRACE_FLAG_HIGH_RATE | (i == 0 ? IMU_TRACE_FLAG_RESYNC : 0);
+        memcpy(records[i].acc, samples[i].acc, sizeof(records[i].acc));
+        memcpy(records[i].gyro, samples[i].gyro, sizeof(records[i].gyro));
+        records[i].temperature = 30 * TEMPERATURE_SENSOR_RESOLUTION;
+    }
+    return records;
+}
+
+static ImuTraceHeader makeHeader() {
+    ImuTraceHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = IMU_TRACE_MAGIC;
+    header.version = IMU_TRACE_VERSION;
+    header.recordSize = sizeof(ImuTraceRecord);
+    header.highOdr = acc_odr_250;
+    header.idleOdr = acc_odr_21;
+    header.accScale = acc_scale_2g;
+    header.gyroScale = gyro_scale_32dps;
+    header.accSensitivity = BENCH_ACC_1G;
+    header.gyroSensitivity = BENCH_GYRO_1DPS;
+    header.highPeriodUs = QMI8658_ACC_ODR_PERIOD_US[acc_odr_250];
+    header.idlePeriodUs = QMI8658_ACC_ODR_PERIOD_US[acc_odr_21];
+    return header;
+}
+
+int main(int argc, char** argv) {
+    bool quick = benchQuick(argc, argv);
+    uint32_t rounds = quick ? 1 : 200;
+    Serial.setQuiet(true);
+
+    std::vector<Sample> samples = makeSamples();
+    const float accThreshold = 0.10f, gyroThreshold = 5.0f;
+    const float accBaseF[3] = { 0, 0, 1.0f };
+    const float gyroBaseF[3] = { 0, 0, 0 };
+    const int16_t accBase[3] = { 0, 0, BENCH_ACC_1G };
+    const int16_t gyroBase[3] = { 0, 0, 0 };
+    const uint32_t accThresholdSq = (uint32_t)(accThreshold * BENCH_ACC_1G * accThreshold * BENCH_ACC_1G);
+    const uint32_t gyroThresholdSq = (uint32_t)(gyroThreshold * BENCH_GYRO_1DPS * gyroThreshold * BENCH_GYRO_1DPS);
+
+    // Same decisions (thresholds fall between count steps, so no rounding ties)
+    int mismatches = 0, above = 0;
+    for (const Sample& s : samples) {
+        bool f = floatDecision(s, accBaseF, gyroBaseF, accThreshold, gyroThreshold);
+        bool i = integerDecision(s, accBase, gyroBase, accThresholdSq, gyroThresholdSq);
+        if (f != i) mismatches++;
+        if (i) above++;
+    }
+    printf("deviation test: %d samples, %d above threshold, %d float/integer mismatches\n",
+           BENCH_SAMPLES, above, mismatches);
+
+    const uint32_t iterations = rounds * BENCH_SAMPLES;
+    double floatNs = benchNs(iterations, [&](uint32_t i) {
+        g_benchSink += floatDecision(samples[i % BENCH_SAMPLES], accBaseF, gyroBaseF, accThreshold, gyroThreshold);
+    });
+    double integerNs = benchNs(iterations, [&](uint32_t i) {
+        g_benchSink += integerDecision(samples[i % BENCH_SAMPLES], accBase, gyroBase, accThresholdSq, gyroThresholdSq);
+    });
+    printf("per-sample deviation test\n");
+    benchReport("float g/dps + sqrtf (before)", floatNs);
+    benchReport("int32 counts, squared (now)", integerNs, floatNs);
+
+    // Whole pipeline, fresh detector per mode
+    std::vector<ImuTraceRecord> records = makeRecords(samples);
+    struct Variant {
+        const char* name;
+        MotionDetector::DetectionMode mode;
+        bool filter;
+    };
+    static const Variant VARIANTS[] = {
+        { "pulse, baseline (no filter)", MotionDetector::DetectionMode::PULSE, false },
+        { "pulse, IIR filtered", MotionDetector::DetectionMode::PULSE, true },
+        { "window rms", MotionDetector::DetectionMode::WINDOW_RMS, true },
+        { "window variance", MotionDetector::DetectionMode::WINDOW_VARIANCE, true },
+        { "spectral", MotionDetector::DetectionMode::SPECTRAL, true },
+        { "hybrid", MotionDetector::DetectionMode::HYBRID, true },
+    };
+    printf("MotionDetector::feedRecord per sample (250 Hz, gyro on)\n");
+    for (const Variant& variant : VARIANTS) {
+        TraceReplay::Options options;
+        options.mode = variant.mode;
+        options.filter = variant.filter;
+        std::unique_ptr<TraceReplay> replay(new TraceReplay());
+        if (!replay->begin(makeHeader(), options)) {
+            fprintf(stderr, "%s: replay setup failed\n", variant.name);
+            return 1;
+        }
+        MotionDetector& detector = replay->getDetector();
+        double ns = benchNs(iterations, [&](uint32_t i) {
+            ImuTraceRecord record = records[i % BENCH_SAMPLES];
+            record.timestamp = 1000 + i;    // Keep the counter moving across rounds
+            g_benchSink += detector.feedRecord(record);
+        }, 1);
+        benchReport(variant.name, ns);
+    }
+
+    return mismatches ? 1 : 0;
+}
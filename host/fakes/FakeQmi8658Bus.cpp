@@ -0,0 +1,85 @@
+#include "FakeQmi8658Bus.h"
+#include <Wire.h>
+
+#define FAKE_QMI8658_WHO_AM_I 0x05
+
+FakeQmi8658Bus::FakeQmi8658Bus()
+    : I2CBus(Wire, 0, 0)
+    , _pointer(0)
+    , _timestamp(0)
+    , _tempReads(0)
+    , _reads(0)
+{
+    reset();
+}
+
+void FakeQmi8658Bus::reset() {
+    memset(_regs, 0, sizeof(_regs));
+    _regs[QMI8658_WHO_AM_I] = FAKE_QMI8658_WHO_AM_I;
+}
+
+uint8_t FakeQmi8658Bus::reg(uint8_t address) const {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _regs[address];
+}
+
+void FakeQmi8658Bus::setSample(const int16_t* acc, const int16_t* gyro, int16_t temperature) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _timestamp = (_timestamp + 1) & 0x00FFFFFF;
+    _regs[QMI8658_TIMESTAMP_L] = _timestamp & 0xFF;
+    _regs[QMI8658_TIMESTAMP_M] = (_timestamp >> 8) & 0xFF;
+    _regs[QMI8658_TIMESTAMP_H] = (_timestamp >> 16) & 0xFF;
+    _regs[QMI8658_TEMP_L] = temperature & 0xFF;
+    _regs[QMI8658_TEMP_H] = (temperature >> 8) & 0xFF;
+    for (int axis = 0; axis < 3; axis++) {
+        _regs[QMI8658_ACC_X_L + 2 * axis] = acc[axis] & 0xFF;
+        _regs[QMI8658_ACC_X_H + 2 * axis] = (acc[axis] >> 8) & 0xFF;
+        _regs[QMI8658_GYR_X_L + 2 * axis] = gyro[axis] & 0xFF;
+        _regs[QMI8658_GYR_X_H + 2 * axis] = (gyro[axis] >> 8) & 0xFF;
+    }
+}
+
+void FakeQmi8658Bus::writeReg(uint8_t address, uint8_t value) {
+    if (address == QMI8658_RESET) {
+        reset();
+        return;
+    }
+
+    if (address == QMI8658_CTRL9) {
+        // Host command handshake: done at once, cleared by the ACK
+        if (value == QMI8658_CTRL_CMD_ACK) {
+            _regs[QMI8658_STATUSINT] &= ~QMI8658_STATUSINT_CMD_DONE;
+        } else {
+            _regs[QMI8658_STATUSINT] |= QMI8658_STATUSINT_CMD_DONE;
+        }
+    }
+    _regs[address] = value;
+}
+
+uint8_t FakeQmi8658Bus::hwWrite(uint8_t, const uint8_t* data, uint8_t len, bool, uint16_t) {
+    if (len == 0) return 0;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    _pointer = data[0];
+    for (uint8_t i = 1; i < len; i++) {
+        writeReg(_pointer++, data[i]);
+    }
+    return 0;
+}
+
+uint8_t FakeQmi8658Bus::hwRead(uint8_t, uint8_t* buf, uint8_t len, uint16_t) {
+    std::lock_guard<std::mutex> guard(_lock);
+
+    // FIFO_DATA does not auto-increment
+    bool fixed = (_pointer == QMI8658_FIFO_DATA);
+
+    if (_pointer <= QMI8658_TEMP_L && (uint16_t)_pointer + len > QMI8658_TEMP_L && !fixed) {
+        _tempReads++;
+    }
+    _reads++;
+
+    for (uint8_t i = 0; i < len; i++) {
+        buf[i] = _regs[fixed ? _pointer : (uint8_t)(_pointer + i)];
+    }
+    return 0;
+}
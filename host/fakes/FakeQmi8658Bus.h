@@ -0,0 +1,50 @@
+#ifndef FAKE_QMI8658_BUS_H
+#define FAKE_QMI8658_BUS_H
+
+#include <Arduino.h>
+#include <mutex>
+#include "I2CBus.h"
+#include "Qmi8658c.h"
+
+/**
+ * @brief I2CBus whose only device is an emulated QMI8658 register file
+ *
+ * Writes land in the register array (address auto-increment), reads come
+ * from it, and CTRL9 commands complete their handshake immediately. Output
+ * samples are placed with setSample(), which also advances the 24-bit
+ * sample counter. The FIFO is not emulated (it always reports empty), so
+ * tests run the detector in bypass mode. The register file is locked, so a
+ * test thread can place samples while a sampling task reads them.
+ */
+class FakeQmi8658Bus : public I2CBus {
+public:
+    FakeQmi8658Bus();
+
+    // Put a new output sample in the data registers (one sensor sample later)
+    void setSample(const int16_t* acc, const int16_t* gyro, int16_t temperature);
+
+    uint8_t reg(uint8_t address) const;
+
+    // Register reads that covered TEMP_L since the last clearCounters()
+    uint32_t getTempReads() const { return _tempReads; }
+    uint32_t getReads() const { return _reads; }
+    void clearCounters() { _tempReads = 0; _reads = 0; }
+
+protected:
+    uint8_t hwWrite(uint8_t address, const uint8_t* data, uint8_t len, bool sendStop, uint16_t timeoutMs) override;
+    uint8_t hwRead(uint8_t address, uint8_t* buf, uint8_t len, uint16_t timeoutMs) override;
+    void hwRecover() override {}
+
+private:
+    mutable std::mutex _lock;
+    uint8_t _regs[256];
+    uint8_t _pointer;
+    uint32_t _timestamp;
+    uint32_t _tempReads;
+    uint32_t _reads;
+
+    void writeReg(uint8_t address, uint8_t value);
+    void reset();
+};
+
+#endif // FAKE_QMI8658_BUS_H
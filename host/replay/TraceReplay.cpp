@@ -0,0 +1,181 @@
+#include "TraceReplay.h"
+#include <Preferences.h>
+#include <algorithm>
+
+TraceReplay::TraceReplay()
+    : _imu(_bus, QMI_REPLAY_ADDRESS)
+    , _detector(&_imu)
+    , _started(false)
+    , _originMs(0)
+    , _traceMs(0)
+    , _records(0)
+    , _moving(false)
+{
+    memset(&_header, 0, sizeof(_header));
+}
+
+bool TraceReplay::begin(const ImuTraceHeader& header, const Options& options) {
+    if (header.magic != IMU_TRACE_MAGIC || header.version != IMU_TRACE_VERSION ||
+        header.recordSize != sizeof(ImuTraceRecord)) {
+        return false;
+    }
+    // Without a filter or baseline tracking the detector would need calibrate()
+    if (!options.filter && !options.baselineTracking) {
+        return false;
+    }
+
+    _header = header;
+    _options = options;
+
+    // No baseline from an earlier run: every replay starts from the same state
+    Preferences::hostClear();
+    _bus.begin(400000);
+
+    qmi8658_cfg_t cfg;
+    cfg.qmi8658_mode = qmi8658_mode_dual;
+    cfg.acc_scale = (acc_scale_t)header.accScale;
+    cfg.acc_odr = (acc_odr_t)header.highOdr;
+    cfg.gyro_scale = (gyro_scale_t)header.gyroScale;
+    cfg.gyro_odr = (header.highOdr <= gyro_odr_31_25) ? (gyro_odr_t)header.highOdr : gyro_odr_250;
+
+    _detector.setAccThreshold(options.accThreshold);
+    _detector.setGyroThreshold(options.gyroThreshold);
+    if (!_detector.begin(&cfg)) {
+        return false;
+    }
+    if (_imu.acc_sensitivity() != header.accSensitivity || _imu.gyro_sensitivity() != header.gyroSensitivity) {
+        return false;
+    }
+
+    _detector.setFilterEnabled(options.filter);
+    _detector.setBaselineTracking(options.baselineTracking);
+    _detector.setAxisWeighting(options.axisWeighting);
+    _detector.setDetectionMode(options.mode);
+    _detector.setWindowMs(options.windowMs);
+    _detector.setMotionStopDelayMs(options.stopDelayMs);
+
+    _started = false;
+    _traceMs = 0;
+    _records = 0;
+    _moving = false;
+    _episodes.clear();
+    return true;
+}
+
+void TraceReplay::feed(const ImuTraceRecord& record) {
+    bool moving = _detector.feedRecord(record);
+    unsigned long sensorMs = _detector.getSensorTimeMs();
+
+    if (!_started) {
+        _originMs = sensorMs;
+        _started = true;
+    }
+    _traceMs = sensorMs - _originMs;
+    _records++;
+
+    // Keep the virtual wall clock on trace time
+    hostSetMicros((uint64_t)(_header.startMs + _traceMs) * 1000);
+
+    if (moving && !_moving) {
+        Episode episode = { _traceMs, 0 };
+        _episodes.push_back(episode);
+    } else if (!moving && _moving) {
+        _episodes.back().endMs = _traceMs;
+    }
+    _moving = moving;
+}
+
+void TraceReplay::finish() {
+    if (_moving) {
+        _episodes.back().endMs = _traceMs;
+        _moving = false;
+    }
+}
+
+// Length of [start, end) covered by a sorted, merged interval list
+static uint32_t coveredMs(uint32_t start, uint32_t end, const std::vector<TraceReplay::Interval>& cover) {
+    uint32_t total = 0;
+    for (const TraceReplay::Interval& c : cover) {
+        uint32_t s = std::max(start, c.startMs);
+        uint32_t e = std::min(end, c.endMs);
+        if (e > s) total += e - s;
+    }
+    return total;
+}
+
+TraceReplay::Report TraceReplay::evaluate(const std::vector<Interval>& labels) const {
+    Report report;
+    report.records = _records;
+    report.durationMs = _traceMs;
+
+    for (const Episode& episode : _episodes) {
+        report.movingMs += episode.endMs - episode.startMs;
+    }
+
+    // Latency: label start to the first moving decision that overlaps it
+    uint64_t latencySum = 0;
+    for (const Interval& label : labels) {
+        bool found = false;
+        for (const Episode& episode : _episodes) {
+            if (episode.endMs > label.startMs && episode.startMs < label.endMs) {
+                uint32_t latency = (episode.startMs > label.startMs) ? episode.startMs - label.startMs : 0;
+                latencySum += latency;
+                report.maxLatencyMs = std::max(report.maxLatencyMs, latency);
+                found = true;
+                break;
+            }
+        }
+        if (found) {
+            report.detected++;
+        } else {
+            report.missed++;
+        }
+    }
+    if (report.detected) {
+        report.meanLatencyMs = (uint32_t)(latencySum / report.detected);
+    }
+
+    // Moving is legitimate inside a label and for the stop delay after it
+    std::vector<Interval> cover = labels;
+    std::sort(cover.begin(), cover.end(), [](const Interval& a, const Interval& b) { return a.startMs < b.startMs; });
+    std::vector<Interval> merged;
+    for (Interval c : cover) {
+        c.endMs += _options.stopDelayMs;
+        if (!merged.empty() && c.startMs <= merged.back().endMs) {
+            merged.back().endMs = std::max(merged.back().endMs, c.endMs);
+        } else {
+            merged.push_back(c);
+        }
+    }
+
+    for (const Episode& episode : _episodes) {
+        bool insideLabel = false;
+        for (const Interval& label : labels) {
+            if (episode.startMs >= label.startMs && episode.startMs < label.endMs) {
+                insideLabel = true;
+                break;
+            }
+        }
+        if (!insideLabel) report.falsePositives++;
+        report.falsePositiveMs += (episode.endMs - episode.startMs) - coveredMs(episode.startMs, episode.endMs, merged);
+    }
+
+    return report;
+}
+
+bool TraceReplay::parseMode(const char* name, MotionDetector::DetectionMode& mode) {
+    static const MotionDetector::DetectionMode MODES[] = {
+        MotionDetector::DetectionMode::PULSE,
+        MotionDetector::DetectionMode::WINDOW_RMS,
+        MotionDetector::DetectionMode::WINDOW_VARIANCE,
+        MotionDetector::DetectionMode::SPECTRAL,
+        MotionDetector::DetectionMode::HYBRID
+    };
+    for (MotionDetector::DetectionMode candidate : MODES) {
+        if (strcmp(name, MotionDetector::modeName(candidate)) == 0) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
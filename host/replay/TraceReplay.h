@@ -0,0 +1,87 @@
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include <vector>
+#include "FakeQmi8658Bus.h"
+#include "MotionDetector.h"
+
+// Address of the emulated IMU (the fake bus answers any address)
+#define QMI_REPLAY_ADDRESS 0x6b
+
+/**
+ * @brief Runs a recorded IMU trace through MotionDetector on the host
+ *
+ * The detector is opened on an emulated QMI8658 with the trace header's
+ * scales and ODR, then fed every record with MotionDetector::feedRecord().
+ * All detector timing comes from the record sample counters; the virtual
+ * millis() clock is moved along with trace time so anything else reading
+ * it agrees. Decision changes are recorded as episodes and can be scored
+ * against labelled motion intervals.
+ */
+class TraceReplay {
+public:
+    struct Options {
+        MotionDetector::DetectionMode mode = MotionDetector::DetectionMode::PULSE;
+        bool filter = true;
+        bool baselineTracking = true;
+        bool axisWeighting = false;
+        float accThreshold = 0.10f;      // g
+        float gyroThreshold = 5.0f;      // dps
+        unsigned long windowMs = 250;
+        unsigned long stopDelayMs = 1000;
+    };
+
+    // Ground truth: the robot really moved in [startMs, endMs) (trace time)
+    struct Interval {
+        uint32_t startMs;
+        uint32_t endMs;
+    };
+
+    // One stretch of isMoving() == true (trace time)
+    struct Episode {
+        uint32_t startMs;
+        uint32_t endMs;
+    };
+
+    struct Report {
+        uint32_t records = 0;
+        uint32_t durationMs = 0;
+        uint32_t movingMs = 0;
+        uint32_t detected = 0;           // Labelled intervals with a moving decision inside
+        uint32_t missed = 0;
+        uint32_t meanLatencyMs = 0;      // Label start -> first moving decision
+        uint32_t maxLatencyMs = 0;
+        uint32_t falsePositives = 0;     // Episodes starting outside every label
+        uint32_t falsePositiveMs = 0;    // Moving time outside labels (+ stop delay)
+    };
+
+    TraceReplay();
+
+    bool begin(const ImuTraceHeader& header, const Options& options);
+    void feed(const ImuTraceRecord& record);
+    void finish();
+
+    const std::vector<Episode>& getEpisodes() const { return _episodes; }
+    uint32_t getTraceTimeMs() const { return _traceMs; }
+    MotionDetector& getDetector() { return _detector; }
+
+    Report evaluate(const std::vector<Interval>& labels) const;
+
+    static bool parseMode(const char* name, MotionDetector::DetectionMode& mode);
+
+private:
+    FakeQmi8658Bus _bus;
+    Qmi8658c _imu;
+    MotionDetector _detector;
+    ImuTraceHeader _header;
+    Options _options;
+
+    bool _started;
+    unsigned long _originMs;         // Sensor time of the first record
+    uint32_t _traceMs;
+    uint32_t _records;
+    bool _moving;
+    std::vector<Episode> _episodes;
+};
+
+#endif // TRACE_REPLAY_H
@@ -0,0 +1,151 @@
+/*
+ * imu_replay - run a binary IMU trace (GET /api/imu/trace) through the motion
+ * detector on the host and report decisions, detection latency and false positives.
+ *
+ *   imu_replay TRACE [--labels FILE] [--mode pulse|rms|variance|spectral|hybrid]
+ *              [--filter 0|1] [--tracking 0|1] [--weighting 0|1] [--acc G] [--gyro DPS]
+ *              [--window MS] [--stop-delay MS] [--verbose]
+ *
+ * The labels file holds one "start_ms end_ms" pair per line: intervals (trace
+ * time from the first record) in which the robot really moved. Lines starting
+ * with '#' are ignored. Without labels every moving episode is listed.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "TraceReplay.h"
+
+static void usage() {
+    fprintf(stderr, "usage: imu_replay TRACE [--labels FILE] [--mode NAME] [--filter 0|1] [--tracking 0|1]\n"
+                    "                  [--weighting 0|1] [--acc G] [--gyro DPS] [--window MS] [--stop-delay MS] [--verbose]\n");
+}
+
+static bool loadLabels(const char* path, std::vector<TraceReplay::Interval>& labels) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        unsigned long start, end;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%lu %lu", &start, &end) == 2 && end > start) {
+            TraceReplay::Interval interval = { (uint32_t)start, (uint32_t)end };
+            labels.push_back(interval);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+
+    const char* tracePath = argv[1];
+    const char* labelsPath = nullptr;
+    bool verbose = false;
+    TraceReplay::Options options;
+
+    for (int i = 2; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (strcmp(arg, "--verbose") == 0) {
+            verbose = true;
+            continue;
+        }
+        if (!value) {
+            usage();
+            return 2;
+        }
+        i++;
+
+        if (strcmp(arg, "--labels") == 0) {
+            labelsPath = value;
+        } else if (strcmp(arg, "--mode") == 0) {
+            if (!TraceReplay::parseMode(value, options.mode)) {
+                fprintf(stderr, "unknown mode: %s\n", value);
+                return 2;
+            }
+        } else if (strcmp(arg, "--filter") == 0) {
+            options.filter = atoi(value) != 0;
+        } else if (strcmp(arg, "--tracking") == 0) {
+            options.baselineTracking = atoi(value) != 0;
+        } else if (strcmp(arg, "--weighting") == 0) {
+            options.axisWeighting = atoi(value) != 0;
+        } else if (strcmp(arg, "--acc") == 0) {
+            options.accThreshold = atof(value);
+        } else if (strcmp(arg, "--gyro") == 0) {
+            options.gyroThreshold = atof(value);
+        } else if (strcmp(arg, "--window") == 0) {
+            options.windowMs = strtoul(value, nullptr, 10);
+        } else if (strcmp(arg, "--stop-delay") == 0) {
+            options.stopDelayMs = strtoul(value, nullptr, 10);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    Serial.setQuiet(!verbose);
+
+    FILE* trace = fopen(tracePath, "rb");
+    if (!trace) {
+        fprintf(stderr, "cannot open %s\n", tracePath);
+        return 1;
+    }
+
+    ImuTraceHeader header;
+    if (fread(&header, sizeof(header), 1, trace) != 1) {
+        fprintf(stderr, "%s: truncated header\n", tracePath);
+        fclose(trace);
+        return 1;
+    }
+
+    std::vector<TraceReplay::Interval> labels;
+    if (labelsPath && !loadLabels(labelsPath, labels)) {
+        fprintf(stderr, "cannot open %s\n", labelsPath);
+        fclose(trace);
+        return 1;
+    }
+
+    // Large object (detector + capture buffer): keep it off the stack
+    static TraceReplay replay;
+    if (!replay.begin(header, options)) {
+        fprintf(stderr, "%s: unsupported trace (magic %08x, version %u, record size %u) or options\n",
+                tracePath, header.magic, header.version, header.recordSize);
+        fclose(trace);
+        return 1;
+    }
+
+    ImuTraceRecord record;
+    while (fread(&record, sizeof(record), 1, trace) == 1) {
+        replay.feed(record);
+    }
+    fclose(trace);
+    replay.finish();
+
+    MotionDetector& detector = replay.getDetector();
+    TraceReplay::Report report = replay.evaluate(labels);
+
+    printf("mode            %s\n", MotionDetector::modeName(options.mode));
+    printf("records         %u (%u dropped, %u duplicate)\n", report.records,
+           detector.getDroppedSamples(), detector.getDuplicateSamples());
+    printf("duration        %u ms\n", report.durationMs);
+    printf("moving          %u ms in %zu episodes\n", report.movingMs, replay.getEpisodes().size());
+
+    if (labels.empty()) {
+        for (const TraceReplay::Episode& episode : replay.getEpisodes()) {
+            printf("  episode       %u .. %u ms\n", episode.startMs, episode.endMs);
+        }
+        return 0;
+    }
+
+    printf("labels          %zu (%u detected, %u missed)\n", labels.size(), report.detected, report.missed);
+    printf("latency         mean %u ms, max %u ms\n", report.meanLatencyMs, report.maxLatencyMs);
+    printf("false positives %u episodes, %u ms\n", report.falsePositives, report.falsePositiveMs);
+    return 0;
+}
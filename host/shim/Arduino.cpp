@@ -0,0 +1,159 @@
+#include "Arduino.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+// ==================== Virtual clock ====================
+
+static std::atomic<uint64_t> g_micros(0);
+
+unsigned long millis() { return (unsigned long)(uint32_t)(g_micros.load() / 1000); }
+unsigned long micros() { return (unsigned long)(uint32_t)g_micros.load(); }
+void delay(uint32_t ms) { g_micros += (uint64_t)ms * 1000; }
+void delayMicroseconds(uint32_t us) { g_micros += us; }
+
+void hostSetMicros(uint64_t us) { g_micros = us; }
+void hostAdvanceMicros(uint64_t us) { g_micros += us; }
+uint64_t hostMicros() { return g_micros.load(); }
+
+// ==================== GPIO ====================
+
+struct HostPin {
+    uint8_t mode;
+    uint8_t level;
+    void (*isr)(void*);
+    void* arg;
+};
+
+static HostPin g_pins[HOST_MAX_PINS];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < HOST_MAX_PINS) g_pins[pin].mode = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < HOST_MAX_PINS) g_pins[pin].level = value;
+}
+
+int digitalRead(uint8_t pin) {
+    // Floating inputs read high (pull-ups), like an idle I2C line
+    if (pin >= HOST_MAX_PINS) return HIGH;
+    return (g_pins[pin].mode == OUTPUT || g_pins[pin].mode == OUTPUT_OPEN_DRAIN) ? g_pins[pin].level : HIGH;
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int) {
+    if (pin >= HOST_MAX_PINS) return;
+    g_pins[pin].isr = isr;
+    g_pins[pin].arg = arg;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin < HOST_MAX_PINS) g_pins[pin].isr = nullptr;
+}
+
+bool hostRaiseInterrupt(uint8_t pin) {
+    if (pin >= HOST_MAX_PINS || !g_pins[pin].isr) return false;
+    g_pins[pin].isr(g_pins[pin].arg);
+    return true;
+}
+
+// ==================== Serial ====================
+
+// Log output goes to stderr so tool reports on stdout stay machine-readable
+HostSerial Serial;
+
+void HostSerial::print(const char* s) { if (!_quiet) fputs(s, stderr); }
+void HostSerial::print(char c) { if (!_quiet) fputc(c, stderr); }
+void HostSerial::print(long v) { if (!_quiet) fprintf(stderr, "%ld", v); }
+void HostSerial::print(unsigned long v) { if (!_quiet) fprintf(stderr, "%lu", v); }
+void HostSerial::print(double v, int digits) { if (!_quiet) fprintf(stderr, "%.*f", digits, v); }
+
+// ==================== ESP ====================
+
+HostEsp ESP;
+
+uint32_t HostEsp::getCycleCount() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ==================== FreeRTOS ====================
+
+struct HostTask {
+    std::mutex lock;
+    std::condition_variable wake;
+    uint32_t notifications = 0;
+};
+
+struct HostMutex {
+    std::timed_mutex mutex;
+};
+
+static thread_local HostTask* t_currentTask = nullptr;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t, void* arg,
+                                   UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    // Tasks never return in the sketch: the thread is detached and lives until exit
+    HostTask* task = new HostTask();
+    if (handle) *handle = task;
+    std::thread([task, fn, arg]() {
+        t_currentTask = task;
+        fn(arg);
+    }).detach();
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    HostTask* task = t_currentTask;
+    if (!task) return 0;
+
+    // Blocking time is real time: only the sampling clock is virtual
+    std::unique_lock<std::mutex> guard(task->lock);
+    if (ticks == portMAX_DELAY) {
+        task->wake.wait(guard, [task]() { return task->notifications > 0; });
+    } else {
+        task->wake.wait_for(guard, std::chrono::milliseconds(ticks), [task]() { return task->notifications > 0; });
+    }
+    uint32_t count = task->notifications;
+    if (clearOnExit) {
+        task->notifications = 0;
+    } else if (count) {
+        task->notifications--;
+    }
+    return count;
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+    if (!task) return;
+    {
+        std::lock_guard<std::mutex> guard(task->lock);
+        task->notifications++;
+    }
+    task->wake.notify_one();
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+    if (woken) *woken = pdTRUE;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new HostMutex();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        mutex->mutex.lock();
+        return pdTRUE;
+    }
+    return mutex->mutex.try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex) {
+    mutex->mutex.unlock();
+    return pdTRUE;
+}
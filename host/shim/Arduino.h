@@ -0,0 +1,133 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/*
+ * Minimal Arduino-ESP32 surface for building the sketch's sensor and detection
+ * classes on a Linux host. Time is virtual: millis()/micros() only move when
+ * delay() is called or a test/replay sets them (hostSetMicros()), so runs are
+ * reproducible and independent of the wall clock. FreeRTOS tasks and mutexes
+ * map to std::thread and std::timed_mutex.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <cstdlib>
+
+using std::min;
+using std::max;
+using std::abs;
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define IRAM_ATTR
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define OUTPUT_OPEN_DRAIN 0x13
+#define RISING 0x01
+#define FALLING 0x02
+
+#define HOST_MAX_PINS 64
+
+// ==================== Virtual clock ====================
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void hostSetMicros(uint64_t us);
+void hostAdvanceMicros(uint64_t us);
+uint64_t hostMicros();
+
+// ==================== GPIO ====================
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+#define digitalPinToInterrupt(p) (p)
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+// Run the ISR attached to a pin, as the GPIO interrupt would
+bool hostRaiseInterrupt(uint8_t pin);
+
+// ==================== Serial ====================
+
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+    void setQuiet(bool quiet) { _quiet = quiet; }
+
+    void print(const char* s);
+    void print(char c);
+    void print(bool b) { print(b ? 1 : 0); }
+    void print(int v) { print((long)v); }
+    void print(unsigned int v) { print((unsigned long)v); }
+    void print(long v);
+    void print(unsigned long v);
+    void print(double v, int digits = 2);
+
+    template <typename T> void println(T v) { print(v); print('\n'); }
+    void println(double v, int digits) { print(v, digits); print('\n'); }
+    void println() { print('\n'); }
+
+private:
+    bool _quiet = false;
+};
+
+extern HostSerial Serial;
+
+// ==================== ESP ====================
+
+class HostEsp {
+public:
+    uint32_t getCycleCount();  // Host: nanoseconds of a monotonic clock
+};
+
+extern HostEsp ESP;
+
+// ==================== FreeRTOS ====================
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+struct HostTask;
+struct HostMutex;
+typedef HostTask* TaskHandle_t;
+typedef HostMutex* SemaphoreHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))   // 1 tick = 1 ms
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
+#define ARDUINO_RUNNING_CORE 1
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
+void xTaskNotifyGive(TaskHandle_t task);
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex);
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,72 @@
+#include "Preferences.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+typedef std::map<std::string, std::vector<uint8_t>> HostNamespace;
+
+static std::map<std::string, HostNamespace> g_nvs;
+static std::mutex g_nvsLock;
+static uint32_t g_putCount = 0;
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    _name = name;
+    _readOnly = readOnly;
+    return name != nullptr;
+}
+
+void Preferences::end() {
+    _name = nullptr;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    if (!_name || _readOnly) return 0;
+    std::lock_guard<std::mutex> guard(g_nvsLock);
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    g_nvs[_name][key].assign(bytes, bytes + len);
+    g_putCount++;
+    return len;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    if (!_name) return 0;
+    std::lock_guard<std::mutex> guard(g_nvsLock);
+    auto ns = g_nvs.find(_name);
+    if (ns == g_nvs.end()) return 0;
+    auto entry = ns->second.find(key);
+    if (entry == ns->second.end() || entry->second.size() > maxLen) return 0;
+    memcpy(buf, entry->second.data(), entry->second.size());
+    return entry->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!_name) return 0;
+    std::lock_guard<std::mutex> guard(g_nvsLock);
+    auto ns = g_nvs.find(_name);
+    if (ns == g_nvs.end()) return 0;
+    auto entry = ns->second.find(key);
+    return (entry == ns->second.end()) ? 0 : entry->second.size();
+}
+
+bool Preferences::isKey(const char* key) {
+    return getBytesLength(key) > 0;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!_name || _readOnly) return false;
+    std::lock_guard<std::mutex> guard(g_nvsLock);
+    return g_nvs[_name].erase(key) > 0;
+}
+
+void Preferences::hostClear() {
+    std::lock_guard<std::mutex> guard(g_nvsLock);
+    g_nvs.clear();
+    g_putCount = 0;
+}
+
+uint32_t Preferences::hostPutCount() {
+    std::lock_guard<std::mutex> guard(g_nvsLock);
+    return g_putCount;
+}
@@ -0,0 +1,29 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include "Arduino.h"
+
+/*
+ * In-memory NVS: namespaces and keys live for the lifetime of the process.
+ * hostPutCount() counts writes, so tests can check where persistence happens.
+ */
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+
+    size_t putBytes(const char* key, const void* value, size_t len);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+    size_t getBytesLength(const char* key);
+    bool isKey(const char* key);
+    bool remove(const char* key);
+
+    static void hostClear();
+    static uint32_t hostPutCount();
+
+private:
+    const char* _name = nullptr;
+    bool _readOnly = true;
+};
+
+#endif // HOST_PREFERENCES_H
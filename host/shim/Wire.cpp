@@ -0,0 +1,48 @@
+#include "Wire.h"
+
+TwoWire Wire;
+
+bool TwoWire::begin(int, int, uint32_t) {
+    beginCount++;
+    return true;
+}
+
+bool TwoWire::end() {
+    endCount++;
+    return true;
+}
+
+void TwoWire::beginTransmission(uint16_t) {
+}
+
+size_t TwoWire::write(const uint8_t*, size_t len) {
+    return len;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+    if (endTransmissionResults.empty()) return 0;
+    uint8_t result = endTransmissionResults.front();
+    endTransmissionResults.pop_front();
+    return result;
+}
+
+size_t TwoWire::requestFrom(uint16_t, size_t len, bool) {
+    Request request = { len, 0 };
+    if (!requestResults.empty()) {
+        request = requestResults.front();
+        requestResults.pop_front();
+    }
+    hostAdvanceMicros(request.elapsedUs);
+
+    _rx.assign(request.received, 0xFF);
+    _rxIndex = 0;
+    return request.received;
+}
+
+int TwoWire::available() {
+    return (int)(_rx.size() - _rxIndex);
+}
+
+int TwoWire::read() {
+    return (_rxIndex < _rx.size()) ? _rx[_rxIndex++] : -1;
+}
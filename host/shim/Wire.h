@@ -0,0 +1,50 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+#include <deque>
+#include <vector>
+
+/*
+ * Scriptable stand-in for the ESP32 TwoWire. Nothing is on the other end:
+ * tests queue the results the driver should see. With empty queues every
+ * transaction succeeds and reads return zero bytes' worth of 0xFF.
+ */
+class TwoWire {
+public:
+    struct Request {
+        size_t received;       // Bytes requestFrom() reports
+        uint32_t elapsedUs;    // Virtual time the transfer takes
+    };
+
+    // Scripted outcomes, consumed in order
+    std::deque<uint8_t> endTransmissionResults;
+    std::deque<Request> requestResults;
+
+    // What the driver asked for
+    uint16_t lastTimeoutMs = 0;
+    uint32_t beginCount = 0;
+    uint32_t endCount = 0;
+
+    bool begin(int sda, int scl, uint32_t frequency);
+    bool end();
+    void setTimeOut(uint16_t timeoutMs) { lastTimeoutMs = timeoutMs; }
+    uint16_t getTimeOut() const { return lastTimeoutMs; }
+
+    void beginTransmission(uint16_t address);
+    size_t write(const uint8_t* data, size_t len);
+    size_t write(uint8_t value) { return write(&value, 1); }
+    uint8_t endTransmission(bool sendStop = true);
+
+    size_t requestFrom(uint16_t address, size_t len, bool sendStop = true);
+    int available();
+    int read();
+
+private:
+    std::vector<uint8_t> _rx;
+    size_t _rxIndex = 0;
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
@@ -0,0 +1,40 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+/*
+ * Minimal assertions for the host tests: each test is a plain executable
+ * registered with ctest; a failed check prints its location and the
+ * process exits non-zero from HOST_TEST_RESULT().
+ */
+
+#include <cstdio>
+#include <cmath>
+
+static int g_hostTestFailures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        g_hostTestFailures++; \
+    } \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long long _a = (long long)(a), _b = (long long)(b); \
+    if (_a != _b) { \
+        fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+        g_hostTestFailures++; \
+    } \
+} while (0)
+
+#define CHECK_NEAR(a, b, tol) do { \
+    double _a = (double)(a), _b = (double)(b); \
+    if (!(fabs(_a - _b) <= (tol))) { \
+        fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g (tol %g)\n", __FILE__, __LINE__, #a, #b, _a, _b, (double)(tol)); \
+        g_hostTestFailures++; \
+    } \
+} while (0)
+
+#define HOST_TEST_RESULT() (g_hostTestFailures ? (fprintf(stderr, "%d check(s) failed\n", g_hostTestFailures), 1) : 0)
+
+#endif // HOST_TEST_H
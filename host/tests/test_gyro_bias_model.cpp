@@ -0,0 +1,136 @@
+// Gyro bias vs temperature: bin learning and interpolation, and the table
+// persisted by one detector and loaded by the next.
+
+#include "HostTest.h"
+#include "FakeQmi8658Bus.h"
+#include "MotionDetector.h"
+#include <Preferences.h>
+
+#define TEMP_C(c) ((int16_t)((c) * TEMPERATURE_SENSOR_RESOLUTION))
+
+static void testModel() {
+    GyroBiasModel model;
+    const int16_t cold[3] = { 10, -5, 3 };
+    const int16_t warm[3] = { 30, 15, 3 };
+    int16_t out[3];
+
+    CHECK(!model.bias(TEMP_C(20), out));
+
+    // A bin becomes trusted exactly once, on its GYRO_BIAS_MIN_SAMPLES-th sample
+    int trusted = 0;
+    for (int i = 0; i < 2 * GYRO_BIAS_MIN_SAMPLES; i++) {
+        if (model.learn(TEMP_C(20), cold)) trusted++;
+        if (i == GYRO_BIAS_MIN_SAMPLES - 2) CHECK(!model.bias(TEMP_C(20), out));
+    }
+    CHECK_EQ(trusted, 1);
+    CHECK_EQ(model.getTrustedBins(), 1);
+    CHECK(model.isDirty());
+
+    // A single trusted bin holds its value at every temperature
+    CHECK(model.bias(TEMP_C(-10), out));
+    CHECK_EQ(out[0], 10);
+    CHECK_EQ(out[1], -5);
+
+    for (int i = 0; i < GYRO_BIAS_MIN_SAMPLES; i++) {
+        model.learn(TEMP_C(40), warm);
+    }
+    CHECK_EQ(model.getTrustedBins(), 2);
+
+    // Linear between the trusted bins, edge values outside them
+    CHECK(model.bias(TEMP_C(30), out));
+    CHECK_EQ(out[0], 20);
+    CHECK_EQ(out[1], 5);
+    CHECK_EQ(out[2], 3);
+    CHECK(model.bias(TEMP_C(60), out));
+    CHECK_EQ(out[0], 30);
+    CHECK(model.bias(TEMP_C(0), out));
+    CHECK_EQ(out[1], -5);
+
+    // Table round trip
+    GyroBiasModel copy;
+    copy.setBins(model.getBins());
+    CHECK(!copy.isDirty());
+    CHECK_EQ(copy.getTrustedBins(), 2);
+    CHECK(copy.bias(TEMP_C(35), out));
+    CHECK_EQ(out[0], 25);
+}
+
+struct Rig {
+    FakeQmi8658Bus bus;
+    Qmi8658c imu;
+    MotionDetector detector;
+
+    Rig() : imu(bus, 0x6b), detector(&imu) { bus.begin(400000); }
+
+    bool begin(gyro_scale_t gyroScale) {
+        qmi8658_cfg_t cfg;
+        cfg.qmi8658_mode = qmi8658_mode_dual;
+        cfg.acc_scale = acc_scale_2g;
+        cfg.acc_odr = acc_odr_250;
+        cfg.gyro_scale = gyroScale;
+        cfg.gyro_odr = gyro_odr_250;
+        if (!detector.begin(&cfg)) return false;
+        detector.setFilterEnabled(true);
+        detector.setBaselineTracking(true);
+        detector.setGyroBiasCompensation(true);
+        return true;
+    }
+
+    // Stationary samples at 250 Hz with a constant gyro offset
+    void run(int samples, const int16_t* gyro, int16_t temperature) {
+        const int16_t acc[3] = { 0, 0, 16384 };
+        for (int i = 0; i < samples; i++) {
+            hostAdvanceMicros(4000);
+            bus.setSample(acc, gyro, temperature);
+            detector.detectMotion();
+            detector.saveBaselineIfPending();
+        }
+    }
+};
+
+static void testPersistence() {
+    const int16_t offset[3] = { 12, -7, 4 };
+    const int16_t none[3] = { 0, 0, 0 };
+    float x, y, z;
+
+    Preferences::hostClear();
+
+    // Learn one bin; it is saved with the baseline once fast tracking ends
+    {
+        Rig rig;
+        CHECK(rig.begin(gyro_scale_32dps));
+        rig.run(500, offset, TEMP_C(25));
+        CHECK(rig.detector.getGyroBiasBins() >= 1);
+        CHECK(!rig.detector.isMoving());
+    }
+    uint32_t writes = Preferences::hostPutCount();
+    CHECK(writes >= 2);    // baseline + bias table
+    CHECK(writes <= 4);    // not per sample
+
+    // Next boot: the stored table sets the gyro baseline from the first sample,
+    // even though the sensor now reads zero rate
+    {
+        Rig rig;
+        CHECK(rig.begin(gyro_scale_32dps));
+        CHECK_EQ(rig.detector.getGyroBiasBins(), 1);
+        rig.run(1, none, TEMP_C(25));
+        rig.detector.getGyroBaseline(x, y, z);
+        CHECK_NEAR(x * rig.imu.gyro_sensitivity(), 12, 0.5);
+        CHECK_NEAR(y * rig.imu.gyro_sensitivity(), -7, 0.5);
+        CHECK_NEAR(z * rig.imu.gyro_sensitivity(), 4, 0.5);
+    }
+
+    // A table learned at another gyro scale is ignored
+    {
+        Rig rig;
+        CHECK(rig.begin(gyro_scale_64dps));
+        CHECK_EQ(rig.detector.getGyroBiasBins(), 0);
+    }
+}
+
+int main() {
+    Serial.setQuiet(true);
+    testModel();
+    testPersistence();
+    return HOST_TEST_RESULT();
+}
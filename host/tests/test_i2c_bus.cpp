@@ -0,0 +1,98 @@
+// I2CBus on a scripted TwoWire: result classification per device, time
+// budgets, latency histogram and recovery on timeouts and bus errors only.
+
+#include "HostTest.h"
+#include "I2CBus.h"
+
+int main() {
+    I2CBus bus(Wire, 21, 22);
+    I2CDevice light(bus, 0x23, "bh1750");
+    I2CDevice imu(bus, 0x6b, "qmi8658");
+    CHECK(bus.begin(400000));
+    CHECK_EQ(bus.getDeviceCount(), 2);
+    uint32_t wireBegins = Wire.beginCount;
+
+    uint8_t buf[17];
+    const I2CDevice::Stats& stats = light.getStats();
+
+    // Writes: endTransmission() codes map one to one
+    CHECK(light.writeByte(0x01));
+    Wire.endTransmissionResults = { 2 };
+    CHECK(!light.writeByte(0x01));
+    CHECK_EQ(stats.nackAddr, 1);
+    Wire.endTransmissionResults = { 3 };
+    CHECK(!light.writeByte(0x01));
+    CHECK_EQ(stats.nackData, 1);
+    CHECK(light.writeByte(0x01));           // Success resets the failure streak
+
+    // NACKs never trigger a recovery, however many in a row
+    for (int i = 0; i <= I2C_RECOVERY_THRESHOLD; i++) {
+        Wire.endTransmissionResults = { 2 };
+        CHECK(!light.writeByte(0x01));
+    }
+    CHECK_EQ(stats.nackAddr, 1 + I2C_RECOVERY_THRESHOLD + 1);
+    CHECK_EQ(bus.getRecoveryCount(), 0);
+
+    Wire.endTransmissionResults = { 4 };
+    CHECK(!light.writeByte(0x01));
+    CHECK_EQ(stats.errors, 1);
+    Wire.endTransmissionResults = { 5 };
+    CHECK(!light.writeByte(0x01));
+    CHECK_EQ(stats.timeouts, 1);
+    CHECK_EQ(bus.getRecoveryCount(), 0);
+
+    // Reads: a short transfer is classified with an address-only probe, itself
+    // counted as a transaction. A NACK ends the error streak.
+    Wire.requestResults = { { 0, 50 } };
+    Wire.endTransmissionResults = { 2 };
+    CHECK(!light.read(buf, 2));
+    CHECK_EQ(stats.nackAddr, 6);
+    CHECK_EQ(stats.probes, 1);
+    CHECK_EQ(bus.getRecoveryCount(), 0);
+
+    Wire.requestResults = { { 1, 50 } };
+    Wire.endTransmissionResults = { 0 };     // Device answers: the data phase failed
+    CHECK(!light.read(buf, 2));
+    CHECK_EQ(stats.errors, 2);
+    CHECK_EQ(stats.nackAddr, 6);
+    CHECK_EQ(stats.probes, 2);
+
+    // Past the time budget: timeout, no probe
+    Wire.requestResults = { { 0, 3000 } };
+    Wire.endTransmissionResults = { 2 };
+    CHECK(!light.read(buf, 2));
+    CHECK_EQ(stats.timeouts, 2);
+    CHECK_EQ(stats.probes, 2);
+    CHECK_EQ(Wire.endTransmissionResults.size(), 1);
+    Wire.endTransmissionResults.clear();
+
+    // The third timeout or bus error in a row recovers the bus
+    Wire.endTransmissionResults = { 4 };
+    CHECK(!light.writeByte(0x01));
+    CHECK_EQ(bus.getRecoveryCount(), 1);
+    CHECK_EQ(Wire.beginCount, wireBegins + 1);
+
+    // A repeated-start register read: the register write is deferred into
+    // requestFrom(), so a missing device shows up in the read
+    Wire.requestResults = { { 0, 50 } };
+    Wire.endTransmissionResults = { 0, 2 };  // Deferred write "succeeds", probe NACKs
+    CHECK(!imu.readRegs(0x30, buf, sizeof(buf)));
+    CHECK_EQ(imu.getStats().nackAddr, 1);
+    CHECK_EQ(imu.getStats().probes, 1);
+    CHECK_EQ(stats.nackAddr, 6);             // Counted on the right device
+
+    // Time budget: wire time of the transfer at the bus clock plus the margin, in ms
+    Wire.requestResults = { { sizeof(buf), 1500 } };
+    CHECK(imu.readRegs(0x30, buf, sizeof(buf)));
+    CHECK_EQ(Wire.lastTimeoutMs, 1);         // 19 bytes at 400 kHz: 0.43 ms + 0.5 ms
+    CHECK_EQ(imu.getStats().maxLatencyUs, 1500);
+    CHECK_EQ(imu.getStats().latencyHist[4], 1);   // 1000..2000 us bucket
+
+    // Totals
+    CHECK_EQ(stats.transactions, 16);
+    CHECK_EQ(imu.getStats().transactions, 3);
+    light.resetStats();
+    CHECK_EQ(stats.transactions, 0);
+
+    return HOST_TEST_RESULT();
+}
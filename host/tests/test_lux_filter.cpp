@@ -0,0 +1,64 @@
+// Lux filter: seeding, median spike rejection, asymmetric rise/fall time constants.
+
+#include "HostTest.h"
+#include "LuxFilter.h"
+
+int main() {
+    LuxFilter filter;
+
+    // Default configuration; the first sample seeds the output whatever dt says
+    CHECK_EQ(filter.getMedianSize(), LUX_FILTER_DEFAULT_MEDIAN);
+    CHECK(!filter.isPrimed());
+    CHECK_NEAR(filter.update(120.0f, 99999), 120.0f, 1e-3);
+    CHECK(filter.isPrimed());
+
+    // dt = 0 moves nothing, even with the median out of the way
+    filter.configure(1, 1000, 1000);
+    filter.update(120.0f, 0);
+    CHECK_NEAR(filter.update(500.0f, 0), 120.0f, 1e-3);
+    CHECK_NEAR(filter.update(0.0f, 0), 120.0f, 1e-3);
+
+    // 5-sample median: spikes up to 2 readings long never reach the EMA
+    filter.configure(5, 0, 0);
+    for (int i = 0; i < 5; i++) filter.update(100.0f, 1000);
+    CHECK_NEAR(filter.update(10000.0f, 1000), 100.0f, 1e-3);
+    CHECK_NEAR(filter.update(10000.0f, 1000), 100.0f, 1e-3);
+    CHECK_NEAR(filter.update(10000.0f, 1000), 10000.0f, 1e-3);    // third reading: real change
+    for (int i = 0; i < 5; i++) filter.update(100.0f, 1000);
+    CHECK_NEAR(filter.update(0.0f, 1000), 100.0f, 1e-3);          // dropout
+    CHECK_NEAR(filter.update(100.0f, 1000), 100.0f, 1e-3);
+
+    // Asymmetric EMA, alpha = dt / (tau + dt): slow rise, fast fall
+    filter.configure(1, 900, 100);
+    filter.update(0.0f, 0);
+    CHECK_NEAR(filter.update(100.0f, 100), 10.0f, 1e-3);          // 100 / (900 + 100)
+    filter.configure(1, 900, 100);
+    filter.update(100.0f, 0);
+    CHECK_NEAR(filter.update(0.0f, 100), 50.0f, 1e-3);            // 100 / (100 + 100)
+
+    // Rise converges with the real elapsed time, independent of the sampling interval
+    filter.configure(1, 1000, 1000);
+    filter.update(0.0f, 0);
+    for (int i = 0; i < 10; i++) filter.update(100.0f, 500);
+    float coarse = filter.getValue();
+    filter.configure(1, 1000, 1000);
+    filter.update(0.0f, 0);
+    for (int i = 0; i < 50; i++) filter.update(100.0f, 100);
+    CHECK_NEAR(filter.getValue(), coarse, 3.0);
+    CHECK(coarse > 95.0f && coarse < 100.0f);
+
+    // Reset: the next sample seeds again
+    filter.reset();
+    CHECK(!filter.isPrimed());
+    CHECK_NEAR(filter.update(42.0f, 1000), 42.0f, 1e-3);
+
+    // Median sizes are forced odd and clamped
+    filter.configure(4, 0, 0);
+    CHECK_EQ(filter.getMedianSize(), 5);
+    filter.configure(200, 0, 0);
+    CHECK_EQ(filter.getMedianSize(), LUX_FILTER_MAX_MEDIAN);
+    filter.configure(0, 0, 0);
+    CHECK_EQ(filter.getMedianSize(), 1);
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,49 @@
+// Window readiness and spike rejection: a single spike cannot decide a full window.
+
+#include "HostTest.h"
+#include "MotionWindow.h"
+
+static MotionWindow g_window;
+
+static void push(int16_t x) {
+    const int16_t xyz[3] = { x, 0, 0 };
+    g_window.push(xyz, (uint64_t)x * x);
+}
+
+int main() {
+    g_window.setLength(16);
+    CHECK_EQ(g_window.getLength(), 16);
+
+    // A spike as the first samples after a reset: judged only once the window is full
+    push(1000);
+    for (int i = 1; i < 15; i++) {
+        push(0);
+        CHECK(!g_window.isReady());
+    }
+    push(0);
+    CHECK(g_window.isReady());
+
+    // One 1000-count spike in 16 samples: std dev ~242, RMS 250
+    CHECK(!g_window.varianceAbove(300 * 300));
+    CHECK(g_window.varianceAbove(200 * 200));
+    CHECK(!g_window.rmsAbove(300 * 300));
+
+    // Sustained motion exceeds the same threshold
+    for (int i = 0; i < 16; i++) push((i & 1) ? 1000 : -1000);
+    CHECK(g_window.varianceAbove(300 * 300));
+
+    // The spike ages out once 16 newer samples arrived
+    for (int i = 0; i < 16; i++) push(0);
+    CHECK(!g_window.varianceAbove(1));
+    CHECK(!g_window.rmsAbove(1));
+
+    // Reset empties it; lengths are clamped to the supported range
+    g_window.reset();
+    CHECK(!g_window.isReady());
+    g_window.setLength(1);
+    CHECK_EQ(g_window.getLength(), MOTION_WINDOW_MIN_SAMPLES);
+    g_window.setLength(255);
+    CHECK_EQ(g_window.getLength(), MOTION_WINDOW_MAX_SAMPLES);
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,88 @@
+// Orientation classes from synthetic accelerometer streams, including a lift
+// that ends with the blade still vibrating the chassis and one that must not
+// end while the robot is carried level.
+
+#include "HostTest.h"
+#include "OrientationEstimator.h"
+
+#define ACC_1G 16384
+#define PERIOD_US 4000
+#define PERIOD_MS (PERIOD_US / 1000)
+#define GYRO_LSB_PER_DPS 64
+
+typedef OrientationEstimator::Orientation Orientation;
+
+static unsigned long g_now = 0;
+
+// Feed a constant specific force (g, sensor frame) plus an optional vertical vibration
+// and an optional rotation about X oscillating at the same frequency (dps)
+static void feed(OrientationEstimator& estimator, float x, float y, float z, int ms,
+                 bool quiet, float vibrationG = 0, float vibrationHz = 0, float rateDps = 0,
+                 bool gyroValid = true) {
+    for (int t = 0; t < ms; t += PERIOD_MS) {
+        float phase = sinf(2.0f * (float)PI * vibrationHz * g_now * 1e-3f);
+        float v = vibrationG * phase;
+        int16_t acc[3] = { (int16_t)(x * ACC_1G), (int16_t)(y * ACC_1G), (int16_t)((z + v) * ACC_1G) };
+        int16_t gyro[3] = { (int16_t)(rateDps * phase * GYRO_LSB_PER_DPS), 0, 0 };
+        estimator.update(acc, gyro, gyroValid, quiet, g_now);
+        g_now += PERIOD_MS;
+    }
+}
+
+int main() {
+    OrientationEstimator estimator;
+    estimator.configure(PERIOD_US, ACC_1G, GYRO_LSB_PER_DPS);
+
+    feed(estimator, 0, 0, 1, 1000, true);
+    CHECK(estimator.getOrientation() == Orientation::UPRIGHT);
+    CHECK_NEAR(estimator.getTilt(), 0, 0.5);
+
+    // A short bump is not a lift; 200 ms at 1.3 g is
+    feed(estimator, 0, 0, 1.3f, 40, false);
+    feed(estimator, 0, 0, 1, 500, true);
+    CHECK(estimator.getOrientation() == Orientation::UPRIGHT);
+    feed(estimator, 0, 0, 1.3f, 200, false);
+    CHECK(estimator.getOrientation() == Orientation::LIFTED);
+
+    // Set down with the blade running: never quiet, but level at ~1 g and not turning
+    // (the 50 Hz rate vibration averages out) clears the lift
+    feed(estimator, 0, 0, 1, ORIENT_LIFT_CLEAR_MS - 200, false, 0.3f, 50, 40);
+    CHECK(estimator.getOrientation() == Orientation::LIFTED);
+    feed(estimator, 0, 0, 1, 500, false, 0.3f, 50, 40);
+    CHECK(estimator.getOrientation() == Orientation::UPRIGHT);
+
+    // Carried level at walking pace: ~1 g, but swaying at 1 Hz keeps the lift latched
+    feed(estimator, 0, 0, 1.3f, 200, false);
+    CHECK(estimator.getOrientation() == Orientation::LIFTED);
+    feed(estimator, 0, 0, 1, 5000, false, 0, 1, 30);
+    CHECK(estimator.getOrientation() == Orientation::LIFTED);
+
+    // Without the gyroscope the rate is unknown: only stillness clears the lift
+    feed(estimator, 0, 0, 1, 3000, false, 0.3f, 50, 0, false);
+    CHECK(estimator.getOrientation() == Orientation::LIFTED);
+    feed(estimator, 0, 0, 1, 2500, true, 0, 0, 0, false);
+    CHECK(estimator.getOrientation() == Orientation::UPRIGHT);
+
+    // Held up (force away from 1 g) and not still: the lift stays latched
+    feed(estimator, 0, 0, 1.3f, 200, false);
+    feed(estimator, 0, 0, 1.2f, 3000, false);
+    CHECK(estimator.getOrientation() == Orientation::LIFTED);
+    feed(estimator, 0, 0, 1, 2500, true);
+    CHECK(estimator.getOrientation() == Orientation::UPRIGHT);
+
+    // 60 degrees over: tipped after the hold time, back with hysteresis
+    feed(estimator, 0.866f, 0, 0.5f, 3000, true);
+    CHECK(estimator.getOrientation() == Orientation::TIPPED);
+    CHECK_NEAR(estimator.getTilt(), 60, 1);
+    feed(estimator, 0.545f, 0, 0.839f, 3000, true);    // 33 degrees: inside the hysteresis
+    CHECK(estimator.getOrientation() == Orientation::TIPPED);
+    feed(estimator, 0.342f, 0, 0.940f, 3000, true);    // 20 degrees
+    CHECK(estimator.getOrientation() == Orientation::UPRIGHT);
+
+    // On its back
+    feed(estimator, 0, 0, -1, 3000, true);
+    CHECK(estimator.getOrientation() == Orientation::UPSIDE_DOWN);
+    CHECK_NEAR(estimator.getTilt(), 180, 1);
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,52 @@
+// Per-sample reads on the emulated QMI8658: one burst per sample, so the time
+// stamp, temperature and motion data always come from the same sample.
+
+#include "HostTest.h"
+#include "FakeQmi8658Bus.h"
+
+int main() {
+    Serial.setQuiet(true);
+
+    FakeQmi8658Bus bus;
+    Qmi8658c imu(bus, 0x6b);
+    bus.begin(400000);
+
+    qmi8658_cfg_t cfg;
+    cfg.qmi8658_mode = qmi8658_mode_dual;
+    cfg.acc_scale = acc_scale_2g;
+    cfg.acc_odr = acc_odr_250;
+    cfg.gyro_scale = gyro_scale_32dps;
+    cfg.gyro_odr = gyro_odr_250;
+    CHECK_EQ(imu.open(&cfg), qmi8658_result_open_success);
+
+    int16_t acc[3] = { 10, -20, 16384 };
+    int16_t gyro[3] = { 1, 2, 3 };
+    qmi_raw_data_t raw;
+
+    bus.setSample(acc, gyro, 25 * TEMPERATURE_SENSOR_RESOLUTION);
+    CHECK(imu.read_raw(&raw));
+    CHECK_EQ(raw.temperature, 25 * TEMPERATURE_SENSOR_RESOLUTION);
+    uint32_t firstStamp = raw.timestamp;
+
+    // 2 s at 250 Hz: one transaction per sample, every field from that sample
+    bus.clearCounters();
+    for (int i = 1; i <= 500; i++) {
+        hostAdvanceMicros(4000);
+        acc[0] = (int16_t)i;
+        int16_t temp = (int16_t)(25 * TEMPERATURE_SENSOR_RESOLUTION + i);
+        bus.setSample(acc, gyro, temp);
+        CHECK(imu.read_raw(&raw));
+        CHECK_EQ(raw.timestamp, firstStamp + i);
+        CHECK_EQ(raw.acc[0], i);
+        CHECK_EQ(raw.acc[2], 16384);
+        CHECK_EQ(raw.gyro[2], 3);
+        CHECK_EQ(raw.temperature, temp);
+    }
+    CHECK_EQ(bus.getReads(), 500);
+    CHECK_EQ(bus.getTempReads(), 500);
+
+    // The temperature cache follows the same burst
+    CHECK_NEAR(imu.temperature(), 25.0f + 500.0f / TEMPERATURE_SENSOR_RESOLUTION, 1e-4f);
+
+    return HOST_TEST_RESULT();
+}
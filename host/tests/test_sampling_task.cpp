@@ -0,0 +1,130 @@
+// Interrupt-driven sampling: a simulated data-ready GPIO interrupt wakes the
+// sampling task, which processes each new sample exactly once; with the line
+// quiet the task falls back to polling; paused, it does neither. Baseline
+// persistence stays with loop().
+
+#include "HostTest.h"
+#include "FakeQmi8658Bus.h"
+#include "MotionDetector.h"
+#include <Preferences.h>
+#include <chrono>
+#include <thread>
+
+#define INT_PIN 10
+#define INT_LINE 2                  // Data-ready is on INT2 in bypass mode
+
+// The sampling task runs until exit: keep everything it touches alive
+static FakeQmi8658Bus g_bus;
+static Qmi8658c g_imu(g_bus, 0x6b);
+static MotionDetector g_detector(&g_imu);
+
+// Real-time wait for the task (its blocking is real time, sampling time is virtual)
+template <class Condition>
+static bool waitFor(Condition condition, int timeoutMs = 1000) {
+    for (int i = 0; i < timeoutMs; i++) {
+        if (condition()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return condition();
+}
+
+static void nextSample(const int16_t* acc, const int16_t* gyro) {
+    hostAdvanceMicros(4000);
+    g_bus.setSample(acc, gyro, 30 * TEMPERATURE_SENSOR_RESOLUTION);
+}
+
+int main() {
+    Serial.setQuiet(true);
+    Preferences::hostClear();
+    g_bus.begin(400000);
+
+    qmi8658_cfg_t cfg;
+    cfg.qmi8658_mode = qmi8658_mode_dual;
+    cfg.acc_scale = acc_scale_2g;
+    cfg.acc_odr = acc_odr_250;
+    cfg.gyro_scale = gyro_scale_32dps;
+    cfg.gyro_odr = gyro_odr_250;
+    CHECK(g_detector.begin(&cfg));
+    g_detector.setFilterEnabled(true);
+    g_detector.setBaselineTracking(true);
+
+    CHECK(!g_detector.startSamplingTask(-1, INT_LINE));
+    CHECK(g_detector.startSamplingTask(INT_PIN, INT_LINE));
+    CHECK(g_detector.isSamplingTaskRunning());
+    CHECK(g_bus.reg(QMI8658_CTRL1) & QMI8658_CTRL1_INT2_EN);
+
+    // No interrupt yet: the first sample is picked up by a fallback poll
+    const int16_t still[3] = { 0, 0, 16384 };
+    const int16_t noGyro[3] = { 0, 0, 0 };
+    nextSample(still, noGyro);
+    CHECK(waitFor([&]() { return g_detector.getSamplesProcessed() == 1; }, 3 * MOTION_TASK_FALLBACK_MS));
+    CHECK(g_detector.getFallbackPollCount() >= 1);
+    uint32_t base = g_detector.getSamplesProcessed();
+
+    // Each interrupt: one new sample, processed once
+    const int SAMPLES = 200;
+    for (int i = 1; i <= SAMPLES; i++) {
+        nextSample(still, noGyro);
+        CHECK(hostRaiseInterrupt(INT_PIN));
+        if (!waitFor([&]() { return g_detector.getSamplesProcessed() >= base + i; })) {
+            fprintf(stderr, "sample %d not processed\n", i);
+            break;
+        }
+    }
+    CHECK_EQ(g_detector.getInterruptCount(), SAMPLES);
+    CHECK_EQ(g_detector.getSamplesProcessed(), base + SAMPLES);
+    CHECK_EQ(g_detector.getDroppedSamples(), 0);
+    CHECK(!g_detector.isMoving());
+
+    // The baseline learned by the task is flagged, not written: NVS is loop()'s job
+    uint32_t writes = Preferences::hostPutCount();
+    CHECK(waitFor([&]() { return g_detector.getBaselineUpdates() > 0; }));
+    CHECK_EQ(Preferences::hostPutCount(), writes);
+    g_detector.saveBaselineIfPending();
+    CHECK(Preferences::hostPutCount() > writes);
+
+    // An interrupt without new data (spurious or a duplicate edge) processes nothing
+    CHECK(hostRaiseInterrupt(INT_PIN));
+    CHECK(waitFor([&]() { return g_detector.getInterruptCount() == SAMPLES + 1; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK_EQ(g_detector.getSamplesProcessed(), base + SAMPLES);
+
+    // Motion arriving through interrupts is detected (5 Hz shake, inside the filter band)
+    for (int i = 0; i < 100; i++) {
+        float wave = sinf(2.0f * (float)PI * i / 50);
+        const int16_t shake[3] = { (int16_t)(6000 * wave), 0, 16384 };
+        const int16_t turn[3] = { 0, 0, (int16_t)(20000 * wave) };
+        nextSample(shake, turn);
+        hostRaiseInterrupt(INT_PIN);
+        uint32_t expected = base + SAMPLES + 1 + i;
+        waitFor([&]() { return g_detector.getSamplesProcessed() >= expected; });
+    }
+    CHECK(g_detector.isMoving());
+
+    // Line quiet (miswired INT pin): the task polls every MOTION_TASK_FALLBACK_MS
+    uint32_t polls = g_detector.getFallbackPollCount();
+    uint32_t processed = g_detector.getSamplesProcessed();
+    nextSample(still, noGyro);
+    CHECK(waitFor([&]() { return g_detector.getSamplesProcessed() == processed + 1; }, 3 * MOTION_TASK_FALLBACK_MS));
+    CHECK(g_detector.getFallbackPollCount() > polls);
+
+    // Paused (light sleep): ISR detached and no fallback polls
+    g_detector.pauseSamplingTask();
+    CHECK(g_detector.isSamplingTaskPaused());
+    CHECK(!hostRaiseInterrupt(INT_PIN));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    processed = g_detector.getSamplesProcessed();
+    nextSample(still, noGyro);
+    std::this_thread::sleep_for(std::chrono::milliseconds(3 * MOTION_TASK_FALLBACK_MS));
+    CHECK_EQ(g_detector.getSamplesProcessed(), processed);
+
+    // Resumed: the sample missed while paused is picked up, interrupts work again
+    g_detector.resumeSamplingTask();
+    CHECK(!g_detector.isSamplingTaskPaused());
+    CHECK(waitFor([&]() { return g_detector.getSamplesProcessed() == processed + 1; }));
+    nextSample(still, noGyro);
+    CHECK(hostRaiseInterrupt(INT_PIN));
+    CHECK(waitFor([&]() { return g_detector.getSamplesProcessed() == processed + 2; }));
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,102 @@
+// SolarCalculator against published sunrise, sunset and civil twilight times
+// (local times converted to UTC, rounded to the minute), including polar day
+// and night where events do not occur.
+
+#include "HostTest.h"
+#include "SolarCalculator.h"
+#include <ctime>
+
+#define HM(h, m) ((h) * 60 + (m))
+#define TOLERANCE_MIN 2
+
+struct Reference {
+    const char* name;
+    float latitude;
+    float longitude;
+    int month;
+    int day;
+    int16_t civilDawn, sunrise, sunset, civilDusk;    // UTC minutes, -1 = no event
+};
+
+static const Reference REFERENCES[] = {
+    { "London",   51.5074f,  -0.1278f,  6, 21, HM(2, 56),  HM(3, 43),  HM(20, 21), HM(21, 9) },
+    { "London",   51.5074f,  -0.1278f, 12, 21, HM(7, 24),  HM(8, 4),   HM(15, 53), HM(16, 34) },
+    { "New York", 40.7128f, -74.0060f,  6, 21, HM(8, 52),  HM(9, 25),  HM(0, 31),  HM(1, 4) },
+    { "New York", 40.7128f, -74.0060f, 12, 21, HM(11, 46), HM(12, 16), HM(21, 32), HM(22, 2) },
+    { "Sydney",  -33.8688f, 151.2093f,  6, 21, HM(20, 32), HM(21, 0),  HM(6, 54),  HM(7, 22) },
+    { "Sydney",  -33.8688f, 151.2093f, 12, 21, HM(18, 12), HM(18, 41), HM(9, 5),   HM(9, 35) },
+    { "Milan",    45.4642f,   9.1900f,  6, 21, HM(2, 57),  HM(3, 35),  HM(19, 15), HM(19, 53) },
+    { "Milan",    45.4642f,   9.1900f, 12, 21, HM(6, 26),  HM(7, 1),   HM(15, 43), HM(16, 17) },
+    // Tromso: midnight sun in June; in December the sun stays below the horizon
+    // but civil twilight still happens around noon
+    { "Tromso",   69.6492f,  18.9553f,  6, 21, -1,         -1,         -1,         -1 },
+    { "Tromso",   69.6492f,  18.9553f, 12, 21, HM(8, 32),  -1,         -1,         HM(12, 53) },
+};
+
+static time_t utc(int year, int month, int day, int hour, int minute) {
+    struct tm t = {};
+    t.tm_year = year - 1900;
+    t.tm_mon = month - 1;
+    t.tm_mday = day;
+    t.tm_hour = hour;
+    t.tm_min = minute;
+    return timegm(&t);
+}
+
+static void checkEvent(const char* name, const char* event, int16_t actual, int16_t expected) {
+    bool ok;
+    if (expected < 0) {
+        ok = actual == -1;
+    } else {
+        int diff = abs(actual - expected);
+        if (diff > 720) diff = 1440 - diff;    // Across midnight UTC
+        ok = actual >= 0 && diff <= TOLERANCE_MIN;
+    }
+    if (!ok) {
+        fprintf(stderr, "%s %s: %d, expected %d\n", name, event, actual, expected);
+    }
+    CHECK(ok);
+}
+
+int main() {
+    SolarCalculator solar;
+
+    for (const Reference& ref : REFERENCES) {
+        solar.setLocation(ref.latitude, ref.longitude);
+        CHECK(solar.update(utc(2024, ref.month, ref.day, 12, 0)));
+        CHECK(solar.isValid());
+        checkEvent(ref.name, "civil dawn", solar.getCivilDawn(), ref.civilDawn);
+        checkEvent(ref.name, "sunrise", solar.getSunrise(), ref.sunrise);
+        checkEvent(ref.name, "sunset", solar.getSunset(), ref.sunset);
+        checkEvent(ref.name, "civil dusk", solar.getCivilDusk(), ref.civilDusk);
+    }
+
+    // Phases through a London winter day
+    solar.setLocation(51.5074f, -0.1278f);
+    CHECK(solar.update(utc(2024, 12, 21, 0, 0)));
+    CHECK(solar.getPhase(utc(2024, 12, 21, 3, 0)) == SolarCalculator::Phase::NIGHT);
+    CHECK(solar.getPhase(utc(2024, 12, 21, 7, 45)) == SolarCalculator::Phase::TWILIGHT);
+    CHECK(solar.getPhase(utc(2024, 12, 21, 12, 0)) == SolarCalculator::Phase::DAY);
+    CHECK(solar.getPhase(utc(2024, 12, 21, 16, 10)) == SolarCalculator::Phase::TWILIGHT);
+    CHECK_EQ(solar.minutesFromTwilight(utc(2024, 12, 21, 16, 10)), 0);
+    CHECK_NEAR(solar.minutesFromTwilight(utc(2024, 12, 21, 18, 34)), 120, 2);
+
+    // Polar day: always day, never near a twilight band
+    solar.setLocation(69.6492f, 18.9553f);
+    CHECK(solar.update(utc(2024, 6, 21, 0, 0)));
+    CHECK(solar.getPhase(utc(2024, 6, 21, 23, 0)) == SolarCalculator::Phase::DAY);
+    CHECK_EQ(solar.minutesFromTwilight(utc(2024, 6, 21, 23, 0)), 720);
+
+    // Polar night: twilight at noon, night otherwise
+    CHECK(solar.update(utc(2024, 12, 21, 0, 0)));
+    CHECK(solar.getPhase(utc(2024, 12, 21, 10, 42)) == SolarCalculator::Phase::TWILIGHT);
+    CHECK(solar.getPhase(utc(2024, 12, 21, 22, 0)) == SolarCalculator::Phase::NIGHT);
+
+    // Unset clock
+    SolarCalculator unset;
+    CHECK(!unset.update(0));
+    CHECK(!unset.isValid());
+    CHECK_EQ(unset.getSunrise(), -1);
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,141 @@
+// Replays a synthetic trace (idle rate, then full rate with a burst of motion)
+// and checks the decisions, the trace-time base and the latency report.
+
+#include <memory>
+#include "HostTest.h"
+#include "TraceReplay.h"
+
+#define TRACE_ACC_1G 16384       // acc_scale_2g
+#define TRACE_GYRO_1DPS 1024     // gyro_scale_32dps
+
+static uint32_t g_seed = 1;
+
+static int16_t noise(int amplitude) {
+    g_seed = g_seed * 1103515245UL + 12345UL;
+    return (int16_t)((int)((g_seed >> 16) % (2 * amplitude + 1)) - amplitude);
+}
+
+static ImuTraceHeader makeHeader() {
+    ImuTraceHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = IMU_TRACE_MAGIC;
+    header.version = IMU_TRACE_VERSION;
+    header.recordSize = sizeof(ImuTraceRecord);
+    header.highOdr = acc_odr_250;
+    header.idleOdr = acc_odr_21;
+    header.accScale = acc_scale_2g;
+    header.gyroScale = gyro_scale_32dps;
+    header.accSensitivity = TRACE_ACC_1G;
+    header.gyroSensitivity = TRACE_GYRO_1DPS;
+    header.highPeriodUs = QMI8658_ACC_ODR_PERIOD_US[acc_odr_250];
+    header.idlePeriodUs = QMI8658_ACC_ODR_PERIOD_US[acc_odr_21];
+    header.startMs = 12345;
+    return header;
+}
+
+// 2 s at the idle rate, then 4 s still, 3 s moving (2 Hz, 0.3 g / 20 dps), 5 s still at 250 Hz
+static std::vector<ImuTraceRecord> makeTrace(uint32_t& motionStartMs, uint32_t& motionEndMs) {
+    std::vector<ImuTraceRecord> records;
+    uint32_t counter = 1000;
+    const uint32_t idleRecords = 42;           // 42 * 47.6 ms = 2.0 s
+    const uint32_t highRecords = 12 * 250;
+    const uint32_t motionFirst = 4 * 250;
+    const uint32_t motionLast = 7 * 250;
+
+    g_seed = 1;
+    for (uint32_t i = 0; i < idleRecords + highRecords; i++) {
+        ImuTraceRecord record;
+        memset(&record, 0, sizeof(record));
+        bool high = i >= idleRecords;
+        uint32_t h = i - idleRecords;
+
+        record.timestamp = counter++;
+        record.acc[0] = noise(20);
+        record.acc[1] = noise(20);
+        record.acc[2] = TRACE_ACC_1G + noise(20);
+        record.temperature = 30 * TEMPERATURE_SENSOR_RESOLUTION;
+        if (high) {
+            record.flags |= IMU_TRACE_FLAG_HIGH_RATE;
+            for (int axis = 0; axis < 3; axis++) record.gyro[axis] = noise(5);
+            if (h >= motionFirst && h < motionLast) {
+                float phase = 2.0f * (float)PI * 2.0f * (h - motionFirst) * 0.004f;
+                record.acc[0] += (int16_t)(0.3f * TRACE_ACC_1G * sinf(phase));
+                record.gyro[2] += (int16_t)(20.0f * TRACE_GYRO_1DPS * sinf(phase));
+            }
+        }
+        if (i == 0 || i == idleRecords) {
+            record.flags |= IMU_TRACE_FLAG_RESYNC;
+        }
+        records.push_back(record);
+    }
+
+    // Trace time: the first full-rate record lands one idle period after the last
+    // idle one (the rate switch resyncs there), then 4 ms per record
+    uint32_t idleMs = idleRecords * QMI8658_ACC_ODR_PERIOD_US[acc_odr_21] / 1000;
+    motionStartMs = idleMs + motionFirst * 4;
+    motionEndMs = idleMs + motionLast * 4;
+    return records;
+}
+
+// A fresh detector per run (heap: the capture buffer is large)
+static std::unique_ptr<TraceReplay> run(const std::vector<ImuTraceRecord>& records, const TraceReplay::Options& options) {
+    std::unique_ptr<TraceReplay> replay(new TraceReplay());
+    CHECK(replay->begin(makeHeader(), options));
+    for (const ImuTraceRecord& record : records) {
+        replay->feed(record);
+    }
+    replay->finish();
+    return replay;
+}
+
+int main() {
+    Serial.setQuiet(true);
+
+    uint32_t motionStartMs, motionEndMs;
+    std::vector<ImuTraceRecord> records = makeTrace(motionStartMs, motionEndMs);
+    std::vector<TraceReplay::Interval> labels;
+    TraceReplay::Interval motion = { motionStartMs, motionEndMs };
+    labels.push_back(motion);
+
+    // Pulse detection on filtered samples
+    TraceReplay::Options options;
+    std::unique_ptr<TraceReplay> replay = run(records, options);
+    TraceReplay::Report report = replay->evaluate(labels);
+    CHECK_EQ(report.records, records.size());
+    CHECK_NEAR(report.durationMs, motionEndMs + 5 * 1000 - 4, 1);
+    CHECK_EQ(report.detected, 1);
+    CHECK_EQ(report.missed, 0);
+    CHECK(report.maxLatencyMs < 500);
+    CHECK_EQ(report.falsePositives, 0);
+    CHECK_EQ(report.falsePositiveMs, 0);
+    CHECK_EQ(replay->getDetector().getDuplicateSamples(), 0);
+    CHECK_EQ(replay->getDetector().getDroppedSamples(), 0);
+
+    // Decisions depend on trace time only: a different wall clock changes nothing
+    std::vector<TraceReplay::Episode> reference = replay->getEpisodes();
+    hostSetMicros(3000000000000ULL);
+    replay = run(records, options);
+    const std::vector<TraceReplay::Episode>& episodes = replay->getEpisodes();
+    CHECK_EQ(episodes.size(), reference.size());
+    for (size_t i = 0; i < reference.size() && i < episodes.size(); i++) {
+        CHECK_EQ(episodes[i].startMs, reference[i].startMs);
+        CHECK_EQ(episodes[i].endMs, reference[i].endMs);
+    }
+
+    // Windowed variance needs a fuller window but still catches the burst
+    options.mode = MotionDetector::DetectionMode::WINDOW_VARIANCE;
+    replay = run(records, options);
+    report = replay->evaluate(labels);
+    CHECK_EQ(report.detected, 1);
+    CHECK(report.maxLatencyMs < 500);
+    CHECK_EQ(report.falsePositives, 0);
+
+    // A label with no motion in it is reported as missed
+    TraceReplay::Interval still = { 500, 1500 };
+    labels.push_back(still);
+    report = replay->evaluate(labels);
+    CHECK_EQ(report.detected, 1);
+    CHECK_EQ(report.missed, 1);
+
+    return HOST_TEST_RESULT();
+}